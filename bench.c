@@ -0,0 +1,540 @@
+/*!
+(c) 2011-2012 Petr Kutalek, Forers, s. r. o.: telxcc
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+
+telxcc-bench: micro-benchmarks of decoder internals and end-to-end decoding throughput
+
+Each result is printed as one JSON object per line (JSON Lines) to STDOUT, so runs can be collected and compared
+over time; progress and errors go to STDERR. End-to-end runs decode a synthetic corpus built in memory
+(deterministic, same on every machine) and any TS files given on command line.
+*/
+
+// decoder is compiled in, so its internals can be measured
+#include "libtelxcc.c"
+
+#include <unistd.h>
+
+// minimal duration of one measurement in ns
+#define MIN_DURATION 200000000ULL
+
+// synthetic corpus size in bytes (default)
+#define CORPUS_SIZE (64 * 1024 * 1024)
+
+// chunk size data are pushed into decoder in, same as telxcc reads
+#define PUSH_SIZE 65536
+
+static uint32_t seed = 1;
+static inline uint32_t random_next(void) {
+	seed = seed * 1103515245 + 12345;
+	return seed >> 16;
+}
+
+// prevents compiler from eliminating measured code
+static volatile uint32_t sink;
+
+static uint64_t now_ns(void) {
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (uint64_t)t.tv_sec * 1000000000ULL + t.tv_nsec;
+}
+
+// JSON-safe name: only characters needing no escaping are kept
+static void print_name(const char *name) {
+	putchar('"');
+	for (const char *c = name; *c != '\0'; c++) if ((*c >= 0x20) && (*c != '"') && (*c != '\\')) putchar(*c);
+	putchar('"');
+}
+
+// micro-benchmark input: rows of pseudo-random bytes
+#define ROWS 256
+static uint8_t rows[ROWS][44];
+
+// each micro-benchmark processes all ROWS once per iteration and returns number of operations done
+typedef uint64_t (*micro_t)(telxcc_decoder_t *decoder);
+
+static uint64_t micro_unham_8_4(telxcc_decoder_t *decoder) {
+	uint32_t s = 0;
+	for (uint16_t r = 0; r < ROWS; r++)
+		for (uint8_t i = 0; i < 16; i++) s += unham_8_4(rows[r][i]);
+	sink = s;
+	return ROWS * 16;
+}
+
+static uint64_t micro_unham_16(telxcc_decoder_t *decoder) {
+	uint8_t nibbles[16];
+	uint32_t s = 0;
+	for (uint16_t r = 0; r < ROWS; r++) {
+		decoder->kernels->unham_16(rows[r], nibbles);
+		s += nibbles[r & 0x0f];
+	}
+	sink = s;
+	return ROWS * 16;
+}
+
+static uint64_t micro_unham_24_18(telxcc_decoder_t *decoder) {
+	uint32_t s = 0;
+	for (uint16_t r = 0; r < ROWS; r++)
+		for (uint8_t i = 1; i < 40; i += 3) s += unham_24_18((rows[r][i + 2] << 16) | (rows[r][i + 1] << 8) | rows[r][i]);
+	sink = s;
+	return ROWS * 13;
+}
+
+static uint64_t micro_unham_x26(telxcc_decoder_t *decoder) {
+	x26_triplet_t triplets[13];
+	uint32_t s = 0;
+	for (uint16_t r = 0; r < ROWS; r++) {
+		decoder->kernels->unham_x26(rows[r], triplets);
+		s += triplets[r % 13].data;
+	}
+	sink = s;
+	return ROWS * 13;
+}
+
+static uint64_t micro_telx_to_ucs2(telxcc_decoder_t *decoder) {
+	uint32_t s = 0;
+	for (uint16_t r = 0; r < ROWS; r++)
+		for (uint8_t i = 0; i < 40; i++) s += telx_to_ucs2(G0[LATIN], rows[r][i]);
+	sink = s;
+	return ROWS * 40;
+}
+
+static uint64_t micro_parity_40(telxcc_decoder_t *decoder) {
+	uint8_t chars[40];
+	uint32_t s = 0;
+	for (uint16_t r = 0; r < ROWS; r++) {
+		decoder->kernels->parity_40(rows[r], chars);
+		for (uint8_t i = 0; i < 40; i++) s += char_to_ucs2(G0[LATIN], chars[i]);
+	}
+	sink = s;
+	return ROWS * 40;
+}
+
+static uint64_t micro_reverse_44(telxcc_decoder_t *decoder) {
+	for (uint16_t r = 0; r < ROWS; r++) decoder->kernels->reverse_44(rows[r]);
+	sink = rows[0][0];
+	return ROWS * 44;
+}
+
+static uint64_t micro_ucs2_to_utf8(telxcc_decoder_t *decoder) {
+	text_buffer_t *text = &decoder->text;
+	for (uint16_t r = 0; r < ROWS; r++) {
+		text->size = 0;
+		// Latin, Latin-1 supplement, Cyrillic and box drawing chars: 1, 2 and 3-byte sequences
+		for (uint8_t i = 0; i < 40; i++) text_append_utf8(text, (rows[r][i] < 0xc0) ? (rows[r][i] & 0x7f) + 0x20 : 0x400 + rows[r][i] * 0x10);
+	}
+	sink = text->size;
+	return ROWS * 40;
+}
+
+// page with two boxed rows of coloured text
+static ts_stream_t *page_stream;
+static teletext_page_state_t *page_state;
+
+static void page_callback(void *user_data, const telxcc_event_t *event) {
+	sink = event->utf8_size;
+}
+
+static uint64_t micro_process_page(telxcc_decoder_t *decoder) {
+	for (uint16_t r = 0; r < ROWS; r++) process_page(decoder, page_stream, page_state);
+	return ROWS;
+}
+
+// TS packet headers: video, audio and 1 in 32 teletext packets, decoder locked on teletext PID
+#define PACKETS 1024
+static uint8_t packets[PACKETS][8];
+
+static uint64_t micro_prefilter(telxcc_decoder_t *decoder) {
+	uint16_t selected[PACKETS];
+	sink = decoder->prefilter(packets[0], PACKETS, 8, decoder->pid_filter, selected);
+	return PACKETS;
+}
+
+typedef struct {
+	const char *name;
+	micro_t run;
+	uint8_t kernel; // 0 = plain function, 1 = row kernel, 2 = pre-filter; kernels are measured in all implementations
+} micro_benchmark_t;
+
+static const micro_benchmark_t MICRO_BENCHMARKS[] = {
+	{ "unham_8_4", micro_unham_8_4, 0 },
+	{ "unham_16", micro_unham_16, 1 },
+	{ "unham_24_18", micro_unham_24_18, 0 },
+	{ "unham_x26", micro_unham_x26, 1 },
+	{ "telx_to_ucs2", micro_telx_to_ucs2, 0 },
+	{ "parity_40", micro_parity_40, 1 },
+	{ "reverse_44", micro_reverse_44, 1 },
+	{ "ucs2_to_utf8", micro_ucs2_to_utf8, 0 },
+	{ "process_page", micro_process_page, 0 },
+	{ "prefilter", micro_prefilter, 2 }
+};
+
+// row kernels and pre-filters running CPU supports
+static const row_kernels_t *ROW_KERNELS[4];
+static uint8_t row_kernels_count = 0;
+static struct {
+	const char *name;
+	prefilter_t run;
+} PREFILTERS[4];
+static uint8_t prefilters_count = 0;
+
+static void find_implementations(void) {
+	ROW_KERNELS[row_kernels_count++] = &ROW_KERNELS_SCALAR;
+	PREFILTERS[prefilters_count].name = "scalar";
+	PREFILTERS[prefilters_count++].run = prefilter_scalar;
+#if defined(ROW_SSSE3)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("ssse3")) ROW_KERNELS[row_kernels_count++] = &ROW_KERNELS_SSSE3;
+#elif defined(ROW_NEON)
+	ROW_KERNELS[row_kernels_count++] = &ROW_KERNELS_NEON;
+#endif
+#if defined(__SSE2__)
+	PREFILTERS[prefilters_count].name = "SSE2";
+	PREFILTERS[prefilters_count++].run = prefilter_sse2;
+#endif
+#if defined(PREFILTER_AVX2)
+	if (__builtin_cpu_supports("avx2")) {
+		PREFILTERS[prefilters_count].name = "AVX2";
+		PREFILTERS[prefilters_count++].run = prefilter_avx2;
+	}
+#elif defined(PREFILTER_NEON)
+	PREFILTERS[prefilters_count].name = "NEON";
+	PREFILTERS[prefilters_count++].run = prefilter_neon;
+#endif
+}
+
+static void run_micro(telxcc_decoder_t *decoder, const char *implementation, const micro_benchmark_t *benchmark) {
+	// warm-up, then iterations are doubled until measurement is long enough
+	benchmark->run(decoder);
+	uint64_t iterations = 1;
+	uint64_t ops = 0;
+	uint64_t duration = 0;
+	while (1) {
+		ops = 0;
+		uint64_t t = now_ns();
+		for (uint64_t i = 0; i < iterations; i++) ops += benchmark->run(decoder);
+		duration = now_ns() - t;
+		if (duration >= MIN_DURATION) break;
+		iterations *= 2;
+	}
+
+	printf("{\"type\":\"micro\",\"benchmark\":");
+	print_name(benchmark->name);
+	printf(",\"implementation\":");
+	print_name(implementation);
+	printf(",\"ops\":%"PRIu64",\"ns\":%"PRIu64",\"ns_per_op\":%.3f}\n", ops, duration, (double)duration / ops);
+	fflush(stdout);
+}
+
+static void micro_benchmarks(void) {
+	telxcc_config_t config;
+	telxcc_config_init(&config);
+	config.log = NULL;
+	config.colours = 1;
+	telxcc_decoder_t *decoder = telxcc_create(&config, page_callback, NULL);
+	if (decoder == NULL) return;
+	find_implementations();
+
+	for (uint16_t r = 0; r < ROWS; r++)
+		for (uint8_t i = 0; i < 44; i++) rows[r][i] = random_next();
+
+	for (uint16_t k = 0; k < PACKETS; k++) {
+		uint16_t pid = ((k % 32) == 7) ? 0x240 : ((k % 8) == 3) ? 0x101 : 0x100;
+		uint8_t header[8] = { 0x47, pid >> 8, pid & 0xff, 0x10 | (k & 0x0f), random_next(), random_next(), random_next(), random_next() };
+		memcpy(packets[k], header, 8);
+	}
+
+	page_stream = add_stream(decoder, 0x240);
+	memset(decoder->pid_filter, PID_SKIP, 8192);
+	decoder->pid_filter[0x240] = PID_STREAM;
+	page_state = add_page_state(decoder, page_stream, 0x888);
+	if ((page_stream == NULL) || (page_state == NULL)) return;
+	static const char *LINES[2] = { "Hei og velkommen til Dagsrevyen", "Det er fredag kveld i Norge" };
+	for (uint8_t l = 0; l < 2; l++) {
+		uint16_t *row = page_state->page_buffer.text[20 + 2 * l];
+		uint8_t col = 0;
+		row[col++] = 0x0d;
+		row[col++] = 0x03 + l;
+		row[col++] = 0x0b;
+		row[col++] = 0x0b;
+		for (const char *c = LINES[l]; *c != '\0'; c++) row[col++] = *c;
+		row[col++] = 0x0a;
+		row[col++] = 0x0a;
+		while (col < 40) row[col++] = 0x20;
+	}
+	page_state->page_buffer.tainted = 1;
+	page_state->page_buffer.show_timestamp = 1000;
+	page_state->page_buffer.hide_timestamp = 2000;
+
+	const row_kernels_t *kernels = decoder->kernels;
+	prefilter_t prefilter = decoder->prefilter;
+	for (uint8_t i = 0; i < sizeof(MICRO_BENCHMARKS) / sizeof(MICRO_BENCHMARKS[0]); i++) {
+		const micro_benchmark_t *benchmark = &MICRO_BENCHMARKS[i];
+		if (benchmark->kernel == 0) run_micro(decoder, "scalar", benchmark);
+		else if (benchmark->kernel == 1) {
+			for (uint8_t k = 0; k < row_kernels_count; k++) {
+				decoder->kernels = ROW_KERNELS[k];
+				run_micro(decoder, ROW_KERNELS[k]->name, benchmark);
+			}
+			decoder->kernels = kernels;
+		}
+		else {
+			for (uint8_t k = 0; k < prefilters_count; k++) {
+				decoder->prefilter = PREFILTERS[k].run;
+				run_micro(decoder, PREFILTERS[k].name, benchmark);
+			}
+			decoder->prefilter = prefilter;
+		}
+	}
+
+	telxcc_destroy(decoder);
+}
+
+// synthetic corpus: one teletext PID with subtitle page 888 (serial mode, a caption every 2 s) in a multiplex of
+// video and audio PIDs -- about 1 % of TS packets carry teletext, as in real DVB broadcast
+
+static inline uint8_t odd_parity(uint8_t c) {
+	c &= 0x7f;
+	return (PARITY_8[c] > 0) ? c : (c | 0x80);
+}
+
+// ETS 300 706, chapter 7.1: data unit of packet; bytes are transmitted in reversed bit order
+static void put_data_unit(uint8_t *unit, uint8_t magazine, uint8_t row, const uint8_t *data) {
+	uint8_t address = (row << 3) | (magazine & 0x07);
+	unit[0] = DATA_UNIT_EBU_TELETEXT_SUBTITLE;
+	unit[1] = 0x2c;
+	unit[2] = 0x55;
+	unit[3] = 0xe4;
+	unit[4] = HAM_8_4[address & 0x0f];
+	unit[5] = HAM_8_4[address >> 4];
+	memcpy(unit + 6, data, 40);
+	for (uint8_t i = 2; i < 46; i++) unit[i] = REVERSE_8[unit[i]];
+}
+
+typedef struct {
+	uint8_t *data;
+	size_t size;
+	size_t capacity;
+	uint8_t cc[8192];
+} corpus_t;
+
+static void put_ts_packet(corpus_t *corpus, uint16_t pid, uint8_t pusi, const uint8_t *af, uint8_t af_size, const uint8_t *payload) {
+	uint8_t *p = corpus->data + corpus->size;
+	p[0] = 0x47;
+	p[1] = (pusi << 6) | (pid >> 8);
+	p[2] = pid & 0xff;
+	p[3] = 0x10 | ((af_size > 0) << 5) | (corpus->cc[pid]++ & 0x0f);
+	if (af_size > 0) memcpy(p + 4, af, af_size);
+	memcpy(p + 4 + af_size, payload, 184 - af_size);
+	corpus->size += TS_PACKET_SIZE;
+}
+
+static int build_corpus(corpus_t *corpus, size_t size) {
+	corpus->capacity = size - size % TS_PACKET_SIZE;
+	corpus->data = malloc(corpus->capacity);
+	if (corpus->data == NULL) return 0;
+	memset(corpus->cc, 0, sizeof(corpus->cc));
+	corpus->size = 0;
+	seed = 1;
+
+	static const char *WORDS[8] = { "hei", "og", "velkommen", "til", "dagsrevyen", "fredag", "kveld", "norge" };
+	uint64_t pts = 900000;
+	uint8_t filler[184];
+	for (uint32_t n = 0; corpus->size + 32 * TS_PACKET_SIZE <= corpus->capacity; n++) {
+		// PES: header, two subtitle rows (new text every 2 s) and stuffing units, ETSI EN 301 775
+		uint8_t pes[368];
+		memset(pes, 0xff, sizeof(pes));
+		memcpy(pes, "\x00\x00\x01\xbd\x01\x6a\x80\x80\x24", 9);
+		pes[9] = 0x21 | ((pts >> 29) & 0x0e);
+		pes[10] = (pts >> 22) & 0xff;
+		pes[11] = ((pts >> 14) & 0xfe) | 1;
+		pes[12] = (pts >> 7) & 0xff;
+		pes[13] = ((pts << 1) & 0xfe) | 1;
+		pes[45] = 0x10;
+
+		uint8_t data[40];
+		uint8_t header[8] = { HAM_8_4[8], HAM_8_4[8], HAM_8_4[0], HAM_8_4[0], HAM_8_4[0], HAM_8_4[8], HAM_8_4[0], HAM_8_4[1] };
+		memcpy(data, header, 8);
+		for (uint8_t i = 8; i < 40; i++) data[i] = odd_parity(' ');
+		put_data_unit(pes + 46, 8, 0, data);
+		for (uint8_t r = 0; r < 2; r++) {
+			uint32_t s = seed;
+			seed = (n / 50) * 2 + r + 1;
+			uint8_t col = 0;
+			data[col++] = odd_parity(0x0d);
+			data[col++] = odd_parity(0x0b);
+			data[col++] = odd_parity(0x0b);
+			while (col < 30) {
+				for (const char *c = WORDS[random_next() % 8]; (*c != '\0') && (col < 30); c++) data[col++] = odd_parity(*c);
+				data[col++] = odd_parity(' ');
+			}
+			data[col++] = odd_parity(0x0a);
+			data[col++] = odd_parity(0x0a);
+			while (col < 40) data[col++] = odd_parity(' ');
+			put_data_unit(pes + 46 + 46 * (r + 1), 8, 20 + 2 * r, data);
+			seed = s;
+		}
+		for (uint8_t u = 3; u < 7; u++) pes[46 + 46 * u + 1] = 0x2c;
+		put_ts_packet(corpus, 0x240, 1, NULL, 0, pes);
+		put_ts_packet(corpus, 0x240, 0, NULL, 0, pes + 184);
+
+		// 40 ms of video with PCR and audio
+		for (uint8_t k = 0; k < 30; k++) {
+			for (uint8_t i = 0; i < 184; i++) filler[i] = random_next();
+			if (k == 0) {
+				uint8_t af[8] = { 7, 0x10, (pts >> 25) & 0xff, (pts >> 17) & 0xff, (pts >> 9) & 0xff, (pts >> 1) & 0xff, ((pts & 1) << 7) | 0x7e, 0 };
+				put_ts_packet(corpus, 0x100, 0, af, sizeof(af), filler);
+			}
+			else if (k % 10 == 5) put_ts_packet(corpus, 0x101, (k == 5), NULL, 0, filler);
+			else put_ts_packet(corpus, 0x100, 0, NULL, 0, filler);
+		}
+		pts += 3600;
+	}
+
+	return 1;
+}
+
+static void count_callback(void *user_data, const telxcc_event_t *event) {
+	if (event->type == TELXCC_EVENT_CAPTION) (*(uint32_t *)user_data)++;
+}
+
+static void run_macro(const char *corpus_name, const uint8_t *data, size_t size, const char *mode) {
+	telxcc_config_t config;
+	telxcc_config_init(&config);
+	config.log = NULL;
+	if (strcmp(mode, "all") == 0) {
+		config.all_pids = 1;
+		config.all_pages = 1;
+	}
+
+	// best of 3 runs
+	uint64_t best = UINT64_MAX;
+	uint32_t captions = 0;
+	telxcc_stats_t stats = { 0 };
+	uint16_t packet_size = TS_PACKET_SIZE;
+	for (uint8_t k = 0; k < 3; k++) {
+		captions = 0;
+		telxcc_decoder_t *decoder = telxcc_create(&config, count_callback, &captions);
+		if (decoder == NULL) return;
+		uint64_t t = now_ns();
+		for (size_t i = 0; i < size; i += PUSH_SIZE) telxcc_push(decoder, data + i, (size - i < PUSH_SIZE) ? size - i : PUSH_SIZE);
+		t = now_ns() - t;
+		telxcc_get_stats(decoder, &stats);
+		if (decoder->packet_size > 0) packet_size = decoder->packet_size;
+		telxcc_destroy(decoder);
+		if (t < best) best = t;
+	}
+	if (best == 0) best = 1;
+
+	uint64_t packets = size / packet_size;
+	printf("{\"type\":\"macro\",\"corpus\":");
+	print_name(corpus_name);
+	printf(",\"mode\":");
+	print_name(mode);
+	printf(",\"bytes\":%zu,\"ts_packets\":%"PRIu64",\"teletext_packets\":%"PRIu32",\"captions\":%"PRIu32",\"ns\":%"PRIu64, size, packets, stats.packets, captions, best);
+	printf(",\"mib_per_s\":%.1f,\"packets_per_s\":%.0f,\"ns_per_packet\":%.2f}\n",
+		(double)size / (1024 * 1024) / (best / 1e9), packets / (best / 1e9), (double)best / packets);
+	fflush(stdout);
+}
+
+static void macro_benchmarks(const char *corpus_name, const uint8_t *data, size_t size) {
+	run_macro(corpus_name, data, size, "auto");
+	run_macro(corpus_name, data, size, "all");
+}
+
+static uint8_t *read_file(const char *filename, size_t *size) {
+	FILE *f = fopen(filename, "rb");
+	if (f == NULL) return NULL;
+	uint8_t *data = NULL;
+	size_t capacity = 0;
+	*size = 0;
+	while (1) {
+		if (*size == capacity) {
+			capacity = (capacity > 0) ? capacity * 2 : 1024 * 1024;
+			uint8_t *d = realloc(data, capacity);
+			if (d == NULL) {
+				free(data);
+				fclose(f);
+				return NULL;
+			}
+			data = d;
+		}
+		size_t n = fread(data + *size, 1, capacity - *size, f);
+		if (n == 0) break;
+		*size += n;
+	}
+	fclose(f);
+	return data;
+}
+
+int main(const int argc, char *argv[]) {
+	size_t corpus_size = CORPUS_SIZE;
+	uint8_t micro = 1;
+	int i = 1;
+	for (; i < argc; i++) {
+		if ((strcmp(argv[i], "-s") == 0) && (argc > i + 1)) corpus_size = (size_t)atoi(argv[++i]) * 1024 * 1024;
+		else if (strcmp(argv[i], "-M") == 0) micro = 0;
+		else if (strcmp(argv[i], "-h") == 0) {
+			fprintf(stderr, "Usage: telxcc-bench [-h] [-s MIB] [-M] [FILE...]\n");
+			fprintf(stderr, "  -s MIB      synthetic corpus size in MiB (default: %d, 0 = none)\n", CORPUS_SIZE / (1024 * 1024));
+			fprintf(stderr, "  -M          end-to-end benchmarks only\n");
+			fprintf(stderr, "  FILE        TS file decoded end-to-end in addition to synthetic corpus\n");
+			fprintf(stderr, "  STDOUT      results, one JSON object per line\n");
+			return EXIT_SUCCESS;
+		}
+		else break;
+	}
+
+	const char *prefilter_name = NULL;
+	select_prefilter(&prefilter_name);
+	char host[256] = { 0 };
+	gethostname(host, sizeof(host) - 1);
+	printf("{\"type\":\"info\",\"host\":");
+	print_name(host);
+	printf(",\"compiler\":");
+	print_name(__VERSION__);
+	printf(",\"built\":");
+	print_name(__DATE__ " " __TIME__);
+	printf(",\"prefilter\":");
+	print_name(prefilter_name);
+	printf(",\"kernels\":");
+	print_name(select_row_kernels()->name);
+	printf(",\"time\":%"PRIu64"}\n", (uint64_t)time(NULL));
+
+	if (micro == 1) micro_benchmarks();
+
+	if (corpus_size > 0) {
+		corpus_t corpus;
+		if (build_corpus(&corpus, corpus_size) == 0) {
+			fprintf(stderr, "- Could not allocate synthetic corpus\n");
+			return EXIT_FAILURE;
+		}
+		macro_benchmarks("synthetic", corpus.data, corpus.size);
+		free(corpus.data);
+	}
+
+	for (; i < argc; i++) {
+		size_t size = 0;
+		uint8_t *data = read_file(argv[i], &size);
+		if (data == NULL) {
+			fprintf(stderr, "- Could not read %s\n", argv[i]);
+			continue;
+		}
+		macro_benchmarks(argv[i], data, size);
+		free(data);
+	}
+
+	return EXIT_SUCCESS;
+}
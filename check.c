@@ -0,0 +1,192 @@
+/*!
+(c) 2011-2012 Petr Kutalek, Forers, s. r. o.: telxcc
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+
+telxcc-check: checks of decoder behaviour not visible in extracted captions
+
+Compares teletext row kernels of all SIMD implementations the CPU supports with lookup tables, then decodes TS file
+given on command line (generated by telxcc-gen, each caption transmitted once) through library API, pushed in chunks
+of various sizes, and checks decoder statistics; results go to STDERR, exit code is non-zero if any check failed.
+*/
+
+// decoder is compiled in, so its internals can be checked
+#include "libtelxcc.c"
+
+// chunk size data are pushed into decoder in, same as telxcc reads
+#define PUSH_SIZE 65536
+
+static uint8_t *input = NULL;
+static size_t input_size = 0;
+
+static uint32_t failures = 0;
+
+static void callback(void *user_data, const telxcc_event_t *event) {
+}
+
+// decodes whole input pushed in chunks of chunk_size bytes
+static int decode(const telxcc_config_t *config, size_t chunk_size, telxcc_stats_t *stats) {
+	telxcc_decoder_t *decoder = telxcc_create(config, callback, NULL);
+	if (decoder == NULL) {
+		fprintf(stderr, "- Not enough memory\n");
+		return -1;
+	}
+	for (size_t i = 0; i < input_size; i += chunk_size)
+		telxcc_push(decoder, input + i, (input_size - i < chunk_size) ? input_size - i : chunk_size);
+	telxcc_flush(decoder);
+	telxcc_get_stats(decoder, stats);
+	telxcc_destroy(decoder);
+	return 0;
+}
+
+static void report(const char *name, uint8_t passed) {
+	fprintf(stderr, "- %s: %s\n", name, (passed == 1) ? "ok" : "FAILED");
+	if (passed == 0) failures++;
+}
+
+// differential check of row kernels against lookup tables over all byte values in all positions
+static uint8_t check_row_kernels(const row_kernels_t *kernels) {
+	uint8_t data[44], expected[44], result[44];
+	for (uint16_t k = 0; k < 256; k++) {
+		for (uint8_t i = 0; i < 44; i++) data[i] = k + i * 7;
+
+		memcpy(result, data, 44);
+		kernels->reverse_44(result);
+		for (uint8_t i = 0; i < 44; i++) expected[i] = REVERSE_8[data[i]];
+		if (memcmp(result, expected, 44) != 0) return 0;
+
+		kernels->parity_40(data, result);
+		for (uint8_t i = 0; i < 40; i++) expected[i] = (PARITY_8[data[i]] > 0) ? (data[i] & 0x7f) : 0x80;
+		if (memcmp(result, expected, 40) != 0) return 0;
+
+		kernels->unham_16(data, result);
+		for (uint8_t i = 0; i < 16; i++) expected[i] = UNHAM_8_4[data[i]] & 0x0f;
+		if (memcmp(result, expected, 16) != 0) return 0;
+	}
+
+	// triplets: pseudo-random bytes hit all error classes
+	uint32_t seed = 1;
+	for (uint16_t k = 0; k < 4096; k++) {
+		x26_triplet_t triplets[13];
+		for (uint8_t i = 0; i < 40; i++) {
+			seed = seed * 1103515245 + 12345;
+			data[i] = seed >> 16;
+		}
+		kernels->unham_x26(data, triplets);
+		for (uint8_t j = 0; j < 13; j++) {
+			uint32_t r = unham_24_18((data[3 * j + 3] << 16) | (data[3 * j + 2] << 8) | data[3 * j + 1]);
+			uint8_t error = ((r & 0x80000000) > 0);
+			if (error == 1) r = 0;
+			if ((triplets[j].address != (r & 0x3f)) || (triplets[j].mode != ((r & 0x7c0) >> 6)) ||
+				(triplets[j].data != ((r & 0x3f800) >> 11)) || (triplets[j].error != error)) return 0;
+		}
+	}
+	return 1;
+}
+
+static void check_kernels(void) {
+	const row_kernels_t *kernels[2] = { &ROW_KERNELS_SCALAR, NULL };
+#if defined(ROW_SSSE3)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("ssse3")) kernels[1] = &ROW_KERNELS_SSSE3;
+#elif defined(ROW_NEON)
+	kernels[1] = &ROW_KERNELS_NEON;
+#endif
+	for (uint8_t i = 0; (i < 2) && (kernels[i] != NULL); i++) {
+		char name[64];
+		snprintf(name, sizeof(name), "%s teletext row kernels", kernels[i]->name);
+		report(name, check_row_kernels(kernels[i]));
+	}
+}
+
+// held caption (config.merge_repeats) is emitted at the next page header, but its latency counts from its own page
+// header; with no retransmissions to merge, latency histogram must not depend on merging
+static void check_merge_latency(void) {
+	telxcc_config_t config;
+	telxcc_config_init(&config);
+	config.log = NULL;
+
+	telxcc_stats_t merged, unmerged;
+	config.merge_repeats = 1;
+	if (decode(&config, PUSH_SIZE, &merged) != 0) return;
+	config.merge_repeats = 0;
+	if (decode(&config, PUSH_SIZE, &unmerged) != 0) return;
+
+	uint8_t passed = ((merged.captions > 0) && (merged.repeats == 0) && (merged.captions == unmerged.captions));
+	for (uint8_t i = 0; i < TELXCC_LATENCY_BUCKETS; i++) {
+		if (merged.latency[i] != unmerged.latency[i]) {
+			fprintf(stderr, "- latency bucket %u: %u merged, %u not merged\n", i, merged.latency[i], unmerged.latency[i]);
+			passed = 0;
+		}
+	}
+	report("latency of merged captions", passed);
+}
+
+// UDP datagram carries 7 TS packets (1316 bytes); TS packet pre-filter must skip packets of input pushed so too
+static void check_udp_prefilter(void) {
+	telxcc_config_t config;
+	telxcc_config_init(&config);
+	config.log = NULL;
+
+	telxcc_stats_t stats;
+	if (decode(&config, 7 * 188, &stats) != 0) return;
+	if (stats.ts_packets_parsed >= stats.ts_packets) fprintf(stderr, "- %" PRIu64 " of %" PRIu64 " TS packets parsed\n", stats.ts_packets_parsed, stats.ts_packets);
+	report("pre-filter of UDP datagrams", (stats.ts_packets > 0) && (stats.ts_packets_parsed < stats.ts_packets));
+}
+
+static uint8_t *read_file(const char *filename, size_t *size) {
+	FILE *f = fopen(filename, "rb");
+	if (f == NULL) return NULL;
+	uint8_t *data = NULL;
+	size_t capacity = 0;
+	*size = 0;
+	while (1) {
+		if (*size == capacity) {
+			capacity = (capacity > 0) ? capacity * 2 : 1024 * 1024;
+			uint8_t *d = realloc(data, capacity);
+			if (d == NULL) {
+				free(data);
+				fclose(f);
+				return NULL;
+			}
+			data = d;
+		}
+		size_t n = fread(data + *size, 1, capacity - *size, f);
+		if (n == 0) break;
+		*size += n;
+	}
+	fclose(f);
+	return data;
+}
+
+int main(const int argc, char *argv[]) {
+	if (argc != 2) {
+		fprintf(stderr, "Usage: telxcc-check FILE\n");
+		return EXIT_FAILURE;
+	}
+
+	input = read_file(argv[1], &input_size);
+	if (input == NULL) {
+		fprintf(stderr, "- Could not read %s\n", argv[1]);
+		return EXIT_FAILURE;
+	}
+
+	check_kernels();
+	check_merge_latency();
+	check_udp_prefilter();
+
+	free(input);
+	return (failures > 0) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
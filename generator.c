@@ -0,0 +1,575 @@
+/*!
+(c) 2011-2012 Petr Kutalek, Forers, s. r. o.: telxcc
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+
+telxcc-gen: deterministic synthetic teletext transport stream generator
+
+Writes a DVB multiplex -- PAT, PMT, video and audio PIDs and teletext PIDs carrying subtitle pages -- for testing
+and load generation. The same options and seed always produce byte-identical output.
+
+Stream layout (one frame = 40 ms):
+	every frame: PCR on video PID, video and audio filler packets, one teletext PES per teletext PID
+	PAT and PMT every 10 frames
+	caption of each page: shown for 3 s, then 1 s pause (page header with no rows terminates it)
+
+Further Documentation:
+	ISO/IEC 13818-1 (PAT, PMT, PES, PCR)
+	ETSI EN 300 472 (teletext in DVB: PES and data units), ETSI EN 300 468 (teletext descriptor 0x56)
+	ETS 300 706 (teletext packets, Hamming 8/4 and 24/18, X/26 enhancements)
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <inttypes.h>
+#include "tables_hamming.h"
+#include "tables_teletext.h"
+
+#define TS_PACKET_SIZE 188
+
+#define MAX_PIDS 32
+#define MAX_PAGES 16
+// header, X/28 (or M/29), X/26 and two rows of every page
+#define MAX_UNITS (5 * MAX_PAGES)
+
+// PIDs of multiplex
+#define PID_PMT 0x1000
+#define PID_VIDEO 0x100
+#define PID_AUDIO 0x101
+#define PID_TELETEXT 0x240
+
+// 90 kHz clock: frame duration, caption show and pause durations
+#define FRAME 3600
+#define CAPTION_FRAMES 75
+#define PAUSE_FRAMES 25
+
+typedef struct {
+	uint32_t seconds;
+	uint64_t size; // stop at this output size instead of duration, 0 = not set
+	uint8_t pids_count;
+	uint16_t pages[MAX_PAGES];
+	uint8_t pages_count;
+	transmission_mode_t transmission_mode;
+	uint8_t charset;
+	// default G0 designation code (ETS 300 706, chapter 15.2, table 32) in X/28/0 (or M/29/0), 255 = none
+	uint8_t designation;
+	uint8_t designation_m29;
+	double x26_density;
+	// transmissions of every caption (broadcasters resend pages)
+	uint8_t transmissions;
+	uint8_t wrap;
+	double gap_rate;
+	double error_rate;
+	uint16_t filler;
+	uint16_t packet_size;
+	uint64_t seed;
+} generator_config_t;
+
+static generator_config_t config = {
+	.seconds = 60,
+	.size = 0,
+	.pids_count = 1,
+	.pages = { 0x888 },
+	.pages_count = 1,
+	.transmission_mode = TRANSMISSION_MODE_SERIAL,
+	.charset = 0,
+	.designation = 255,
+	.designation_m29 = 0,
+	.x26_density = 0.0,
+	.transmissions = 1,
+	.wrap = 0,
+	.gap_rate = 0.0,
+	.error_rate = 0.0,
+	.filler = 40,
+	.packet_size = 188,
+	.seed = 1
+};
+
+// xorshift64*, deterministic on all platforms
+static uint64_t random_state;
+static inline uint64_t random_next(void) {
+	random_state ^= random_state >> 12;
+	random_state ^= random_state << 25;
+	random_state ^= random_state >> 27;
+	return random_state * 0x2545f4914f6cdd1dULL;
+}
+
+// uniform in [0, 1)
+static inline double random_double(void) {
+	return (random_next() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// output
+static uint8_t continuity_counters[8192];
+static uint64_t written = 0;
+static uint64_t packets_written = 0;
+// 27 MHz arrival clock of M2TS timecodes
+static uint64_t arrival_clock = 0;
+
+static void write_ts_packet(const uint8_t *packet) {
+	uint8_t prefix[4];
+	if (config.packet_size == 192) {
+		// M2TS: copy permission indicator (2 bits) + 30-bit arrival timestamp
+		uint32_t t = arrival_clock & 0x3fffffff;
+		prefix[0] = t >> 24;
+		prefix[1] = t >> 16;
+		prefix[2] = t >> 8;
+		prefix[3] = t;
+		fwrite(prefix, 1, 4, stdout);
+	}
+	fwrite(packet, 1, TS_PACKET_SIZE, stdout);
+	if (config.packet_size == 204) {
+		// Reed-Solomon parity is not computed, decoders do not check it
+		static const uint8_t parity[16] = { 0 };
+		fwrite(parity, 1, 16, stdout);
+	}
+	written += config.packet_size;
+	packets_written++;
+}
+
+// af (adaptation field including its length byte) may be NULL; payload is padded by adaptation field stuffing
+static void put_ts_packet(uint16_t pid, uint8_t pusi, const uint8_t *af, uint8_t af_size, const uint8_t *payload, uint8_t payload_size, uint8_t teletext) {
+	uint8_t packet[TS_PACKET_SIZE];
+	uint8_t cc = continuity_counters[pid]++ & 0x0f;
+
+	// stuffing needed
+	uint8_t stuffing = 184 - af_size - payload_size;
+	uint8_t af_buffer[184];
+	if ((stuffing > 0) && (af_size == 0)) {
+		af_buffer[0] = stuffing - 1;
+		if (stuffing > 1) af_buffer[1] = 0x00;
+		memset(af_buffer + 2, 0xff, (stuffing > 2) ? stuffing - 2 : 0);
+		af = af_buffer;
+		af_size = stuffing;
+	}
+	else if (stuffing > 0) {
+		memcpy(af_buffer, af, af_size);
+		memset(af_buffer + af_size, 0xff, stuffing);
+		af_buffer[0] += stuffing;
+		af = af_buffer;
+		af_size += stuffing;
+	}
+
+	packet[0] = 0x47;
+	packet[1] = (pusi << 6) | (pid >> 8);
+	packet[2] = pid & 0xff;
+	packet[3] = ((af_size > 0) << 5) | ((payload_size > 0) << 4) | cc;
+	if (af_size > 0) memcpy(packet + 4, af, af_size);
+	memcpy(packet + 4 + af_size, payload, payload_size);
+
+	if (teletext == 1) {
+		// missing packet: continuity counter gap
+		if ((config.gap_rate > 0) && (random_double() < config.gap_rate)) return;
+
+		// bit errors in payload (sync byte and header stay intact, so only teletext decoding is affected)
+		if (config.error_rate > 0) {
+			double p = 1.0 - pow(1.0 - config.error_rate, 8);
+			for (uint8_t i = 4 + af_size; i < TS_PACKET_SIZE; i++)
+				if (random_double() < p) packet[i] ^= 1 << (random_next() % 8);
+		}
+	}
+
+	write_ts_packet(packet);
+}
+
+// ISO/IEC 13818-1, annex A: CRC-32 of PSI sections
+static uint32_t crc32_mpeg(const uint8_t *data, size_t size) {
+	uint32_t crc = 0xffffffff;
+	for (size_t i = 0; i < size; i++) {
+		crc ^= (uint32_t)data[i] << 24;
+		for (uint8_t k = 0; k < 8; k++) crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04c11db7 : crc << 1;
+	}
+	return crc;
+}
+
+static void put_section(uint16_t pid, uint8_t *section, uint16_t size) {
+	// section_length covers bytes after it including CRC
+	uint16_t section_length = size - 3 + 4;
+	section[1] = 0xb0 | (section_length >> 8);
+	section[2] = section_length & 0xff;
+	uint32_t crc = crc32_mpeg(section, size);
+	section[size++] = crc >> 24;
+	section[size++] = crc >> 16;
+	section[size++] = crc >> 8;
+	section[size++] = crc;
+
+	uint8_t payload[184];
+	payload[0] = 0; // pointer_field
+	memcpy(payload + 1, section, size);
+	memset(payload + 1 + size, 0xff, 183 - size);
+	put_ts_packet(pid, 1, NULL, 0, payload, 184, 0);
+}
+
+static void put_pat(void) {
+	uint8_t section[180] = { 0x00, 0, 0, 0x00, 0x01, 0xc1, 0x00, 0x00, 0x00, 0x01, 0xe0 | (PID_PMT >> 8), PID_PMT & 0xff };
+	put_section(0x0000, section, 12);
+}
+
+static void put_pmt(void) {
+	uint8_t section[180] = { 0x02, 0, 0, 0x00, 0x01, 0xc1, 0x00, 0x00, 0xe0 | (PID_VIDEO >> 8), PID_VIDEO & 0xff, 0xf0, 0x00 };
+	uint16_t n = 12;
+	static const uint8_t streams[2][5] = {
+		{ 0x02, 0xe0 | (PID_VIDEO >> 8), PID_VIDEO & 0xff, 0xf0, 0x00 },
+		{ 0x03, 0xe0 | (PID_AUDIO >> 8), PID_AUDIO & 0xff, 0xf0, 0x00 }
+	};
+	memcpy(section + n, streams, sizeof(streams));
+	n += sizeof(streams);
+
+	for (uint8_t i = 0; i < config.pids_count; i++) {
+		uint16_t pid = PID_TELETEXT + i;
+		// ETSI EN 300 468, chapter 6.2.43: teletext descriptor, one entry per subtitle page
+		uint8_t descriptor_size = 2 + 5 * config.pages_count;
+		section[n++] = 0x06;
+		section[n++] = 0xe0 | (pid >> 8);
+		section[n++] = pid & 0xff;
+		section[n++] = 0xf0;
+		section[n++] = descriptor_size;
+		section[n++] = 0x56;
+		section[n++] = descriptor_size - 2;
+		for (uint8_t j = 0; j < config.pages_count; j++) {
+			memcpy(section + n, "nor", 3);
+			section[n + 3] = (0x02 << 3) | ((config.pages[j] >> 8) & 0x07);
+			section[n + 4] = config.pages[j] & 0xff;
+			n += 5;
+		}
+	}
+	put_section(PID_PMT, section, n);
+}
+
+// teletext encoding
+
+static inline uint8_t odd_parity(uint8_t c) {
+	c &= 0x7f;
+	return (PARITY_8[c] > 0) ? c : (c | 0x80);
+}
+
+// ETS 300 706, chapter 8.3: Hamming 24/18; data bits D1 -- D18 in bits 0 -- 17, bit n of result is bit n + 1 of
+// triplet (P1 P2 D1 P3 D2 D3 D4 P4 D5 ... D11 P5 D12 ... D18 P6)
+static uint32_t ham_24_18(uint32_t d) {
+	uint8_t bits[25] = { 0 };
+	uint8_t k = 0;
+	for (uint8_t p = 1; p < 24; p++) {
+		// P1 -- P5: odd parity of bits they cover
+		if ((p & (p - 1)) == 0) bits[p] = 1;
+		else bits[p] = (d >> k++) & 1;
+	}
+	for (uint8_t q = 1; q < 24; q <<= 1)
+		for (uint8_t p = 1; p < 24; p++)
+			if (((p & q) > 0) && (p != q)) bits[q] ^= bits[p];
+	// P6: odd parity of whole triplet
+	uint8_t parity = 1;
+	for (uint8_t p = 1; p < 24; p++) parity ^= bits[p];
+	bits[24] = parity;
+
+	uint32_t r = 0;
+	for (uint8_t p = 1; p <= 24; p++) r |= (uint32_t)bits[p] << (p - 1);
+	return r;
+}
+
+typedef struct {
+	uint8_t units[MAX_UNITS][44];
+	uint8_t data_unit_ids[MAX_UNITS];
+	uint8_t count;
+} pes_units_t;
+
+// ETS 300 706, chapter 7.1: clock run-in, framing code, packet address, data; bytes in reversed bit order
+static void add_unit(pes_units_t *pes, data_unit_t data_unit_id, uint8_t magazine, uint8_t row, const uint8_t *data) {
+	if (pes->count == MAX_UNITS) return;
+	uint8_t *unit = pes->units[pes->count];
+	uint8_t address = (row << 3) | (magazine & 0x07);
+	unit[0] = 0x55;
+	unit[1] = 0xe4;
+	unit[2] = HAM_8_4[address & 0x0f];
+	unit[3] = HAM_8_4[address >> 4];
+	memcpy(unit + 4, data, 40);
+	for (uint8_t i = 0; i < 44; i++) unit[i] = REVERSE_8[unit[i]];
+	pes->data_unit_ids[pes->count++] = data_unit_id;
+}
+
+// ETS 300 706, chapter 9.3.1: page header; erase page, subtitle, national option character subset
+static void add_header(pes_units_t *pes, uint16_t page) {
+	uint8_t data[40];
+	data[0] = HAM_8_4[page & 0x0f];
+	data[1] = HAM_8_4[(page >> 4) & 0x0f];
+	data[2] = HAM_8_4[0];
+	data[3] = HAM_8_4[0x08]; // C4 erase page
+	data[4] = HAM_8_4[0];
+	data[5] = HAM_8_4[0x08]; // C6 subtitle
+	data[6] = HAM_8_4[0];
+	data[7] = HAM_8_4[((config.charset & 0x07) << 1) | config.transmission_mode];
+	static const char *TITLE = "telxcc-gen      Fri 01 Jan 12:00:00";
+	for (uint8_t i = 8; i < 40; i++) data[i] = odd_parity(TITLE[i - 8]);
+	add_unit(pes, DATA_UNIT_EBU_TELETEXT_SUBTITLE, page >> 8, 0, data);
+}
+
+// ETS 300 706, chapters 9.4.2 and 9.5.1: X/28/0 Format 1 (or M/29/0) with default G0 designation, Level 1 page
+// of 7-bit characters, no second G0 set (designated the same)
+static void add_designation(pes_units_t *pes, uint16_t page) {
+	uint8_t data[40];
+	uint32_t t1 = (config.designation << 7) | ((config.designation & 0x0f) << 14);
+	uint32_t t2 = (config.designation >> 4) & 0x07;
+	data[0] = HAM_8_4[0]; // designation code
+	for (uint8_t j = 0; j < 13; j++) {
+		uint32_t t = ham_24_18((j == 0) ? t1 : ((j == 1) ? t2 : 0));
+		data[1 + 3 * j] = t & 0xff;
+		data[2 + 3 * j] = (t >> 8) & 0xff;
+		data[3 + 3 * j] = (t >> 16) & 0xff;
+	}
+	add_unit(pes, DATA_UNIT_EBU_TELETEXT_SUBTITLE, page >> 8, (config.designation_m29 == 1) ? 29 : 28, data);
+}
+
+// words contain characters of national option subset positions too
+static const char *WORDS[] = {
+	"hei", "og", "velkommen", "til", "dagsrevyen", "det", "er", "fredag", "kveld", "i", "norge", "vi", "ser",
+	"p{", "n|", "sn}", "[r", "\\ye", "]re", "#1", "$5", "@", "^", "_", "`", "~"
+};
+
+// ETS 300 706, chapter 12.3.1, table 27: G0 character with diacritical mark (mode 0x11 -- 0x1f) at column
+static inline uint32_t x26_triplet(uint8_t address, uint8_t mode, uint8_t data) {
+	return ham_24_18(address | (mode << 6) | (data << 11));
+}
+
+// caption rows 20 and 22: boxed text, sometimes coloured; X/26 packet (sent before rows) with diacritics
+static void add_caption(pes_units_t *pes, uint16_t page) {
+	uint8_t rows[2][40];
+	uint32_t triplets[13];
+	uint8_t triplets_count = 0;
+	int8_t position_row = -1;
+	uint8_t x26 = (config.x26_density > 0) && (random_double() < config.x26_density);
+
+	for (uint8_t r = 0; r < 2; r++) {
+		uint8_t *row = rows[r];
+		uint8_t col = 0;
+		row[col++] = 0x0d; // double height
+		if (random_next() % 4 == 0) row[col++] = 1 + random_next() % 7; // alpha colour
+		row[col++] = 0x0b; // start box
+		row[col++] = 0x0b;
+		uint8_t width = 24 + random_next() % 10;
+		while (col < width) {
+			for (const char *c = WORDS[random_next() % (sizeof(WORDS) / sizeof(WORDS[0]))]; (*c != '\0') && (col < width); c++) {
+				// diacritic on a letter; active position moves to the row first
+				if (x26 && (triplets_count < 11) && (*c >= 'a') && (*c <= 'z') && (random_next() % 6 == 0)) {
+					if (position_row != r) {
+						triplets[triplets_count++] = x26_triplet(40 + 20 + 2 * r, 0x04, 0);
+						position_row = r;
+					}
+					triplets[triplets_count++] = x26_triplet(col, 0x11 + random_next() % 15, *c);
+				}
+				row[col++] = *c;
+			}
+			if (col < width) row[col++] = ' ';
+		}
+		row[col++] = 0x0a; // end box
+		row[col++] = 0x0a;
+		while (col < 40) row[col++] = ' ';
+		for (uint8_t i = 0; i < 40; i++) row[i] = odd_parity(row[i]);
+	}
+
+	if (triplets_count > 0) {
+		// termination marker fills the rest
+		while (triplets_count < 13) triplets[triplets_count++] = x26_triplet(63, 0x1f, 0);
+		uint8_t data[40];
+		data[0] = HAM_8_4[0]; // designation code
+		for (uint8_t j = 0; j < 13; j++) {
+			uint32_t t = triplets[j];
+			data[1 + 3 * j] = t & 0xff;
+			data[2 + 3 * j] = (t >> 8) & 0xff;
+			data[3 + 3 * j] = (t >> 16) & 0xff;
+		}
+		add_unit(pes, DATA_UNIT_EBU_TELETEXT_SUBTITLE, page >> 8, 26, data);
+	}
+	add_unit(pes, DATA_UNIT_EBU_TELETEXT_SUBTITLE, page >> 8, 20, rows[0]);
+	add_unit(pes, DATA_UNIT_EBU_TELETEXT_SUBTITLE, page >> 8, 22, rows[1]);
+}
+
+// ETSI EN 300 472, chapter 4.3: PES of N TS packets carries 4N - 1 data units, padded by stuffing units
+static void put_pes(uint16_t pid, const pes_units_t *units, uint64_t pts) {
+	uint8_t n = (units->count + 1 + 3) / 4;
+	uint16_t size = n * 184;
+	uint8_t pes[(MAX_UNITS + 4) / 4 * 184];
+	memset(pes, 0xff, size);
+	uint16_t pes_packet_length = size - 6;
+	pes[0] = 0x00;
+	pes[1] = 0x00;
+	pes[2] = 0x01;
+	pes[3] = 0xbd;
+	pes[4] = pes_packet_length >> 8;
+	pes[5] = pes_packet_length & 0xff;
+	pes[6] = 0x80;
+	pes[7] = 0x80; // PTS only
+	pes[8] = 0x24;
+	pes[9] = 0x21 | ((pts >> 29) & 0x0e);
+	pes[10] = (pts >> 22) & 0xff;
+	pes[11] = ((pts >> 14) & 0xfe) | 1;
+	pes[12] = (pts >> 7) & 0xff;
+	pes[13] = ((pts << 1) & 0xfe) | 1;
+	pes[45] = 0x10; // data_identifier: EBU data
+	for (uint8_t i = 0; i < 4 * n - 1; i++) {
+		uint8_t *unit = pes + 46 + 46 * i;
+		if (i < units->count) {
+			unit[0] = units->data_unit_ids[i];
+			unit[1] = 0x2c;
+			memcpy(unit + 2, units->units[i], 44);
+		}
+		else unit[1] = 0x2c;
+	}
+	for (uint8_t i = 0; i < n; i++) put_ts_packet(pid, (i == 0), NULL, 0, pes + 184 * i, 184, 1);
+}
+
+static void put_filler(uint16_t pid, uint8_t pusi, uint64_t pcr) {
+	uint8_t payload[184];
+	for (uint8_t i = 0; i < 184; i += 8) {
+		uint64_t r = random_next();
+		memcpy(payload + i, &r, (i + 8 <= 184) ? 8 : 184 - i);
+	}
+	if (pcr != UINT64_MAX) {
+		uint8_t af[8] = { 7, 0x10, (pcr >> 25) & 0xff, (pcr >> 17) & 0xff, (pcr >> 9) & 0xff, (pcr >> 1) & 0xff, ((pcr & 1) << 7) | 0x7e, 0 };
+		put_ts_packet(pid, pusi, af, sizeof(af), payload, 184 - sizeof(af), 0);
+	}
+	else put_ts_packet(pid, pusi, NULL, 0, payload, 184, 0);
+}
+
+static int parse_pages(const char *s) {
+	config.pages_count = 0;
+	while (*s != '\0') {
+		char *end = NULL;
+		unsigned long page = strtoul(s, &end, 16);
+		if ((end == s) || (page < 0x100) || (page > 0x899) || (config.pages_count == MAX_PAGES)) return 0;
+		config.pages[config.pages_count++] = page;
+		s = end;
+		if (*s == ',') s++;
+	}
+	return config.pages_count > 0;
+}
+
+int main(const int argc, char *argv[]) {
+	for (int i = 1; i < argc; i++) {
+		if ((strcmp(argv[i], "-s") == 0) && (argc > i + 1)) config.seconds = atoi(argv[++i]);
+		else if ((strcmp(argv[i], "-b") == 0) && (argc > i + 1)) config.size = (uint64_t)atoi(argv[++i]) * 1024 * 1024;
+		else if ((strcmp(argv[i], "-t") == 0) && (argc > i + 1)) config.pids_count = atoi(argv[++i]);
+		else if ((strcmp(argv[i], "-p") == 0) && (argc > i + 1)) {
+			if (parse_pages(argv[++i]) == 0) {
+				fprintf(stderr, "- Invalid page list %s\n", argv[i]);
+				exit(EXIT_FAILURE);
+			}
+		}
+		else if (strcmp(argv[i], "-P") == 0) config.transmission_mode = TRANSMISSION_MODE_PARALLEL;
+		else if ((strcmp(argv[i], "-c") == 0) && (argc > i + 1)) config.charset = atoi(argv[++i]) & 0x07;
+		else if ((strcmp(argv[i], "-l") == 0) && (argc > i + 1)) {
+			config.designation = strtol(argv[++i], NULL, 0) & 0x7f;
+			// page header carries national option bits of designation
+			config.charset = config.designation & 0x07;
+		}
+		else if (strcmp(argv[i], "-M") == 0) config.designation_m29 = 1;
+		else if ((strcmp(argv[i], "-x") == 0) && (argc > i + 1)) config.x26_density = atof(argv[++i]);
+		else if ((strcmp(argv[i], "-k") == 0) && (argc > i + 1)) config.transmissions = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-w") == 0) config.wrap = 1;
+		else if ((strcmp(argv[i], "-g") == 0) && (argc > i + 1)) config.gap_rate = atof(argv[++i]);
+		else if ((strcmp(argv[i], "-e") == 0) && (argc > i + 1)) config.error_rate = atof(argv[++i]);
+		else if ((strcmp(argv[i], "-m") == 0) && (argc > i + 1)) config.filler = atoi(argv[++i]);
+		else if ((strcmp(argv[i], "-z") == 0) && (argc > i + 1)) config.packet_size = atoi(argv[++i]);
+		else if ((strcmp(argv[i], "-r") == 0) && (argc > i + 1)) config.seed = strtoull(argv[++i], NULL, 10);
+		else {
+			fprintf(stderr, "telxcc-gen - synthetic teletext transport stream generator\n");
+			fprintf(stderr, "Usage: telxcc-gen [-h] [-s SECONDS] [-b MIB] [-t PIDS] [-p PAGE[,PAGE...]] [-P] [-c CHARSET] [-l CODE [-M]]\n");
+			fprintf(stderr, "                  [-x DENSITY] [-k COUNT] [-w] [-g RATE] [-e RATE] [-m PACKETS] [-z SIZE] [-r SEED]\n");
+			fprintf(stderr, "  STDOUT      transport stream\n");
+			fprintf(stderr, "  -h          this help text\n");
+			fprintf(stderr, "  -s SECONDS  duration (default: 60)\n");
+			fprintf(stderr, "  -b MIB      output size in MiB, overrides duration\n");
+			fprintf(stderr, "  -t PIDS     number of teletext PIDs, from 0x%x (default: 1)\n", PID_TELETEXT);
+			fprintf(stderr, "  -p PAGE     comma separated list of subtitle pages in each PID (default: 888)\n");
+			fprintf(stderr, "  -P          parallel transmission mode (default: serial)\n");
+			fprintf(stderr, "  -c CHARSET  G0 Latin national option subset 0 -- 7 (default: 0)\n");
+			fprintf(stderr, "  -l CODE     X/28/0 with default G0 set designation and national option CODE (ETS 300 706,\n");
+			fprintf(stderr, "                table 32, e.g. 0x21 = Russian), overrides -c (default: none)\n");
+			fprintf(stderr, "  -M          designation in M/29/0 (whole magazine) instead of X/28/0\n");
+			fprintf(stderr, "  -x DENSITY  fraction of captions with X/26 diacritics packet, 0.0 -- 1.0 (default: 0.0)\n");
+			fprintf(stderr, "  -k COUNT    transmissions of every caption, 1 -- 15 (default: 1)\n");
+			fprintf(stderr, "  -w          start 30 s before PTS/PCR wrap\n");
+			fprintf(stderr, "  -g RATE     probability of teletext TS packet being dropped (CC gap) (default: 0.0)\n");
+			fprintf(stderr, "  -e RATE     bit error rate of teletext TS packet payload (default: 0.0)\n");
+			fprintf(stderr, "  -m PACKETS  video and audio packets per 40 ms frame (default: 40, about 1.5 Mbps)\n");
+			fprintf(stderr, "  -z SIZE     TS packet size: 188, 192 (M2TS) or 204 (default: 188)\n");
+			fprintf(stderr, "  -r SEED     random seed (default: 1)\n");
+			exit(strcmp(argv[i], "-h") == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+		}
+	}
+	if ((config.pids_count < 1) || (config.pids_count > MAX_PIDS) || ((config.packet_size != 188) && (config.packet_size != 192) && (config.packet_size != 204))
+		|| (config.transmissions < 1) || (config.transmissions > 15)) {
+		fprintf(stderr, "- Invalid number of PIDs, packet size or number of transmissions\n");
+		exit(EXIT_FAILURE);
+	}
+
+	random_state = config.seed * 0x9e3779b97f4a7c15ULL + 1;
+	static char buffer[1 << 20];
+	setvbuf(stdout, buffer, _IOFBF, sizeof(buffer));
+
+	// PCR runs 100 ms behind PTS
+	uint64_t pts = (config.wrap == 1) ? (1ULL << 33) - 30 * 90000 : 10 * 90000;
+	uint64_t frames = (config.size > 0) ? UINT64_MAX : (uint64_t)config.seconds * 25;
+	uint16_t caption_frames = CAPTION_FRAMES + PAUSE_FRAMES;
+	// random state of caption being shown, retransmissions repeat it
+	static uint64_t caption_states[MAX_PIDS][MAX_PAGES];
+
+	for (uint64_t f = 0; f < frames; f++) {
+		if ((config.size > 0) && (written >= config.size)) break;
+		uint64_t t = pts & ((1ULL << 33) - 1);
+		uint64_t pcr = (pts - 9000) & ((1ULL << 33) - 1);
+		arrival_clock = pcr * 300;
+
+		if (f % 10 == 0) {
+			put_pat();
+			put_pmt();
+		}
+		put_filler(PID_VIDEO, 1, pcr);
+
+		for (uint8_t i = 0; i < config.pids_count; i++) {
+			pes_units_t units;
+			units.count = 0;
+			for (uint8_t j = 0; j < config.pages_count; j++) {
+				// captions of pages and PIDs are shifted against each other
+				uint64_t phase = (f + 7 * j + 3 * i) % caption_frames;
+				if (phase == 0) caption_states[i][j] = random_state;
+				if ((phase < CAPTION_FRAMES) && (phase % (CAPTION_FRAMES / config.transmissions) == 0) && (phase / (CAPTION_FRAMES / config.transmissions) < config.transmissions)) {
+					uint64_t state = random_state;
+					random_state = caption_states[i][j];
+					add_header(&units, config.pages[j]);
+					if (config.designation != 255) add_designation(&units, config.pages[j]);
+					add_caption(&units, config.pages[j]);
+					if (phase > 0) random_state = state;
+				}
+				else if (phase == CAPTION_FRAMES) add_header(&units, config.pages[j]);
+			}
+			put_pes(PID_TELETEXT + i, &units, t);
+		}
+
+		for (uint16_t k = 1; k < config.filler; k++) {
+			arrival_clock += 27000000 / 25 / config.filler;
+			if (k % 8 == 4) put_filler(PID_AUDIO, (k == 4), UINT64_MAX);
+			else put_filler(PID_VIDEO, 0, UINT64_MAX);
+		}
+
+		pts += FRAME;
+	}
+
+	fflush(stdout);
+	fprintf(stderr, "- Done (%"PRIu64" TS packets, %"PRIu64" bytes written)\n", packets_written, written);
+	return EXIT_SUCCESS;
+}
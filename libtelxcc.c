@@ -0,0 +1,2679 @@
+/*!
+(c) 2011-2012 Petr Kutalek, Forers, s. r. o.: telxcc
+
+Some portions/inspirations:
+	(c) 2007 Vincent Penne, telx.c : Minimalistic Teletext subtitles decoder
+	(c) 2001-2005 by dvb.matt, ProjectX java dvb decoder
+	(c) Dave Chapman <dave@dchapman.com> 2003-2004, dvbtextsubs
+	(c) Ralph Metzler, DVB driver, vbidecode
+	(c) Jan Pantelje, submux-dvd
+	(c) Ragnar Sundblad, dvbtextsubs, VDR teletext subtitles plugin
+	(c) Scott T. Smith, dvdauthor
+	(c) 2007 Vladimir Voroshilov <voroshil@gmail.com>, mplayer
+	(c) 2001, 2002, 2003, 2004, 2007 Michael H. Schimek, libzvbi -- Error correction functions
+
+Code contribution, bug fixes etc.:
+	Laurent Debacker (https://github.com/debackerl)
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+
+telxcc conforms to ETSI 300 706 Presentation Level 1.5:
+	Presentation Level 1 defines the basic Teletext page, characterised by the use of spacing attributes only
+	and a limited alphanumeric and mosaics repertoire. Presentation Level 1.5 decoder responds as Level 1 but
+	the character repertoire is extended via packets X/26.
+
+Algorithm workflow:
+	telxcc_push (processing TS)
+	process_pes_packet (processing PS)
+	process_telx_packet (processing teletext stream)
+	process_page (processing teletext data)
+
+All decoder state lives in telxcc_decoder_t; tables are read-only, so any number of decoders
+may run in parallel threads.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+#include <inttypes.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <immintrin.h>
+#define PREFILTER_AVX2
+#define ROW_SSSE3
+#endif
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define PREFILTER_NEON
+#define ROW_NEON
+#endif
+
+#include "telxcc.h"
+#include "tables_hamming.h"
+#include "tables_teletext.h"
+
+// size of a TS packet in bytes
+#define TS_PACKET_SIZE TELXCC_TS_PACKET_SIZE
+
+// PES packet buffer sizes: buffers come from decoder's pool in classes of PES_BUFFER_SIZE << class bytes,
+// PES_POOL_DEPTH buffers of each class are kept for reuse; largest PES is 6 B header + 65535 B
+#define PES_BUFFER_SIZE 4096
+#define PES_POOL_CLASSES 6
+#define PES_POOL_DEPTH 4
+#define PES_MAX_SIZE (6 + 65535)
+
+// PES payload ranges referenced in place at most
+#define PES_SEGMENTS 32
+
+#define MAX_PAGES TELXCC_MAX_PAGES
+#define MAX_STREAMS TELXCC_MAX_STREAMS
+
+// TS packet sizes recognised: plain TS, M2TS (4-byte timecode before each packet),
+// TS with 16 bytes of Reed-Solomon parity after each packet
+static const uint16_t PACKET_SIZES[3] = { 188, 192, 204 };
+#define MAX_PACKET_SIZE 204
+
+// number of sync bytes at packet size distance needed to lock on packet stream
+#define SYNC_LOCK_PACKETS 5
+
+// data being searched for sync bytes; holds at least one whole lock window
+#define SYNC_BUFFER_SIZE (2 * SYNC_LOCK_PACKETS * MAX_PACKET_SIZE)
+
+// max. number of TS packets pre-filtered at once; smaller blocks are parsed packet by packet (min. is low enough
+// for UDP datagrams of 7 TS packets to be pre-filtered)
+#define PREFILTER_PACKETS 256
+#define PREFILTER_MIN_PACKETS 7
+
+// pid_filter values: PID is not parsed at all, only its PES starts are parsed (PID may turn out to be teletext),
+// PID is a teletext stream
+#define PID_SKIP 0
+#define PID_PES_START 1
+#define PID_STREAM 2
+
+// PSI section buffer size; PAT and PMT sections are at most 1024 bytes long (ISO/IEC 13818-1, chapter 2.4.4)
+#define PSI_SECTION_SIZE 1024
+
+// selects indices of count packets (at stride distance) which need full parsing
+typedef size_t (*prefilter_t)(const uint8_t *data, size_t count, uint16_t stride, const uint8_t *pid_filter, uint16_t *selected);
+
+// decoded X/26 triplet, ETS 300 706, chapter 12.3.1; uncorrectable triplet has all other fields 0
+typedef struct {
+	uint8_t address;
+	uint8_t mode;
+	uint8_t data;
+	uint8_t error;
+} x26_triplet_t;
+
+// teletext row kernels
+typedef struct {
+	const char *name;
+	// bit reversal of 44-byte data unit payload in place, ETS 300 706, chapter 7.1
+	void (*reverse_44)(uint8_t *data);
+	// 7-bit characters of 40 odd parity bytes; bytes failing parity check turn into 0x80
+	void (*parity_40)(const uint8_t *data, uint8_t *chars);
+	// unham_8_4() of 16 bytes
+	void (*unham_16)(const uint8_t *data, uint8_t *nibbles);
+	// unham_24_18() of 13 triplets in X/26 packet data bytes 1 -- 39
+	void (*unham_x26)(const uint8_t *data, x26_triplet_t *triplets);
+} row_kernels_t;
+
+typedef struct {
+	uint8_t _clock_run_in; // not needed
+	uint8_t _framing_code; // not needed, ETSI 300 706: const 0xe4
+	uint8_t address[2];
+	uint8_t data[40];
+} teletext_packet_payload_t;
+
+typedef struct {
+	uint64_t show_timestamp; // show at timestamp (in ms)
+	uint64_t hide_timestamp; // hide at timestamp (in ms)
+	uint64_t show_position; // input position of PES carrying page header
+	uint32_t header_pcr; // TS PCR (in ms) at page header
+	uint16_t text[25][40]; // 25 lines x 40 cols (1 screen/page) of wide chars
+	uint8_t tainted; // 1 = text variable contains any data
+} teletext_page_t;
+
+// rendered page text
+typedef struct {
+	char *data;
+	size_t size;
+	size_t capacity;
+} text_buffer_t;
+
+typedef struct {
+	uint16_t page; // page number (BCD)
+	teletext_page_t page_buffer;
+	uint8_t header_received; // 1 = page_buffer is being received or waits for next page header
+	uint8_t charset; // G0 Latin National Subset ID (page header bits C12 -- C14)
+	uint8_t x28_primary; // designations in X/28/0 Format 1 or X/28/4 of page being received; 255 = none
+	uint8_t x28_secondary;
+	const uint16_t *g0; // G0 set selected for page (one of immutable tables)
+	const uint16_t *g0_secondary; // second G0 set, ESC switches to it and back; NULL = none
+	const uint16_t *g0_logged; // designated sets last reported
+	const uint16_t *g0_secondary_logged;
+	uint32_t update_pcr; // TS PCR (in ms) at last row received
+	uint8_t live_emitted; // live mode: 1 = page_buffer rendered since its last change
+	uint8_t live_shown; // live mode: 1 = caption emitted and not cleared yet
+	// config.merge_repeats: caption rendered last waits here for its retransmissions; held_hash is of held_text
+	teletext_page_t held;
+	text_buffer_t held_text;
+	uint64_t held_hash;
+	uint8_t held_pending; // 1 = held caption not emitted yet
+} teletext_page_state_t;
+
+// range of PES packet bytes
+typedef struct {
+	const uint8_t *data;
+	uint32_t size;
+} pes_segment_t;
+
+// teletext stream (one PID), each with its own demultiplexer, timing and page states
+typedef struct {
+	uint16_t pid;
+
+	// 255 means not set yet
+	uint8_t continuity_counter;
+
+	// PES packet being assembled: TS payloads within data being pushed are referenced in place, others (and all
+	// of them at the end of telxcc_push()) are gathered into pes_buffer, which is then pes_segments[0]
+	uint8_t pes_assembling;
+	pes_segment_t pes_segments[PES_SEGMENTS];
+	uint8_t pes_segments_count;
+	uint32_t pes_size;
+	uint8_t *pes_buffer;
+	uint8_t pes_buffer_class;
+	uint64_t pes_position; // input position of PES being assembled
+
+	// timestamp base; 255 means not set yet
+	uint8_t using_pts;
+	int64_t delta;
+	uint32_t t0;
+	uint8_t initialized;
+
+	// timestamp base at first PES and at first PES starting at config.end_position
+	uint32_t first_t;
+	int64_t first_delta;
+	int64_t end_delta;
+	uint32_t end_t0;
+	uint8_t end_initialized;
+	uint8_t end_reached;
+
+	// subtitle type pages bitmap
+	uint8_t cc_map[256];
+
+	transmission_mode_t transmission_mode;
+	uint8_t programme_title_processed;
+
+	// pages being extracted
+	teletext_page_state_t page_states[MAX_PAGES];
+	uint8_t page_states_count;
+
+	// page being received in each magazine
+	teletext_page_state_t *receiving_page[8];
+
+	// designations in M/29/0 or M/29/4 of each magazine; 255 = none
+	uint8_t m29_primary[8];
+	uint8_t m29_secondary[8];
+
+	// counters in decoder stats
+	telxcc_stream_stats_t *stats;
+} ts_stream_t;
+
+// all pages and subpages received (config.page_store)
+typedef struct page_store page_store_t;
+
+// PSI section being assembled from TS packets of one PID
+typedef struct {
+	uint8_t data[PSI_SECTION_SIZE];
+	uint16_t size;
+	uint8_t assembling;
+	// 255 means not set yet
+	uint8_t continuity_counter;
+} psi_section_t;
+
+// PAT and PMTs (config.psi); sections[0] is of PAT, sections[i + 1] of PMT of program i
+typedef struct {
+	telxcc_psi_t info;
+	psi_section_t sections[1 + TELXCC_MAX_PROGRAMS];
+	// index + 1 into sections for each PID, 0 = not a PSI PID
+	uint8_t section_index[8192];
+	uint8_t sections_count;
+	// version_number of PMT received of each program
+	uint8_t pmt_versions[TELXCC_MAX_PROGRAMS];
+} psi_t;
+
+struct telxcc_decoder {
+	telxcc_config_t config;
+	telxcc_callback_t callback;
+	void *user_data;
+
+	// teletext streams; stream_index maps PID to index + 1 into streams (0 = unknown PID)
+	ts_stream_t *streams[MAX_STREAMS];
+	uint8_t streams_count;
+	uint8_t stream_index[8192];
+
+	// PID_* value for each PID, padded for 32-bit gathers; pid_filter_raised = some PID_SKIP or PID_PES_START
+	// turned into PID_STREAM (selection made so far is not valid)
+	uint8_t pid_filter[8192 + 4];
+	uint8_t pid_filter_raised;
+	prefilter_t prefilter;
+
+	const row_kernels_t *kernels;
+
+	// PAT and PMTs, NULL = config.psi not set
+	psi_t *psi;
+
+	// NULL = config.page_store not set
+	page_store_t *store;
+
+	// TS PCR value
+	uint32_t global_timestamp;
+
+	// input position of TS packet being processed
+	uint64_t position;
+
+	// input position of next byte pushed
+	uint64_t input_position;
+
+	// packet size locked on, 0 = searching for sync bytes
+	uint16_t packet_size;
+	uint8_t sync_locked_once;
+
+	// bytes following TS packet (M2TS timecode of next packet, RS parity) still to be skipped
+	uint16_t skip;
+
+	// incomplete TS packet from previous telxcc_push()
+	uint8_t carry[TS_PACKET_SIZE];
+	uint8_t carry_size;
+	uint64_t carry_position;
+
+	// data being searched for sync bytes
+	uint8_t sync_buffer[SYNC_BUFFER_SIZE];
+	uint16_t sync_size;
+
+	// data of telxcc_push() being processed; PES payload in there may be referenced until it returns
+	const uint8_t *push_data;
+	const uint8_t *push_end;
+
+	// PES buffers released, by size class
+	uint8_t *pes_pool[PES_POOL_CLASSES][PES_POOL_DEPTH];
+	uint8_t pes_pool_count[PES_POOL_CLASSES];
+
+	text_buffer_t text;
+
+	telxcc_stats_t stats;
+};
+
+#define STREAM_IGNORED 255
+
+#define VERBOSE if ((decoder->config.verbose > 0) && (decoder->config.log != NULL))
+
+static void log_message(const telxcc_decoder_t *decoder, const char *format, ...) {
+	if (decoder->config.log == NULL) return;
+	va_list args;
+	va_start(args, format);
+	vfprintf(decoder->config.log, format, args);
+	va_end(args);
+}
+
+// stage timing clock (config.timing); stages are timed at PES, page and callback boundaries, never per TS packet
+static inline uint64_t clock_ns(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void emit_event(telxcc_decoder_t *decoder, telxcc_event_t *event) {
+	event->pcr = decoder->global_timestamp;
+	if (event->type == TELXCC_EVENT_CAPTION) decoder->stats.captions++;
+	else if (event->type == TELXCC_EVENT_PAGE) decoder->stats.pages++;
+
+	if (decoder->config.timing == 0) {
+		decoder->callback(decoder->user_data, event);
+		return;
+	}
+	uint64_t start = clock_ns();
+	decoder->callback(decoder->user_data, event);
+	decoder->stats.stage_callback_ns += clock_ns() - start;
+}
+
+// TS PCR time elapsed since t (in ms); PCR wraps as PTS does
+static inline uint32_t pcr_elapsed(const telxcc_decoder_t *decoder, uint32_t t) {
+	if (decoder->global_timestamp >= t) return decoder->global_timestamp - t;
+	return decoder->global_timestamp + 95443718 - t;
+}
+
+// caption held (config.merge_repeats) counts from its own page header, not from the one of page being received
+static void record_latency(telxcc_decoder_t *decoder, const teletext_page_t *page_buffer) {
+	uint32_t latency = pcr_elapsed(decoder, page_buffer->header_pcr);
+	uint8_t bucket = 0;
+	while ((bucket < TELXCC_LATENCY_BUCKETS - 1) && (latency >= (16u << bucket))) bucket++;
+	decoder->stats.latency[bucket]++;
+}
+
+// ETS 300 706, chapter 8.2
+static inline uint8_t unham_8_4(uint8_t a) {
+	return (UNHAM_8_4[a] & 0x0f);
+}
+
+// ETS 300 706, chapter 8.3
+static inline uint32_t unham_24_18(uint32_t a) {
+	uint8_t B0 = a & 0xff;
+	uint8_t B1 = (a >> 8) & 0xff;
+	uint8_t B2 = (a >> 16) & 0xff;
+
+	uint8_t D1_D4 = UNHAM_24_18_D1_D4[B0 >> 2];
+	uint8_t D5_D11 = B1 & 0x7f;
+	uint8_t D12_D18 = B2 & 0x7f;
+
+	uint32_t d = D1_D4 | (D5_D11 << 4) | (D12_D18 << 11);
+	uint8_t ABCDEF = UNHAM_24_18_PAR[0][B0] ^ UNHAM_24_18_PAR[1][B1] ^ UNHAM_24_18_PAR[2][B2];
+	uint32_t r = d ^ UNHAM_24_18_ERR[ABCDEF];
+
+	//fprintf(stderr, "> UNHAM24/18 A=%08x, R=%08x, CHECK=%08x\n", a, r, (((a & 0x04) >> 2) | ((a & 0x70) >> 3) | ((a & 0x7f00) >> 4) | ((a & 0x7f0000) >> 5)));
+	return r;
+}
+
+// UTF-8 byte sequences of UCS-2 chars U+0000 -- U+07FF (covers all Latin, Greek and Cyrillic teletext glyphs);
+// bytes are stored in the lower 3 bytes (in memory order on Little Endian), sequence length in the upper byte
+#define UTF8_1(c) (((c) < 0x80) ? (0x01000000 | (c)) : (0x02000000 | (((((c) & 0x3f) | 0x80)) << 8) | (((c) >> 6) | 0xc0)))
+#define UTF8_4(c) UTF8_1(c), UTF8_1((c) + 1), UTF8_1((c) + 2), UTF8_1((c) + 3)
+#define UTF8_16(c) UTF8_4(c), UTF8_4((c) + 4), UTF8_4((c) + 8), UTF8_4((c) + 12)
+#define UTF8_64(c) UTF8_16(c), UTF8_16((c) + 16), UTF8_16((c) + 32), UTF8_16((c) + 48)
+#define UTF8_256(c) UTF8_64(c), UTF8_64((c) + 64), UTF8_64((c) + 128), UTF8_64((c) + 192)
+static const uint32_t UTF8[0x800] = {
+	UTF8_256(0x000), UTF8_256(0x100), UTF8_256(0x200), UTF8_256(0x300),
+	UTF8_256(0x400), UTF8_256(0x500), UTF8_256(0x600), UTF8_256(0x700)
+};
+
+// returns 0 if out of memory
+static int text_reserve(text_buffer_t *text, size_t size) {
+	if (text->size + size <= text->capacity) return 1;
+	size_t capacity = (text->capacity > 0) ? text->capacity : 4096;
+	while (capacity < text->size + size) capacity *= 2;
+	char *data = realloc(text->data, capacity);
+	if (data == NULL) return 0;
+	text->data = data;
+	text->capacity = capacity;
+	return 1;
+}
+
+static inline void text_append(text_buffer_t *text, const char *s, size_t size) {
+	if (text_reserve(text, size) == 0) return;
+	memcpy(text->data + text->size, s, size);
+	text->size += size;
+}
+
+#define text_append_literal(text, s) text_append((text), (s), sizeof(s) - 1)
+
+static inline void text_append_utf8(text_buffer_t *text, uint16_t ch) {
+	if (text_reserve(text, 4) == 0) return;
+	if (ch < 0x800) {
+		// always copy 4 bytes, only valid ones are accounted
+		uint32_t u = UTF8[ch];
+		memcpy(text->data + text->size, &u, 4);
+		text->size += u >> 24;
+	}
+	else {
+		text->data[text->size++] = (ch >> 12) | 0xe0;
+		text->data[text->size++] = ((ch >> 6) & 0x3f) | 0x80;
+		text->data[text->size++] = (ch & 0x3f) | 0x80;
+	}
+}
+
+// check parity and translate any reasonable teletext character into ucs2
+static inline uint16_t telx_to_ucs2(const uint16_t *g0, uint8_t c) {
+	if (PARITY_8[c] == 0) return 32;
+
+	uint16_t r = c & 0x7f;
+	if (r >= 32) r = g0[r - 32];
+	return r;
+}
+
+// character of parity_40() output into ucs2
+static inline uint16_t char_to_ucs2(const uint16_t *g0, uint8_t c) {
+	if (c >= 0x80) return 32;
+	return (c >= 32) ? g0[c - 32] : c;
+}
+
+static void reverse_44_scalar(uint8_t *data) {
+	for (uint8_t i = 0; i < 44; i++) data[i] = REVERSE_8[data[i]];
+}
+
+static void parity_40_scalar(const uint8_t *data, uint8_t *chars) {
+	for (uint8_t i = 0; i < 40; i++) chars[i] = (PARITY_8[data[i]] > 0) ? (data[i] & 0x7f) : 0x80;
+}
+
+static void unham_16_scalar(const uint8_t *data, uint8_t *nibbles) {
+	for (uint8_t i = 0; i < 16; i++) nibbles[i] = unham_8_4(data[i]);
+}
+
+// same as unham_24_18(), but with 4 lookups (UNHAM_24_18_DATA_PAR) instead of 6 per triplet
+static void unham_x26_scalar(const uint8_t *data, x26_triplet_t *triplets) {
+	for (uint8_t j = 0; j < 13; j++) {
+		const uint8_t *b = data + 1 + 3 * j;
+		uint32_t v = UNHAM_24_18_DATA_PAR[0][b[0]] ^ UNHAM_24_18_DATA_PAR[1][b[1]] ^ UNHAM_24_18_DATA_PAR[2][b[2]];
+		uint32_t r = (v & 0x3ffff) ^ UNHAM_24_18_ERR[v >> 24];
+		x26_triplet_t t = { 0, 0, 0, 1 };
+		if ((r & 0x80000000) == 0) {
+			t.address = r & 0x3f;
+			t.mode = (r & 0x7c0) >> 6;
+			t.data = (r & 0x3f800) >> 11;
+			t.error = 0;
+		}
+		triplets[j] = t;
+	}
+}
+
+static const row_kernels_t ROW_KERNELS_SCALAR = { "scalar", reverse_44_scalar, parity_40_scalar, unham_16_scalar, unham_x26_scalar };
+
+// Vector kernels look up low and high nibble of each byte in 16-entry tables (byte shuffles). Hamming 8/4 is linear:
+// data bits D1 -- D4 (bits 1, 3, 5, 7) and syndrome (parity checks A, B, C and D of ETS 300 706, chapter 8.2) of a byte
+// are combinations of values of its nibbles; syndrome then selects correction of data bits or uncorrectable error.
+static const uint8_t NIBBLE_REVERSE[16] = { 0x00, 0x08, 0x04, 0x0c, 0x02, 0x0a, 0x06, 0x0e, 0x01, 0x09, 0x05, 0x0d, 0x03, 0x0b, 0x07, 0x0f };
+static const uint8_t NIBBLE_PARITY[16] = { 0x00, 0x01, 0x01, 0x00, 0x01, 0x00, 0x00, 0x01, 0x01, 0x00, 0x00, 0x01, 0x00, 0x01, 0x01, 0x00 };
+static const uint8_t NIBBLE_HAM_DATA[2][16] = {
+	{ 0x00, 0x00, 0x01, 0x01, 0x00, 0x00, 0x01, 0x01, 0x02, 0x02, 0x03, 0x03, 0x02, 0x02, 0x03, 0x03 },
+	{ 0x00, 0x00, 0x04, 0x04, 0x00, 0x00, 0x04, 0x04, 0x08, 0x08, 0x0c, 0x0c, 0x08, 0x08, 0x0c, 0x0c }
+};
+static const uint8_t NIBBLE_HAM_SYNDROME[2][16] = {
+	{ 0x00, 0x09, 0x0f, 0x06, 0x0a, 0x03, 0x05, 0x0c, 0x0e, 0x07, 0x01, 0x08, 0x04, 0x0d, 0x0b, 0x02 },
+	{ 0x00, 0x0c, 0x0d, 0x01, 0x08, 0x04, 0x05, 0x09, 0x0b, 0x07, 0x06, 0x0a, 0x03, 0x0f, 0x0e, 0x02 }
+};
+// syndrome 0x0f = no error, 0x00 -- 0x07 = single error, 0x08 -- 0x0e = double error (0x0f as unham_8_4() returns)
+static const uint8_t HAM_CORRECTION[16] = { 0x01, 0x02, 0x04, 0x00, 0x08, 0x00, 0x00, 0x00, 0x0f, 0x0f, 0x0f, 0x0f, 0x0f, 0x0f, 0x0f, 0x00 };
+static const uint8_t HAM_ERROR[16] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0f, 0x0f, 0x0f, 0x0f, 0x0f, 0x0f, 0x0f, 0x00 };
+
+#if defined(ROW_SSSE3)
+#define SSSE3 __attribute__((target("ssse3")))
+
+SSSE3 static inline __m128i lookup_ssse3(const uint8_t *table, __m128i nibbles) {
+	return _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)table), nibbles);
+}
+
+SSSE3 static inline __m128i reverse_ssse3(__m128i v) {
+	const __m128i low = _mm_set1_epi8(0x0f);
+	__m128i lo = _mm_and_si128(v, low);
+	__m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), low);
+	return _mm_or_si128(_mm_slli_epi16(lookup_ssse3(NIBBLE_REVERSE, lo), 4), lookup_ssse3(NIBBLE_REVERSE, hi));
+}
+
+SSSE3 static inline __m128i parity_ssse3(__m128i v) {
+	const __m128i low = _mm_set1_epi8(0x0f);
+	__m128i lo = _mm_and_si128(v, low);
+	__m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), low);
+	__m128i even = _mm_cmpeq_epi8(_mm_xor_si128(lookup_ssse3(NIBBLE_PARITY, lo), lookup_ssse3(NIBBLE_PARITY, hi)), _mm_setzero_si128());
+	return _mm_or_si128(_mm_andnot_si128(even, _mm_and_si128(v, _mm_set1_epi8(0x7f))), _mm_and_si128(even, _mm_set1_epi8((char)0x80)));
+}
+
+// last vector overlaps previous one, all loads precede stores
+SSSE3 static void reverse_44_ssse3(uint8_t *data) {
+	__m128i a = _mm_loadu_si128((const __m128i *)data);
+	__m128i b = _mm_loadu_si128((const __m128i *)(data + 16));
+	__m128i c = _mm_loadu_si128((const __m128i *)(data + 28));
+	_mm_storeu_si128((__m128i *)data, reverse_ssse3(a));
+	_mm_storeu_si128((__m128i *)(data + 16), reverse_ssse3(b));
+	_mm_storeu_si128((__m128i *)(data + 28), reverse_ssse3(c));
+}
+
+SSSE3 static void parity_40_ssse3(const uint8_t *data, uint8_t *chars) {
+	_mm_storeu_si128((__m128i *)chars, parity_ssse3(_mm_loadu_si128((const __m128i *)data)));
+	_mm_storeu_si128((__m128i *)(chars + 16), parity_ssse3(_mm_loadu_si128((const __m128i *)(data + 16))));
+	_mm_storeu_si128((__m128i *)(chars + 24), parity_ssse3(_mm_loadu_si128((const __m128i *)(data + 24))));
+}
+
+SSSE3 static void unham_16_ssse3(const uint8_t *data, uint8_t *nibbles) {
+	const __m128i low = _mm_set1_epi8(0x0f);
+	__m128i v = _mm_loadu_si128((const __m128i *)data);
+	__m128i lo = _mm_and_si128(v, low);
+	__m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), low);
+	__m128i d = _mm_or_si128(lookup_ssse3(NIBBLE_HAM_DATA[0], lo), lookup_ssse3(NIBBLE_HAM_DATA[1], hi));
+	__m128i syndrome = _mm_xor_si128(lookup_ssse3(NIBBLE_HAM_SYNDROME[0], lo), lookup_ssse3(NIBBLE_HAM_SYNDROME[1], hi));
+	d = _mm_or_si128(_mm_xor_si128(d, lookup_ssse3(HAM_CORRECTION, syndrome)), lookup_ssse3(HAM_ERROR, syndrome));
+	_mm_storeu_si128((__m128i *)nibbles, d);
+}
+
+static const row_kernels_t ROW_KERNELS_SSSE3 = { "SSSE3", reverse_44_ssse3, parity_40_ssse3, unham_16_ssse3, unham_x26_scalar };
+#undef SSSE3
+#endif
+
+#if defined(ROW_NEON)
+static inline uint8x16_t parity_neon(uint8x16_t v) {
+	uint8x16_t odd = veorq_u8(vqtbl1q_u8(vld1q_u8(NIBBLE_PARITY), vandq_u8(v, vdupq_n_u8(0x0f))), vqtbl1q_u8(vld1q_u8(NIBBLE_PARITY), vshrq_n_u8(v, 4)));
+	return vbslq_u8(vceqzq_u8(odd), vdupq_n_u8(0x80), vandq_u8(v, vdupq_n_u8(0x7f)));
+}
+
+// NEON reverses bits natively
+static void reverse_44_neon(uint8_t *data) {
+	uint8x16_t a = vld1q_u8(data);
+	uint8x16_t b = vld1q_u8(data + 16);
+	uint8x16_t c = vld1q_u8(data + 28);
+	vst1q_u8(data, vrbitq_u8(a));
+	vst1q_u8(data + 16, vrbitq_u8(b));
+	vst1q_u8(data + 28, vrbitq_u8(c));
+}
+
+static void parity_40_neon(const uint8_t *data, uint8_t *chars) {
+	vst1q_u8(chars, parity_neon(vld1q_u8(data)));
+	vst1q_u8(chars + 16, parity_neon(vld1q_u8(data + 16)));
+	vst1q_u8(chars + 24, parity_neon(vld1q_u8(data + 24)));
+}
+
+static void unham_16_neon(const uint8_t *data, uint8_t *nibbles) {
+	uint8x16_t v = vld1q_u8(data);
+	uint8x16_t lo = vandq_u8(v, vdupq_n_u8(0x0f));
+	uint8x16_t hi = vshrq_n_u8(v, 4);
+	uint8x16_t d = vorrq_u8(vqtbl1q_u8(vld1q_u8(NIBBLE_HAM_DATA[0]), lo), vqtbl1q_u8(vld1q_u8(NIBBLE_HAM_DATA[1]), hi));
+	uint8x16_t syndrome = veorq_u8(vqtbl1q_u8(vld1q_u8(NIBBLE_HAM_SYNDROME[0]), lo), vqtbl1q_u8(vld1q_u8(NIBBLE_HAM_SYNDROME[1]), hi));
+	d = vorrq_u8(veorq_u8(d, vqtbl1q_u8(vld1q_u8(HAM_CORRECTION), syndrome)), vqtbl1q_u8(vld1q_u8(HAM_ERROR), syndrome));
+	vst1q_u8(nibbles, d);
+}
+
+static const row_kernels_t ROW_KERNELS_NEON = { "NEON", reverse_44_neon, parity_40_neon, unham_16_neon, unham_x26_scalar };
+#endif
+
+// the fastest row kernels running CPU supports
+static const row_kernels_t *select_row_kernels(void) {
+#if defined(ROW_SSSE3)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("ssse3")) return &ROW_KERNELS_SSSE3;
+#elif defined(ROW_NEON)
+	return &ROW_KERNELS_NEON;
+#endif
+	return &ROW_KERNELS_SCALAR;
+}
+
+// renders boxed area of page into decoder text; returns 0 if page is empty
+static uint8_t render_text(telxcc_decoder_t *decoder, const teletext_page_t *page_buffer) {
+	text_buffer_t *text = &decoder->text;
+
+#ifdef DEBUG
+	for (uint8_t row = 1; row < 25; row++) {
+		fprintf(stdout, "DEBUG[%02u]: ", row);
+		for (uint8_t col = 0; col < 40; col++) fprintf(stdout, "%3x ", page_buffer->text[row][col]);
+		fprintf(stdout, "\n");
+	}
+	fprintf(stdout, "\n");
+	fflush(stdout);
+#endif
+
+	// optimalization: slicing column by column -- higher probability we could find boxed area start mark sooner
+	uint8_t page_is_empty = 1;
+	for (uint8_t col = 0; col < 40; col++)
+		for (uint8_t row = 1; row < 25; row++)
+			if (page_buffer->text[row][col] == 0x0b) {
+				page_is_empty = 0;
+				goto page_is_empty;
+			}
+	page_is_empty:
+	if (page_is_empty == 1) return 0;
+
+	text->size = 0;
+
+	// process data
+	for (uint8_t row = 1; row < 25; row++) {
+		uint8_t font_tag_opened = 0;
+		uint8_t in_boxed_area = 0;
+		// ETS 300 706, chapter 12.2: Alpha White ("Set-After") - Start-of-row default condition.
+		uint8_t foreground_color = 0x7;
+
+		// skip empty lines
+		uint8_t line_is_empty = 1;
+		for (uint8_t col = 0; col < 40; col++)
+			if (page_buffer->text[row][col] == 0x0b) {
+				line_is_empty = 0;
+				goto line_is_empty;
+			}
+		line_is_empty:
+		if (line_is_empty == 1) continue;
+
+		for (uint8_t col = 0; col < 40; col++) {
+			uint16_t v = page_buffer->text[row][col];
+
+			// last column -- close font tag
+			if (col == 39) {
+				if ((decoder->config.colours == 1) && (font_tag_opened == 1)) {
+					text_append_literal(text, "</font> ");
+					font_tag_opened = 0;
+				}
+				in_boxed_area = 0;
+				continue;
+			}
+
+			// colours
+			// white is default as stated in ETS 300 706, chapter 12.2
+			// black is considered as white for telxcc purpose
+			// telxcc writes <font/> tags only when needed
+			// black(0), red, green, yellow, blue, magenta, cyan, white
+			if ((v >= 0x01) && (v <= 0x07)) {
+				if (decoder->config.colours == 1) {
+					if (font_tag_opened == 1) {
+						text_append_literal(text, "</font> ");
+						font_tag_opened = 0;
+					}
+					if (v != foreground_color) {
+						text_append_literal(text, "<font color=\"");
+						text_append(text, COLOURS[v], 7);
+						text_append_literal(text, "\">");
+						font_tag_opened = 1;
+						foreground_color = v;
+					}
+				}
+				// ETS 300 706, chapter 12.2: Unless operating in "Hold Mosaics" mode,
+				// each character space occupied by a spacing attribute is displayed as a SPACE.
+				else v = 32;
+			}
+
+			// boxed area start
+			if (v == 0x0b) {
+				in_boxed_area = 1;
+				continue;
+			}
+
+			// boxed area end
+			if (v == 0x0a) {
+				in_boxed_area = 0;
+				col = 38;
+				continue;
+			}
+
+			// discard nonprintable chars
+			if (v < 32) continue;
+
+			// processing chars in boxed area
+			if (in_boxed_area == 1) text_append_utf8(text, v);
+		}
+		text_append_literal(text, "\n");
+	}
+
+	// zero-terminated
+	text_append(text, "", 1);
+	text->size--;
+	return 1;
+}
+
+static void emit_caption(telxcc_decoder_t *decoder, ts_stream_t *stream, teletext_page_state_t *state, const teletext_page_t *page_buffer, const text_buffer_t *text) {
+	telxcc_event_t event = {
+		.type = TELXCC_EVENT_CAPTION,
+		.pid = stream->pid,
+		.page = state->page,
+		.show_timestamp = page_buffer->show_timestamp,
+		.hide_timestamp = page_buffer->hide_timestamp,
+		.position = page_buffer->show_position,
+		.text = (const uint16_t (*)[40])page_buffer->text,
+		.utf8 = text->data,
+		.utf8_size = text->size
+	};
+	record_latency(decoder, page_buffer);
+	emit_event(decoder, &event);
+}
+
+// FNV-1a
+static uint64_t text_hash(const text_buffer_t *text) {
+	uint64_t hash = 0xcbf29ce484222325;
+	for (size_t i = 0; i < text->size; i++) hash = (hash ^ (uint8_t)text->data[i]) * 0x100000001b3;
+	return hash;
+}
+
+static void emit_held(telxcc_decoder_t *decoder, ts_stream_t *stream, teletext_page_state_t *state) {
+	if (state->held_pending == 0) return;
+	state->held_pending = 0;
+	emit_caption(decoder, stream, state, &state->held, &state->held_text);
+}
+
+// config.merge_repeats: caption rendered into decoder text is held until page is transmitted with other content;
+// retransmission of the same caption right after it (broadcasters resend pages 2 -- 3 times) just extends
+// its hide time. Caption is not merged across config.end_position (split mode stitching merges those).
+static void hold_caption(telxcc_decoder_t *decoder, ts_stream_t *stream, teletext_page_state_t *state) {
+	const teletext_page_t *page_buffer = &state->page_buffer;
+	uint64_t hash = text_hash(&decoder->text);
+	uint64_t end = decoder->config.end_position;
+
+	if ((state->held_pending == 1) && (state->held_hash == hash) && (state->held_text.size == decoder->text.size)
+		&& (memcmp(state->held_text.data, decoder->text.data, decoder->text.size) == 0)
+		// retransmission follows right after (hide time is 40 ms before next page header)
+		&& (state->held.hide_timestamp + 40 == page_buffer->show_timestamp)
+		&& ((end == 0) || ((state->held.show_position < end) == (page_buffer->show_position < end)))) {
+		state->held.hide_timestamp = page_buffer->hide_timestamp;
+		decoder->stats.repeats++;
+		return;
+	}
+
+	emit_held(decoder, stream, state);
+	state->held = *page_buffer;
+	state->held_hash = hash;
+	state->held_pending = 1;
+	// buffers are swapped, text is not copied
+	text_buffer_t text = state->held_text;
+	state->held_text = decoder->text;
+	decoder->text = text;
+}
+
+// returns 1 if caption was emitted or held (page is not empty)
+static uint8_t render_page(telxcc_decoder_t *decoder, ts_stream_t *stream, teletext_page_state_t *state) {
+	uint8_t merge = (decoder->config.merge_repeats == 1) && (decoder->config.live == 0);
+	if (render_text(decoder, &state->page_buffer) == 0) {
+		if (merge == 1) emit_held(decoder, stream, state);
+		return 0;
+	}
+
+	if (merge == 1) hold_caption(decoder, stream, state);
+	else emit_caption(decoder, stream, state, &state->page_buffer, &decoder->text);
+	return 1;
+}
+
+// render time excludes callback; returns 1 if caption was emitted
+static uint8_t process_page(telxcc_decoder_t *decoder, ts_stream_t *stream, teletext_page_state_t *state) {
+	if (decoder->config.timing == 0) return render_page(decoder, stream, state);
+	uint64_t start = clock_ns();
+	uint64_t callback_ns = decoder->stats.stage_callback_ns;
+	uint8_t r = render_page(decoder, stream, state);
+	decoder->stats.stage_render_ns += clock_ns() - start - (decoder->stats.stage_callback_ns - callback_ns);
+	return r;
+}
+
+// live mode: emits page rows received so far, unless emitted already
+static void live_process_page(telxcc_decoder_t *decoder, ts_stream_t *stream, teletext_page_state_t *state) {
+	if ((state->page_buffer.tainted == 0) || (state->live_emitted == 1)) return;
+	state->live_emitted = 1;
+	state->page_buffer.hide_timestamp = 0;
+	if (process_page(decoder, stream, state) == 1) state->live_shown = 1;
+}
+
+// live mode: caption shown is hidden at timestamp
+static void live_clear_page(telxcc_decoder_t *decoder, ts_stream_t *stream, teletext_page_state_t *state, uint64_t timestamp) {
+	if (state->live_shown == 0) return;
+	state->live_shown = 0;
+
+	telxcc_event_t event = {
+		.type = TELXCC_EVENT_CLEAR,
+		.pid = stream->pid,
+		.page = state->page,
+		.show_timestamp = state->page_buffer.show_timestamp,
+		.hide_timestamp = timestamp,
+		.position = stream->pes_position,
+		.text = (const uint16_t (*)[40])state->page_buffer.text,
+		.utf8 = "",
+		.utf8_size = 0
+	};
+	emit_event(decoder, &event);
+}
+
+// live mode: emits pages whose rows have not changed for live_timeout ms of PCR time
+static void live_check_timeouts(telxcc_decoder_t *decoder) {
+	uint32_t timeout = (decoder->config.live_timeout > 0) ? decoder->config.live_timeout : TELXCC_LIVE_TIMEOUT;
+	for (uint8_t k = 0; k < decoder->streams_count; k++) {
+		ts_stream_t *stream = decoder->streams[k];
+		for (uint8_t i = 0; i < stream->page_states_count; i++) {
+			teletext_page_state_t *state = &stream->page_states[i];
+			if ((state->page_buffer.tainted > 0) && (state->live_emitted == 0) && (pcr_elapsed(decoder, state->update_pcr) >= timeout))
+				live_process_page(decoder, stream, state);
+		}
+	}
+}
+
+static inline uint8_t magazine(uint16_t page) {
+	return ((page >> 8) & 0xf);
+}
+
+// ETS 300 706, chapter 15.2, table 32: G0 set of default G0 and G2 character set designation and national option
+// selection code; code not defined selects Latin national option sub-set of its national option bits
+static const uint16_t *g0_set(uint8_t code, const char **name) {
+	for (uint8_t i = 0; i < sizeof(LANGUAGES) / sizeof(LANGUAGES[0]); i++) {
+		if (LANGUAGES[i].id != code) continue;
+		*name = LANGUAGES[i].name;
+		if (LANGUAGES[i].charset == LATIN) return G0_LATIN_NATIONAL[LANGUAGES[i].subset];
+		if (LANGUAGES[i].charset == HEBREW) return G0_HEBREW;
+		// Arabic G0 set is not available
+		if (LANGUAGES[i].charset == ARABIC) return G0_LATIN_NATIONAL[G0_LATIN_ENGLISH];
+		return G0[LANGUAGES[i].charset];
+	}
+	*name = "unknown";
+	return G0_LATIN_NATIONAL[code & 0x07];
+}
+
+// selects G0 sets of page by pointer: designation of page (X/28) or of its magazine (M/29) in combination
+// with national option of page header
+static void select_g0_sets(telxcc_decoder_t *decoder, ts_stream_t *stream, teletext_page_state_t *state) {
+	uint8_t m = magazine(state->page);
+	uint8_t primary = (state->x28_primary != 255) ? state->x28_primary : stream->m29_primary[m - 1];
+	uint8_t secondary = (state->x28_primary != 255) ? state->x28_secondary : stream->m29_secondary[m - 1];
+
+	const char *name = NULL;
+	const char *secondary_name = NULL;
+	const uint16_t *g0 = g0_set(((primary != 255) ? (primary & 0x78) : 0) | state->charset, &name);
+	const uint16_t *g0_secondary = (secondary != 255) ? g0_set(secondary, &secondary_name) : NULL;
+	if (g0_secondary == g0) g0_secondary = NULL;
+
+	if ((primary != 255) && ((g0 != state->g0_logged) || (g0_secondary != state->g0_secondary_logged))) {
+		VERBOSE {
+			if (g0_secondary == NULL) log_message(decoder, "- G0 Charset of page %03x designated: %s\n", state->page, name);
+			else log_message(decoder, "- G0 Charset of page %03x designated: %s, second G0 Charset: %s\n", state->page, name, secondary_name);
+		}
+		state->g0_logged = g0;
+		state->g0_secondary_logged = g0_secondary;
+	}
+	state->g0 = g0;
+	state->g0_secondary = g0_secondary;
+}
+
+// ETS 300 706, chapters 9.4.2 and 9.5.1: default G0 designation code and second G0 designation code
+// of X/28/0 Format 1, X/28/4, M/29/0 and M/29/4; returns 0 if packet is not of this kind
+static uint8_t decode_g0_designations(telxcc_decoder_t *decoder, const teletext_packet_payload_t *packet, uint8_t designation_code, uint8_t *primary, uint8_t *secondary) {
+	if ((designation_code != 0) && (designation_code != 4)) return 0;
+
+	x26_triplet_t triplets[13];
+	decoder->kernels->unham_x26(packet->data, triplets);
+	if ((triplets[0].error > 0) || (triplets[1].error > 0)) return 0;
+	uint32_t t1 = triplets[0].address | (triplets[0].mode << 6) | ((uint32_t)triplets[0].data << 11);
+	uint32_t t2 = triplets[1].address | (triplets[1].mode << 6) | ((uint32_t)triplets[1].data << 11);
+
+	// triplet 1 bits 1 -- 4 (page function) and 5 -- 7 (page coding): Level 1 page of 7-bit odd parity characters
+	if ((t1 & 0x7f) != 0) return 0;
+	*primary = (t1 >> 7) & 0x7f;
+	*secondary = ((t1 >> 14) & 0x0f) | ((t2 & 0x07) << 4);
+	return 1;
+}
+
+static teletext_page_state_t *find_page_state(ts_stream_t *stream, uint16_t page) {
+	for (uint8_t i = 0; i < stream->page_states_count; i++)
+		if (stream->page_states[i].page == page) return &stream->page_states[i];
+	return NULL;
+}
+
+static teletext_page_state_t *add_page_state(telxcc_decoder_t *decoder, ts_stream_t *stream, uint16_t page) {
+	if (stream->page_states_count == MAX_PAGES) {
+		log_message(decoder, "- Too many teletext pages, page %03x ignored\n", page);
+		return NULL;
+	}
+
+	teletext_page_state_t *state = &stream->page_states[stream->page_states_count++];
+	memset(state, 0, sizeof(teletext_page_state_t));
+	state->page = page;
+	state->x28_primary = 255;
+	state->x28_secondary = 255;
+	select_g0_sets(decoder, stream, state);
+
+	telxcc_event_t event = {
+		.type = TELXCC_EVENT_PAGE,
+		.pid = stream->pid,
+		.page = page,
+		.position = stream->pes_position
+	};
+	emit_event(decoder, &event);
+
+	return state;
+}
+
+static ts_stream_t *add_stream(telxcc_decoder_t *decoder, uint16_t pid) {
+	if (decoder->streams_count == MAX_STREAMS) {
+		log_message(decoder, "- Too many teletext streams, PID %"PRIu16" ignored\n", pid);
+		return NULL;
+	}
+
+	ts_stream_t *stream = calloc(1, sizeof(ts_stream_t));
+	if (stream == NULL) {
+		log_message(decoder, "- Could not allocate teletext stream\n");
+		return NULL;
+	}
+	stream->pid = pid;
+	stream->continuity_counter = 255;
+	stream->using_pts = 255;
+	stream->transmission_mode = TRANSMISSION_MODE_SERIAL;
+	memset(stream->m29_primary, 255, sizeof(stream->m29_primary));
+	memset(stream->m29_secondary, 255, sizeof(stream->m29_secondary));
+	stream->pes_position = decoder->position;
+	stream->stats = &decoder->stats.streams[decoder->streams_count];
+	stream->stats->pid = pid;
+	decoder->stats.streams_count = decoder->streams_count + 1;
+
+	decoder->streams[decoder->streams_count++] = stream;
+	decoder->stream_index[pid] = decoder->streams_count;
+	decoder->pid_filter[pid] = PID_STREAM;
+	decoder->pid_filter_raised = 1;
+
+	// requested teletext pages
+	for (uint8_t i = 0; i < decoder->config.pages_count; i++)
+		if (find_page_state(stream, decoder->config.pages[i]) == NULL) add_page_state(decoder, stream, decoder->config.pages[i]);
+
+	return stream;
+}
+
+// page store (config.page_store): all pages and subpages of each stream as received, in 8-bit glyphs and attributes
+
+// stored subpage linked into list of subpages of its page (by subcode) and into list by time of last update;
+// links are indexes + 1 into entries, 0 = none
+typedef struct {
+	telxcc_stored_page_t page;
+	uint8_t stream;
+	uint32_t next;
+	uint32_t older;
+	uint32_t newer;
+	// value of store updates counter at last update
+	uint64_t updated;
+} store_entry_t;
+
+struct page_store {
+	// entries are allocated as needed, at most capacity of them (memory budget)
+	store_entry_t *entries;
+	uint32_t entries_count;
+	uint32_t entries_allocated;
+	uint32_t capacity;
+	// least and most recently updated entries
+	uint32_t oldest;
+	uint32_t newest;
+	uint64_t updates;
+	// first subpage of each page ((M - 1) << 8 | page number) of each stream, allocated as streams are found
+	uint32_t *pages[MAX_STREAMS];
+	// subpage being received in each magazine of each stream and designations in X/28 of its transmission
+	uint32_t receiving[MAX_STREAMS][8];
+	uint8_t x28_primary[MAX_STREAMS][8];
+	uint8_t x28_secondary[MAX_STREAMS][8];
+};
+
+static page_store_t *store_create(size_t budget) {
+	page_store_t *store = calloc(1, sizeof(page_store_t));
+	if (store == NULL) return NULL;
+	if (budget == 0) budget = TELXCC_STORE_BUDGET;
+	uint64_t capacity = budget / sizeof(store_entry_t);
+	if (capacity < 1) capacity = 1;
+	if (capacity > UINT32_MAX - 1) capacity = UINT32_MAX - 1;
+	store->capacity = capacity;
+	return store;
+}
+
+static void store_destroy(page_store_t *store) {
+	if (store == NULL) return;
+	for (uint8_t k = 0; k < MAX_STREAMS; k++) free(store->pages[k]);
+	free(store->entries);
+	free(store);
+}
+
+static void store_unlink(page_store_t *store, uint32_t i) {
+	store_entry_t *entry = &store->entries[i - 1];
+	if (entry->older > 0) store->entries[entry->older - 1].newer = entry->newer;
+	else store->oldest = entry->newer;
+	if (entry->newer > 0) store->entries[entry->newer - 1].older = entry->older;
+	else store->newest = entry->older;
+	entry->older = 0;
+	entry->newer = 0;
+}
+
+// entry becomes the most recently updated one
+static void store_touch(page_store_t *store, uint32_t i) {
+	store->entries[i - 1].updated = ++store->updates;
+	if (store->newest == i) return;
+	if ((store->entries[i - 1].older > 0) || (store->oldest == i)) store_unlink(store, i);
+	store_entry_t *entry = &store->entries[i - 1];
+	entry->older = store->newest;
+	if (store->newest > 0) store->entries[store->newest - 1].newer = i;
+	else store->oldest = i;
+	store->newest = i;
+}
+
+// drops entry updated least recently, returns its index + 1 for reuse
+static uint32_t store_evict(page_store_t *store) {
+	uint32_t i = store->oldest;
+	store_entry_t *entry = &store->entries[i - 1];
+	const telxcc_stored_page_t *page = &entry->page;
+	uint8_t m = magazine(page->page);
+	uint32_t *link = &store->pages[entry->stream][((m - 1) << 8) | (page->page & 0xff)];
+	while (*link != i) link = &store->entries[*link - 1].next;
+	*link = entry->next;
+	if (store->receiving[entry->stream][m - 1] == i) store->receiving[entry->stream][m - 1] = 0;
+	store_unlink(store, i);
+	return i;
+}
+
+// finds subpage, or adds empty one; returns its index + 1, 0 if out of memory
+static uint32_t store_subpage(telxcc_decoder_t *decoder, uint8_t k, uint16_t pid, uint16_t page, uint16_t subpage) {
+	page_store_t *store = decoder->store;
+	if (store->pages[k] == NULL) {
+		store->pages[k] = calloc(8 * 256, sizeof(uint32_t));
+		if (store->pages[k] == NULL) return 0;
+	}
+
+	// subpages are kept in subcode order
+	uint32_t *link = &store->pages[k][((magazine(page) - 1) << 8) | (page & 0xff)];
+	while ((*link > 0) && (store->entries[*link - 1].page.subpage < subpage)) link = &store->entries[*link - 1].next;
+	if ((*link > 0) && (store->entries[*link - 1].page.subpage == subpage)) return *link;
+
+	uint32_t i = 0;
+	if (store->entries_count < store->capacity) {
+		if (store->entries_count == store->entries_allocated) {
+			uint32_t allocated = (store->entries_allocated > 0) ? 2 * store->entries_allocated : 64;
+			if (allocated > store->capacity) allocated = store->capacity;
+			store_entry_t *entries = realloc(store->entries, allocated * sizeof(store_entry_t));
+			if (entries == NULL) return 0;
+			store->entries = entries;
+			store->entries_allocated = allocated;
+		}
+		i = ++store->entries_count;
+	}
+	else {
+		i = store_evict(store);
+		// eviction may have unlinked predecessor of position found, so it is looked up again
+		link = &store->pages[k][((magazine(page) - 1) << 8) | (page & 0xff)];
+		while ((*link > 0) && (store->entries[*link - 1].page.subpage < subpage)) link = &store->entries[*link - 1].next;
+	}
+
+	store_entry_t *entry = &store->entries[i - 1];
+	memset(entry, 0, sizeof(store_entry_t));
+	entry->page.pid = pid;
+	entry->page.page = page;
+	entry->page.subpage = subpage;
+	entry->page.g0_secondary = 255;
+	entry->stream = k;
+	entry->next = *link;
+	*link = i;
+	store_touch(store, i);
+	return i;
+}
+
+// ETS 300 706, chapter 12.2: attributes of row from its spacing attributes; "Set-At" ones apply to the character
+// space they occupy, "Set-After" ones from the next one
+static void store_attributes(telxcc_stored_page_t *page, uint8_t row) {
+	uint8_t colour = 7;
+	uint8_t flags = 0;
+	for (uint8_t col = 0; col < 40; col++) {
+		uint8_t g = page->glyphs[row][col];
+		if (g == 0x0c) flags &= ~TELXCC_ATTR_DOUBLE_HEIGHT;
+		page->attrs[row][col] = (page->attrs[row][col] & TELXCC_ATTR_ENHANCED) | flags | colour;
+
+		if ((g >= 0x01) && (g <= 0x07)) {
+			colour = g;
+			flags &= ~TELXCC_ATTR_MOSAIC;
+		}
+		else if ((g >= 0x11) && (g <= 0x17)) {
+			colour = g - 0x10;
+			flags |= TELXCC_ATTR_MOSAIC;
+		}
+		else if (g == 0x0a) flags &= ~TELXCC_ATTR_BOXED;
+		else if (g == 0x0b) flags |= TELXCC_ATTR_BOXED;
+		else if (g == 0x0d) flags |= TELXCC_ATTR_DOUBLE_HEIGHT;
+		else if (g == 0x1b) flags ^= TELXCC_ATTR_SECOND_G0;
+	}
+}
+
+// G0 designations of subpage: X/28 of its transmission, or M/29 of its magazine, with national option of header
+static void store_designations(telxcc_decoder_t *decoder, ts_stream_t *stream, uint8_t k, uint8_t m, telxcc_stored_page_t *page) {
+	page_store_t *store = decoder->store;
+	uint8_t primary = (store->x28_primary[k][m - 1] != 255) ? store->x28_primary[k][m - 1] : stream->m29_primary[m - 1];
+	uint8_t secondary = (store->x28_primary[k][m - 1] != 255) ? store->x28_secondary[k][m - 1] : stream->m29_secondary[m - 1];
+	// C12 -- C14
+	uint8_t charset = (page->control >> 8) & 0x07;
+	page->g0 = ((primary != 255) ? (primary & 0x78) : 0) | charset;
+	page->g0_secondary = secondary;
+}
+
+// updates page store with teletext packet; nibbles are unham_16() of its address and data bytes 0 -- 13
+static void store_packet(telxcc_decoder_t *decoder, ts_stream_t *stream, const teletext_packet_payload_t *packet, const uint8_t *nibbles, uint8_t m, uint8_t y, uint64_t timestamp) {
+	page_store_t *store = decoder->store;
+	uint8_t k = decoder->stream_index[stream->pid] - 1;
+	const uint8_t *data_nibbles = nibbles + 2;
+	uint32_t *receiving = store->receiving[k];
+
+	if (y == 0) {
+		// ETS 300 706, chapter 9.3.1: page number, subcode and control bits C4 -- C14
+		uint16_t page_number = (m << 8) | (data_nibbles[1] << 4) | data_nibbles[0];
+		uint16_t subpage = ((data_nibbles[5] & 0x03) << 12) | (data_nibbles[4] << 8) | ((data_nibbles[3] & 0x07) << 4) | data_nibbles[2];
+		uint16_t control = ((data_nibbles[3] & 0x08) >> 3) | ((data_nibbles[5] & 0x0c) >> 1) | (data_nibbles[6] << 3) | (data_nibbles[7] << 7);
+
+		// ETS 300 706, chapter 7.2.1: page header terminates page being received in magazine (in any magazine
+		// in serial mode); page number FF only terminates it (time filling header)
+		if ((data_nibbles[7] & 0x01) == TRANSMISSION_MODE_SERIAL) memset(receiving, 0, 8 * sizeof(uint32_t));
+		else receiving[m - 1] = 0;
+		if ((page_number & 0xff) == 0xff) return;
+
+		uint32_t i = store_subpage(decoder, k, stream->pid, page_number, subpage);
+		if (i == 0) return;
+		telxcc_stored_page_t *page = &store->entries[i - 1].page;
+		// C4 erase page; X/26 enhancements come again with each transmission (ETS 300 706, annex B.2.2)
+		if ((control & 0x01) > 0) {
+			memset(page->glyphs, 0, sizeof(page->glyphs));
+			memset(page->attrs, 0, sizeof(page->attrs));
+			page->rows = 0;
+		}
+		for (uint8_t row = 0; row < 25; row++) {
+			for (uint8_t col = 0; col < 40; col++) {
+				if ((page->attrs[row][col] & TELXCC_ATTR_ENHANCED) == 0) continue;
+				// G2 character turns into a space until it is received again
+				if (page->glyphs[row][col] >= 0x80) page->glyphs[row][col] = 0x20;
+				page->attrs[row][col] &= ~TELXCC_ATTR_ENHANCED;
+			}
+		}
+		page->marks_count = 0;
+		page->control = control;
+		page->position = stream->pes_position;
+
+		uint8_t chars[40];
+		decoder->kernels->parity_40(packet->data, chars);
+		for (uint8_t col = 8; col < 40; col++) if (chars[col] < 0x80) page->glyphs[0][col] = chars[col];
+		page->rows |= 1;
+
+		store->x28_primary[k][m - 1] = 255;
+		store->x28_secondary[k][m - 1] = 255;
+		store_designations(decoder, stream, k, m, page);
+		receiving[m - 1] = i;
+	}
+	else if (receiving[m - 1] == 0) return;
+
+	uint32_t i = receiving[m - 1];
+	telxcc_stored_page_t *page = &store->entries[i - 1].page;
+
+	if ((y >= 1) && (y <= 24)) {
+		// characters failing parity check keep their previous value
+		uint8_t chars[40];
+		decoder->kernels->parity_40(packet->data, chars);
+		for (uint8_t col = 0; col < 40; col++)
+			if ((chars[col] < 0x80) && ((page->attrs[y][col] & TELXCC_ATTR_ENHANCED) == 0)) page->glyphs[y][col] = chars[col];
+		page->rows |= 1 << y;
+	}
+	else if (y == 26) {
+		// ETS 300 706, chapter 12.3.1, table 27, as in process_telx_packet()
+		uint8_t x26_row = 0;
+		uint32_t x26_rows = 0;
+		x26_triplet_t triplets[13];
+		decoder->kernels->unham_x26(packet->data, triplets);
+		for (uint8_t j = 0; j < 13; j++) {
+			uint8_t data = triplets[j].data;
+			uint8_t mode = triplets[j].mode;
+			uint8_t address = triplets[j].address;
+			uint8_t row_address_group = (address >= 40) && (address <= 63);
+
+			if ((mode == 0x04) && (row_address_group == 1)) {
+				x26_row = address - 40;
+				if (x26_row == 0) x26_row = 24;
+			}
+			if ((mode >= 0x11) && (mode <= 0x1f) && (row_address_group == 1)) break;
+			if ((row_address_group == 1) || (data < 32)) continue;
+
+			if (mode == 0x0f) page->glyphs[x26_row][address] = 0x80 | (data - 32);
+			else if ((mode >= 0x11) && (mode <= 0x1f)) {
+				page->glyphs[x26_row][address] = data;
+				uint8_t n = 0;
+				while ((n < page->marks_count) && ((page->marks[n][0] != x26_row) || (page->marks[n][1] != address))) n++;
+				if (n == TELXCC_STORE_MARKS) continue;
+				if (n == page->marks_count) page->marks_count++;
+				page->marks[n][0] = x26_row;
+				page->marks[n][1] = address;
+				page->marks[n][2] = mode - 0x10;
+			}
+			else continue;
+			page->attrs[x26_row][address] |= TELXCC_ATTR_ENHANCED;
+			x26_rows |= 1 << x26_row;
+		}
+		// characters replaced may have been spacing attributes
+		for (uint8_t row = 0; row < 25; row++) if ((x26_rows & (1 << row)) > 0) store_attributes(page, row);
+	}
+	else if (y == 28) {
+		if (decode_g0_designations(decoder, packet, data_nibbles[0], &store->x28_primary[k][m - 1], &store->x28_secondary[k][m - 1]) == 0) return;
+		store_designations(decoder, stream, k, m, page);
+	}
+	else if (y != 0) return;
+
+	if (y <= 24) store_attributes(page, y);
+	page->timestamp = timestamp;
+	page->updates++;
+	store_touch(store, i);
+}
+
+static void process_telx_packet(telxcc_decoder_t *decoder, ts_stream_t *stream, data_unit_t data_unit_id, const teletext_packet_payload_t *packet, uint64_t timestamp) {
+	// Hamming 8/4 coded bytes: packet address and data bytes 0 -- 13 (page header, designation codes)
+	uint8_t nibbles[16];
+	decoder->kernels->unham_16(packet->address, nibbles);
+	const uint8_t *data_nibbles = nibbles + 2;
+
+	// variable names conform to ETS 300 706, chapter 7.1.2
+	uint8_t address = (nibbles[1] << 4) | nibbles[0];
+	uint8_t m = address & 0x7;
+	if (m == 0) m = 8;
+	uint8_t y = (address >> 3) & 0x1f;
+	decoder->stats.rows[m - 1][y]++;
+
+	if (decoder->store != NULL) store_packet(decoder, stream, packet, nibbles, m, y, timestamp);
+
+	teletext_page_state_t **receiving_page = stream->receiving_page;
+
+ 	if (y == 0) {
+	 	// CC map
+		uint8_t i = (data_nibbles[1] << 4) | data_nibbles[0];
+		uint8_t flag_subtitle = (data_nibbles[5] & 0x08) >> 3;
+		stream->cc_map[i] |= flag_subtitle << (m - 1);
+
+		if ((flag_subtitle > 0) && (i < 0xff)) {
+			uint16_t page_number = (m << 8) | i;
+			if ((decoder->config.pages_count == 0) && (decoder->config.all_pages == 0) && (stream->page_states_count == 0)) {
+				log_message(decoder, "- No teletext page specified, first received suitable page of PID %"PRIu16" is %03x, not guaranteed\n", stream->pid, page_number);
+				add_page_state(decoder, stream, page_number);
+			}
+			else if ((decoder->config.all_pages == 1) && (find_page_state(stream, page_number) == NULL)) {
+				log_message(decoder, "- New subtitle page %03x of PID %"PRIu16" found\n", page_number, stream->pid);
+				add_page_state(decoder, stream, page_number);
+			}
+		}
+	}
+
+	if ((y == 0) && (data_unit_id == DATA_UNIT_EBU_TELETEXT_SUBTITLE)) {
+ 		// Page number and control bits
+		uint16_t page_number = (m << 8) | (data_nibbles[1] << 4) | data_nibbles[0];
+		uint8_t charset = ((data_nibbles[7] & 0x08) | (data_nibbles[7] & 0x04) | (data_nibbles[7] & 0x02)) >> 1;
+		uint8_t flag_suppress_header = data_nibbles[6] & 0x01;
+		//uint8_t flag_inhibit_display = (data_nibbles[6] & 0x08) >> 3;
+
+		// ETS 300 706, chapter 9.3.1.3:
+		// When set to '1' the service is designated to be in Serial mode and the transmission of a page is terminated
+		// by the next page header with a different page number.
+		// When set to '0' the service is designated to be in Parallel mode and the transmission of a page is terminated
+		// by the next page header with a different page number but the same magazine number.
+		// The same setting shall be used for all page headers in the service.
+		stream->transmission_mode = data_nibbles[7] & 0x01;
+
+		// ETS 300 706, chapter 7.2.1: Page is terminated by and excludes the next page header packet
+		// having the same magazine address in parallel transmission mode, or any magazine address in serial transmission mode.
+		// OK, whole page was transmitted, however we need to wait for next subtitle frame;
+		// otherwise it would be displayed only for a few ms
+		// In live mode the page is emitted right now, and cleared at the next subtitle frame.
+		if (stream->transmission_mode == TRANSMISSION_MODE_SERIAL) {
+			if (decoder->config.live == 1)
+				for (uint8_t i = 0; i < 8; i++) if (receiving_page[i] != NULL) live_process_page(decoder, stream, receiving_page[i]);
+			memset(stream->receiving_page, 0, sizeof(stream->receiving_page));
+		}
+		else {
+			if ((decoder->config.live == 1) && (receiving_page[m - 1] != NULL)) live_process_page(decoder, stream, receiving_page[m - 1]);
+			receiving_page[m - 1] = NULL;
+		}
+
+		teletext_page_state_t *state = find_page_state(stream, page_number);
+		if (state == NULL) return;
+
+		if (decoder->config.live == 1) {
+			live_process_page(decoder, stream, state);
+			// it would be nice, if subtitle hides on previous video frame, so we contract 40 ms (1 frame @25 fps)
+			live_clear_page(decoder, stream, state, timestamp - 40);
+		}
+		// Now we have the begining of page transmittion; if there is page_buffer pending, process it
+		else if (state->page_buffer.tainted > 0) {
+			// it would be nice, if subtitle hides on previous video frame, so we contract 40 ms (1 frame @25 fps)
+			state->page_buffer.hide_timestamp = timestamp - 40;
+			process_page(decoder, stream, state);
+		}
+		// page transmitted without rows: caption held is not retransmitted
+		else emit_held(decoder, stream, state);
+
+		state->page_buffer.show_timestamp = timestamp;
+		state->page_buffer.hide_timestamp = 0;
+		state->page_buffer.show_position = stream->pes_position;
+		state->header_received = 1;
+		memset(state->page_buffer.text, 0x00, sizeof(state->page_buffer.text));
+		state->page_buffer.tainted = 0;
+		state->page_buffer.header_pcr = decoder->global_timestamp;
+		state->live_emitted = 0;
+		receiving_page[m - 1] = state;
+
+		if (charset != state->charset) {
+			state->charset = charset;
+			VERBOSE log_message(decoder, "- G0 Charset translation table remapped to G0 Latin National Subset ID %1x (page %03x)\n", charset, page_number);
+		}
+		// X/28 belongs to page transmission
+		state->x28_primary = 255;
+		state->x28_secondary = 255;
+		select_g0_sets(decoder, stream, state);
+
+		// I know -- not needed; in subtitles we will never need disturbing teletext page status bar
+		// displaying tv station name, current time etc.
+		if (flag_suppress_header == 0) {
+			uint8_t chars[40];
+			decoder->kernels->parity_40(packet->data, chars);
+			for (uint8_t i = 14; i < 40; i++) state->page_buffer.text[y][i] = char_to_ucs2(state->g0, chars[i]);
+		}
+	}
+	else if ((y >= 1) && (y <= 23) && (receiving_page[m - 1] != NULL)) {
+		if ((stream->transmission_mode == TRANSMISSION_MODE_SERIAL) && (data_unit_id != DATA_UNIT_EBU_TELETEXT_SUBTITLE)) return;
+		teletext_page_t *page_buffer = &receiving_page[m - 1]->page_buffer;
+		const uint16_t *g0 = receiving_page[m - 1]->g0;
+		const uint16_t *g0_secondary = receiving_page[m - 1]->g0_secondary;
+
+		// ETS 300 706, chapter 9.4.1: Packets X/26 at presentation Levels 1.5, 2.5, 3.5 are used for addressing
+		// a character location and overwriting the existing character defined on the Level 1 page
+		// ETS 300 706, annex B.2.2: Packets with Y = 26 shall be transmitted before any packets with Y = 1 to Y = 25;
+		// so page_buffer.text[y][i] may already contain any character received
+		// in frame number 26, skip original G0 character
+		uint8_t chars[40];
+		decoder->kernels->parity_40(packet->data, chars);
+		if (g0_secondary == NULL) {
+			for (uint8_t i = 0; i < 40; i++) if (page_buffer->text[y][i] == 0x00) page_buffer->text[y][i] = char_to_ucs2(g0, chars[i]);
+		}
+		else {
+			// ETS 300 706, chapter 12.2, table 26: ESC toggles between default and second G0 set, row starts with default
+			for (uint8_t i = 0; i < 40; i++) {
+				if (chars[i] == 0x1b) g0 = (g0 == g0_secondary) ? receiving_page[m - 1]->g0 : g0_secondary;
+				if (page_buffer->text[y][i] == 0x00) page_buffer->text[y][i] = char_to_ucs2(g0, chars[i]);
+			}
+		}
+		page_buffer->tainted = 1;
+		receiving_page[m - 1]->update_pcr = decoder->global_timestamp;
+		receiving_page[m - 1]->live_emitted = 0;
+	}
+	else if ((y == 26) && (receiving_page[m - 1] != NULL)) {
+		if ((stream->transmission_mode == TRANSMISSION_MODE_SERIAL) && (data_unit_id != DATA_UNIT_EBU_TELETEXT_SUBTITLE)) return;
+		teletext_page_t *page_buffer = &receiving_page[m - 1]->page_buffer;
+		const uint16_t *g0 = receiving_page[m - 1]->g0;
+
+		// ETS 300 706, chapter 12.3.2 (X/26 definition)
+		uint8_t x26_row = 0;
+		uint8_t x26_col = 0;
+
+		// invalid triplets decode as all zeros (no operation)
+		x26_triplet_t triplets[13];
+		decoder->kernels->unham_x26(packet->data, triplets);
+
+		for (uint8_t j = 0; j < 13; j++) {
+			uint8_t data = triplets[j].data;
+			uint8_t mode = triplets[j].mode;
+			uint8_t address = triplets[j].address;
+			uint8_t row_address_group = (address >= 40) && (address <= 63);
+
+			// ETS 300 706, chapter 12.3.1, table 27: set active position
+			if ((mode == 0x04) && (row_address_group == 1)) {
+				x26_row = address - 40;
+				if (x26_row == 0) x26_row = 24;
+				x26_col = 0;
+			}
+
+			// ETS 300 706, chapter 12.3.1, table 27: termination marker
+			if ((mode >= 0x11) && (mode <= 0x1f) && (row_address_group == 1)) break;
+
+			// ETS 300 706, chapter 12.3.1, table 27: character from G2 set
+			if ((mode == 0x0f) && (row_address_group == 0)) {
+				x26_col = address;
+				if (data > 31) page_buffer->text[x26_row][x26_col] = G2[0][data - 32];
+			}
+
+			// ETS 300 706, chapter 12.3.1, table 27: G0 character with diacritical mark
+			if ((mode >= 0x11) && (mode <= 0x1f) && (row_address_group == 0)) {
+				x26_col = address;
+
+				// A - Z
+				if ((data >= 65) && (data <= 90)) page_buffer->text[x26_row][x26_col] = G2_ACCENTS[mode - 0x11][data - 65];
+				// a - z
+				else if ((data >= 97) && (data <= 122)) page_buffer->text[x26_row][x26_col] = G2_ACCENTS[mode - 0x11][data - 71];
+				// other
+				else page_buffer->text[x26_row][x26_col] = telx_to_ucs2(g0, data);
+			}
+		}
+		receiving_page[m - 1]->update_pcr = decoder->global_timestamp;
+		receiving_page[m - 1]->live_emitted = 0;
+	}
+	else if ((y == 28) && (receiving_page[m - 1] != NULL)) {
+		if ((stream->transmission_mode == TRANSMISSION_MODE_SERIAL) && (data_unit_id != DATA_UNIT_EBU_TELETEXT_SUBTITLE)) return;
+		teletext_page_state_t *state = receiving_page[m - 1];
+
+		// ETS 300 706, chapter 9.4.2: page-specific character sets override those of magazine
+		if (decode_g0_designations(decoder, packet, data_nibbles[0], &state->x28_primary, &state->x28_secondary) == 1)
+			select_g0_sets(decoder, stream, state);
+	}
+	else if (y == 29) {
+		// ETS 300 706, chapter 9.5.1: character sets of all pages in magazine, applied from their next page header
+		decode_g0_designations(decoder, packet, data_nibbles[0], &stream->m29_primary[m - 1], &stream->m29_secondary[m - 1]);
+	}
+	else if ((y == 30) && (m == 8)) {
+		// ETS 300 706, chapter 9.8: Broadcast Service Data Packets
+		if (stream->programme_title_processed == 0) {
+			// ETS 300 706, chapter 9.8.1: Packet 8/30 Format 1
+			if (data_nibbles[0] < 2) {
+				text_buffer_t title = { NULL, 0, 0 };
+				for (uint8_t i = 20; i < 40; i++) text_append_utf8(&title, telx_to_ucs2(G0[LATIN], packet->data[i]));
+				log_message(decoder, "- Programme Identification Data = %.*s\n", (int)title.size, title.data);
+				free(title.data);
+
+				// OMG! ETS 300 706 stores timestamp in 7 bytes in Modified Julian Day in BCD format + HH:MM:SS in BCD format
+				// + timezone as 5-bit count of half-hours from GMT with 1-bit sign
+				// In addition all decimals are incremented by 1 before transmission.
+				uint32_t t = 0;
+				// 1st step: BCD to Modified Julian Day
+				t += (packet->data[10] & 0x0f) * 10000;
+				t += ((packet->data[11] & 0xf0) >> 4) * 1000;
+				t += (packet->data[11] & 0x0f) * 100;
+				t += ((packet->data[12] & 0xf0) >> 4) * 10;
+				t += (packet->data[12] & 0x0f);
+				t -= 11111;
+				// 2nd step: conversion Modified Julian Day to unix timestamp
+				t = (t - 40587) * 86400;
+				// 3rd step: add time
+				t += 3600 * ( ((packet->data[13] & 0xf0) >> 4) * 10 + (packet->data[13] & 0x0f) );
+				t +=   60 * ( ((packet->data[14] & 0xf0) >> 4) * 10 + (packet->data[14] & 0x0f) );
+				t +=        ( ((packet->data[15] & 0xf0) >> 4) * 10 + (packet->data[15] & 0x0f) );
+				t -= 40271;
+				// 4th step: conversion to time_t
+				time_t t0 = (time_t)t;
+				// ctime output itself is \n-ended
+				char utc[32] = { 0 };
+				log_message(decoder, "- Universal Time Co-ordinated = %s", ctime_r(&t0, utc));
+
+				VERBOSE log_message(decoder, "- Transmission mode = %s\n", (stream->transmission_mode == 1 ? "serial" : "parallel"));
+
+				stream->programme_title_processed = 1;
+			}
+		}
+	}
+	// else nothing; we do not process page related extension packets as in ETS 300 706, chapter 7.2.3
+}
+
+// sequential reader of PES packet bytes spread over segments
+typedef struct {
+	const pes_segment_t *segments;
+	uint8_t index;
+	uint32_t offset;
+} pes_reader_t;
+
+// copies next size bytes (dst = NULL skips them); caller checks that PES has them
+static void pes_read(pes_reader_t *reader, uint8_t *dst, uint32_t size) {
+	while (size > 0) {
+		const pes_segment_t *segment = &reader->segments[reader->index];
+		uint32_t n = segment->size - reader->offset;
+		if (n > size) n = size;
+		if (dst != NULL) {
+			memcpy(dst, segment->data + reader->offset, n);
+			dst += n;
+		}
+		reader->offset += n;
+		size -= n;
+		if (reader->offset == segment->size) {
+			reader->index++;
+			reader->offset = 0;
+		}
+	}
+}
+
+static void decode_pes_packet(telxcc_decoder_t *decoder, ts_stream_t *stream, const pes_segment_t *segments, uint32_t size) {
+	if (size < 6) return;
+
+	// PES header up to PTS
+	uint8_t buffer[14] = { 0 };
+	pes_reader_t reader = { segments, 0, 0 };
+	pes_read(&reader, buffer, (size < sizeof(buffer)) ? size : sizeof(buffer));
+
+	// Packetized Elementary Stream (PES) 32-bit start code
+	uint64_t pes_prefix = (buffer[0] << 16) | (buffer[1] << 8) | buffer[2];
+	uint8_t pes_stream_id = buffer[3];
+
+	// check for PES header
+	if (pes_prefix != 0x000001) return;
+
+	// stream_id is not "Private Stream 1" (0xbd)
+	if (pes_stream_id != 0xbd) return;
+
+	// PES packet length
+	// ETSI EN 301 775 V1.2.1 (2003-05) chapter 4.3: (N × 184) - 6 + 6 B header
+	uint32_t pes_packet_length = 6 + ((buffer[4] << 8) | buffer[5]);
+	// Can be zero. If the "PES packet length" is set to zero, the PES packet can be of any length.
+	// A value of zero for the PES packet length can be used only when the PES packet payload is a video elementary stream.
+	if (pes_packet_length == 6) return;
+
+	// truncate incomplete PES packets
+	if (pes_packet_length > size) {
+		pes_packet_length = size;
+		stream->stats->pes_truncated++;
+	}
+	stream->stats->pes++;
+
+	uint8_t optional_pes_header_included = 0;
+	uint16_t optional_pes_header_length = 0;
+	// optional PES header marker bits (10.. ....)
+	if ((buffer[6] & 0xc0) == 0x80) {
+		optional_pes_header_included = 1;
+		optional_pes_header_length = buffer[8];
+	}
+
+	if (stream->using_pts == 255) {
+		if ((optional_pes_header_included == 1) && ((buffer[7] & 0x80) > 0)) {
+			stream->using_pts = 1;
+			VERBOSE log_message(decoder, "- PID %"PRIu16" PTS available\n", stream->pid);
+		} else {
+			stream->using_pts = 0;
+			VERBOSE log_message(decoder, "- PID %"PRIu16" PTS unavailable, using TS PCR\n", stream->pid);
+		}
+	}
+
+	uint32_t t = 0;
+	// If there is no PTS available, use global PCR
+	if (stream->using_pts == 0) t = decoder->global_timestamp;
+	else {
+		// PTS is 33 bits wide, however, timestamp in ms fits into 32 bits nicely (PTS/90)
+		// presentation and decoder timestamps use the 90 KHz clock, hence PTS/90 = [ms]
+		uint64_t pts = 0;
+		// __MUST__ assign value to uint64_t and __THEN__ rotate left by 29 bits
+		// << is defined for signed int (as in "C" spec.) and overflow occures
+		pts = (buffer[9] & 0x0e);
+		pts <<= 29;
+		pts |= (buffer[10] << 22);
+		pts |= ((buffer[11] & 0xfe) << 14);
+		pts |= (buffer[12] << 7);
+		pts |= ((buffer[13] & 0xfe) >> 1);
+		t = pts / 90;
+	}
+
+	if (stream->initialized == 0) {
+		stream->delta = 1000 * decoder->config.offset - t;
+		stream->t0 = t;
+		stream->initialized = 1;
+		stream->first_t = t;
+		stream->first_delta = stream->delta;
+	}
+	if (t < stream->t0) stream->delta += 95443718;
+	stream->t0 = t;
+	uint64_t timestamp = t + stream->delta;
+
+	// skip optional PES header and process each 46-byte teletext packet; data units are read from PES segments,
+	// teletext packet is copied out as it is reversed in place
+	uint32_t i = 7;
+	if (optional_pes_header_included) i += 3 + optional_pes_header_length;
+	reader = (pes_reader_t){ segments, 0, 0 };
+	pes_read(&reader, NULL, (i < size) ? i : size);
+	while ((i <= pes_packet_length - 6) && (i + 2 <= size)) {
+		uint8_t data_unit[2];
+		pes_read(&reader, data_unit, 2);
+		uint8_t data_unit_id = data_unit[0];
+		uint8_t data_unit_len = data_unit[1];
+		i += 2;
+		decoder->stats.data_units[data_unit_id]++;
+
+		uint32_t n = (i + data_unit_len <= size) ? data_unit_len : size - i;
+		if (((data_unit_id == DATA_UNIT_EBU_TELETEXT_NONSUBTITLE) || (data_unit_id == DATA_UNIT_EBU_TELETEXT_SUBTITLE)) && (data_unit_len == 0x2c) && (n == 0x2c)) {
+			// teletext payload has always size 44 bytes
+			teletext_packet_payload_t packet;
+			pes_read(&reader, (uint8_t *)&packet, sizeof(packet));
+
+			// reverse endianess (via lookup table), ETS 300 706, chapter 7.1
+			decoder->kernels->reverse_44((uint8_t *)&packet);
+
+			process_telx_packet(decoder, stream, data_unit_id, &packet, timestamp);
+		}
+		else pes_read(&reader, NULL, n);
+
+		i += data_unit_len;
+	}
+}
+
+// PES time excludes page rendering and callback
+static void process_pes_packet(telxcc_decoder_t *decoder, ts_stream_t *stream) {
+	if (decoder->config.timing == 0) {
+		decode_pes_packet(decoder, stream, stream->pes_segments, stream->pes_size);
+		return;
+	}
+	uint64_t start = clock_ns();
+	uint64_t nested_ns = decoder->stats.stage_render_ns + decoder->stats.stage_callback_ns;
+	decode_pes_packet(decoder, stream, stream->pes_segments, stream->pes_size);
+	decoder->stats.stage_pes_ns += clock_ns() - start - (decoder->stats.stage_render_ns + decoder->stats.stage_callback_ns - nested_ns);
+}
+
+// returns PES buffer of at least size bytes (size <= PES_MAX_SIZE) from pool, NULL if out of memory
+static uint8_t *pes_buffer_get(telxcc_decoder_t *decoder, uint32_t size, uint8_t *class) {
+	uint8_t c = 0;
+	while ((PES_BUFFER_SIZE << c) < size) c++;
+	*class = c;
+	if (decoder->pes_pool_count[c] > 0) return decoder->pes_pool[c][--decoder->pes_pool_count[c]];
+	return malloc(PES_BUFFER_SIZE << c);
+}
+
+static void pes_buffer_put(telxcc_decoder_t *decoder, uint8_t *buffer, uint8_t class) {
+	if (decoder->pes_pool_count[class] < PES_POOL_DEPTH) decoder->pes_pool[class][decoder->pes_pool_count[class]++] = buffer;
+	else free(buffer);
+}
+
+// drops PES being assembled, its buffer goes back to pool
+static void pes_reset(telxcc_decoder_t *decoder, ts_stream_t *stream) {
+	if (stream->pes_buffer != NULL) pes_buffer_put(decoder, stream->pes_buffer, stream->pes_buffer_class);
+	stream->pes_buffer = NULL;
+	stream->pes_segments_count = 0;
+	stream->pes_size = 0;
+	stream->pes_assembling = 0;
+}
+
+// copies segments referenced in place into pes_buffer, grown to hold at least size bytes; returns 0 if out of memory
+static uint8_t pes_gather(telxcc_decoder_t *decoder, ts_stream_t *stream, uint32_t size) {
+	// segment 0 is pes_buffer already
+	uint8_t first = (stream->pes_buffer != NULL) ? 1 : 0;
+	if ((first == 0) || ((PES_BUFFER_SIZE << stream->pes_buffer_class) < size)) {
+		uint8_t class = 0;
+		uint8_t *buffer = pes_buffer_get(decoder, size, &class);
+		if (buffer == NULL) return 0;
+		if (first == 1) {
+			memcpy(buffer, stream->pes_buffer, stream->pes_segments[0].size);
+			pes_buffer_put(decoder, stream->pes_buffer, stream->pes_buffer_class);
+		}
+		stream->pes_buffer = buffer;
+		stream->pes_buffer_class = class;
+	}
+
+	uint32_t gathered = (first == 1) ? stream->pes_segments[0].size : 0;
+	for (uint8_t i = first; i < stream->pes_segments_count; i++) {
+		memcpy(stream->pes_buffer + gathered, stream->pes_segments[i].data, stream->pes_segments[i].size);
+		gathered += stream->pes_segments[i].size;
+	}
+	stream->pes_segments[0].data = stream->pes_buffer;
+	stream->pes_segments[0].size = gathered;
+	stream->pes_segments_count = 1;
+	return 1;
+}
+
+// appends TS packet payload to PES being assembled; returns 0 if it does not fit
+static uint8_t pes_append(telxcc_decoder_t *decoder, ts_stream_t *stream, const uint8_t *data, uint32_t size) {
+	if (stream->pes_size + size > PES_MAX_SIZE) return 0;
+
+	// referenced in place unless it is a copy made by decoder (packet split by previous call, or found on resync)
+	if ((data >= decoder->push_data) && (data < decoder->push_end) && (stream->pes_segments_count < PES_SEGMENTS)) {
+		stream->pes_segments[stream->pes_segments_count].data = data;
+		stream->pes_segments[stream->pes_segments_count].size = size;
+		stream->pes_segments_count++;
+	}
+	else {
+		if (pes_gather(decoder, stream, stream->pes_size + size) == 0) return 0;
+		memcpy(stream->pes_buffer + stream->pes_segments[0].size, data, size);
+		stream->pes_segments[0].size += size;
+	}
+	stream->pes_size += size;
+	return 1;
+}
+
+// ISO/IEC 13818-1, Annex A: CRC of whole section including its CRC_32 field is 0
+static uint32_t psi_crc32(const uint8_t *data, uint16_t size) {
+	uint32_t crc = 0xffffffff;
+	for (uint16_t i = 0; i < size; i++) {
+		crc ^= (uint32_t)data[i] << 24;
+		for (uint8_t k = 0; k < 8; k++) crc = ((crc & 0x80000000) > 0) ? (crc << 1) ^ 0x04c11db7 : (crc << 1);
+	}
+	return crc;
+}
+
+// PAT and PMT PIDs are always parsed
+static void psi_mark_pids(telxcc_decoder_t *decoder) {
+	const telxcc_psi_t *info = &decoder->psi->info;
+	decoder->pid_filter[0] = PID_STREAM;
+	for (uint8_t i = 0; i < info->programs_count; i++) decoder->pid_filter[info->pmt_pids[i]] = PID_STREAM;
+	decoder->pid_filter_raised = 1;
+}
+
+// ISO/IEC 13818-1, chapter 2.4.4.3: program association section; programs are added, never removed
+static void process_pat(telxcc_decoder_t *decoder, const uint8_t *section, uint16_t size) {
+	psi_t *psi = decoder->psi;
+	telxcc_psi_t *info = &psi->info;
+	info->pat_received = 1;
+	info->transport_stream_id = (section[3] << 8) | section[4];
+
+	for (uint16_t i = 8; i + 4 <= size - 4; i += 4) {
+		uint16_t program_number = (section[i] << 8) | section[i + 1];
+		uint16_t pid = ((section[i + 2] & 0x1f) << 8) | section[i + 3];
+		// program_number 0 is of network PID (NIT)
+		if ((program_number == 0) || (pid == 0) || (pid == 0x1fff) || (decoder->stream_index[pid] > 0)) continue;
+
+		uint8_t k = 0;
+		while ((k < info->programs_count) && (info->program_numbers[k] != program_number)) k++;
+		if (k < info->programs_count) continue;
+		if (info->programs_count == TELXCC_MAX_PROGRAMS) {
+			log_message(decoder, "- Too many programs in PAT, program %"PRIu16" ignored\n", program_number);
+			break;
+		}
+
+		info->program_numbers[k] = program_number;
+		info->pmt_pids[k] = pid;
+		info->pmt_received[k] = 0;
+		info->programs_count++;
+		// more programs may share PMT PID
+		if (psi->section_index[pid] == 0) {
+			psi->sections[psi->sections_count].continuity_counter = 255;
+			psi->section_index[pid] = ++psi->sections_count;
+		}
+		VERBOSE log_message(decoder, "- Program %"PRIu16", PMT PID %"PRIu16" (0x%x)\n", program_number, pid, pid);
+	}
+	psi_mark_pids(decoder);
+}
+
+// ISO/IEC 13818-1, chapter 2.4.4.8: TS program map section; teletext streams of program are replaced by those of
+// new PMT version
+static void process_pmt(telxcc_decoder_t *decoder, const uint8_t *section, uint16_t size) {
+	psi_t *psi = decoder->psi;
+	telxcc_psi_t *info = &psi->info;
+	uint16_t program_number = (section[3] << 8) | section[4];
+	uint8_t version = (section[5] >> 1) & 0x1f;
+
+	uint8_t k = 0;
+	while ((k < info->programs_count) && (info->program_numbers[k] != program_number)) k++;
+	if ((k == info->programs_count) || ((info->pmt_received[k] == 1) && (psi->pmt_versions[k] == version))) return;
+
+	uint8_t n = 0;
+	for (uint8_t i = 0; i < info->streams_count; i++)
+		if (info->streams[i].program_number != program_number) info->streams[n++] = info->streams[i];
+	info->streams_count = n;
+
+	uint16_t end = size - 4;
+	uint16_t program_info_length = ((section[10] & 0x0f) << 8) | section[11];
+	for (uint16_t i = 12 + program_info_length; i + 5 <= end;) {
+		uint16_t pid = ((section[i + 1] & 0x1f) << 8) | section[i + 2];
+		uint16_t descriptors = i + 5;
+		i = descriptors + (((section[i + 3] & 0x0f) << 8) | section[i + 4]);
+		if (i > end) break;
+
+		telxcc_pmt_stream_t *stream = NULL;
+		for (uint16_t d = descriptors; d + 2 <= i; d += 2 + section[d + 1]) {
+			uint8_t length = section[d + 1];
+			if (d + 2 + length > i) break;
+			// ETSI EN 300 468, chapters 6.2.43 and 6.2.47: teletext descriptor, VBI teletext descriptor
+			if ((section[d] != 0x56) && (section[d] != 0x46)) continue;
+
+			if (stream == NULL) {
+				if (info->streams_count == TELXCC_MAX_STREAMS) break;
+				stream = &info->streams[info->streams_count++];
+				memset(stream, 0, sizeof(telxcc_pmt_stream_t));
+				stream->pid = pid;
+				stream->program_number = program_number;
+			}
+			for (uint8_t j = 0; (j + 5 <= length) && (stream->pages_count < TELXCC_MAX_PAGES); j += 5) {
+				const uint8_t *entry = &section[d + 2 + j];
+				telxcc_teletext_page_t *page = &stream->pages[stream->pages_count++];
+				memcpy(page->language, entry, 3);
+				page->language[3] = '\0';
+				page->type = entry[3] >> 3;
+				// teletext_magazine_number 0 is magazine 8
+				uint8_t m = entry[3] & 0x07;
+				page->page = (((m == 0) ? 8 : m) << 8) | entry[4];
+			}
+		}
+		if (stream != NULL) VERBOSE log_message(decoder, "- Program %"PRIu16", teletext PID %"PRIu16" (0x%x) with %"PRIu8" pages listed in PMT\n", program_number, pid, pid, stream->pages_count);
+	}
+
+	info->pmt_received[k] = 1;
+	psi->pmt_versions[k] = version;
+}
+
+static void process_psi_section(telxcc_decoder_t *decoder, uint8_t pat, const uint8_t *section, uint16_t size) {
+	// section_syntax_indicator and current_next_indicator set
+	if ((size < 16) || ((section[1] & 0x80) == 0) || ((section[5] & 0x01) == 0)) return;
+	if (psi_crc32(section, size) != 0) {
+		VERBOSE log_message(decoder, "- PSI section CRC error (table_id 0x%02x)\n", section[0]);
+		return;
+	}
+	if ((pat == 1) && (section[0] == 0x00)) process_pat(decoder, section, size);
+	else if ((pat == 0) && (section[0] == 0x02)) process_pmt(decoder, section, size);
+}
+
+// appends data to section being assembled and processes section when complete; returns number of bytes used
+static uint16_t psi_append(telxcc_decoder_t *decoder, psi_section_t *section, uint8_t pat, const uint8_t *data, uint16_t size) {
+	uint16_t used = 0;
+	while (section->assembling == 1) {
+		// table_id and section_length first, then section_length bytes
+		uint16_t need = 3;
+		if (section->size >= 3) need += ((section->data[1] & 0x0f) << 8) | section->data[2];
+		if (need > PSI_SECTION_SIZE) {
+			section->assembling = 0;
+			break;
+		}
+		if ((section->size >= 3) && (section->size == need)) {
+			process_psi_section(decoder, pat, section->data, section->size);
+			section->assembling = 0;
+			break;
+		}
+		if (used == size) break;
+
+		uint16_t n = need - section->size;
+		if (n > size - used) n = size - used;
+		memcpy(&section->data[section->size], &data[used], n);
+		section->size += n;
+		used += n;
+	}
+	return used;
+}
+
+// ISO/IEC 13818-1, chapter 2.4.4: PSI sections are carried in TS packets without PES, payload_unit_start
+// indicates pointer_field
+static void process_psi_packet(telxcc_decoder_t *decoder, psi_section_t *section, uint8_t pat, const uint8_t *ts_buffer, uint8_t payload_unit_start) {
+	// duplicate packet is ignored, missing packet drops section being assembled
+	uint8_t continuity_counter = ts_buffer[3] & 0x0f;
+	if (continuity_counter == section->continuity_counter) return;
+	if ((section->continuity_counter != 255) && (continuity_counter != ((section->continuity_counter + 1) & 0x0f))) section->assembling = 0;
+	section->continuity_counter = continuity_counter;
+
+	// payload follows adaptation field
+	uint16_t offset = 4;
+	if ((ts_buffer[3] & 0x20) > 0) offset += 1 + ts_buffer[4];
+	if (offset >= TS_PACKET_SIZE) return;
+	const uint8_t *data = &ts_buffer[offset];
+	uint16_t size = TS_PACKET_SIZE - offset;
+
+	if (payload_unit_start == 0) {
+		psi_append(decoder, section, pat, data, size);
+		return;
+	}
+
+	// bytes before pointed section complete the one being assembled
+	uint8_t pointer = data[0];
+	if (1 + pointer >= size) {
+		section->assembling = 0;
+		return;
+	}
+	psi_append(decoder, section, pat, &data[1], pointer);
+	data += 1 + pointer;
+	size -= 1 + pointer;
+
+	// more sections may start in one packet, stuffing bytes 0xff follow the last one
+	section->assembling = 0;
+	while ((size > 0) && (data[0] != 0xff)) {
+		section->assembling = 1;
+		section->size = 0;
+		uint16_t used = psi_append(decoder, section, pat, data, size);
+		data += used;
+		size -= used;
+		if (section->assembling == 1) break;
+	}
+}
+
+// ts_buffer starts with sync byte (checked by caller)
+static void process_ts_packet(telxcc_decoder_t *decoder, const uint8_t *ts_buffer) {
+	decoder->stats.ts_packets_parsed++;
+
+	// Transport Stream Header
+	uint8_t ts_transport_error = (ts_buffer[1] & 0x80) >> 7;
+	uint8_t ts_payload_unit_start = (ts_buffer[1] & 0x40) >> 6;
+	uint8_t ts_transport_priority = (ts_buffer[1] & 0x20) >> 5;
+	uint16_t ts_pid = ((ts_buffer[1] & 0x1f) << 8) | ts_buffer[2];
+	//uint8_t ts_scrambling_control = (ts_buffer[3] & 0xc0) >> 6;
+	uint8_t ts_adaptation_field_exists = (ts_buffer[3] & 0x20) >> 5;
+	uint8_t ts_payload_exists = (ts_buffer[3] & 0x10) >> 4;
+	uint8_t ts_continuity_counter = ts_buffer[3] & 0x0f;
+
+	// flags are present only in adaptation field of non-zero adaptation_field_length, PCR in one of at least 7 bytes
+	uint8_t af_discontinuity = 0;
+	if ((ts_adaptation_field_exists > 0) && (ts_buffer[4] > 0)) {
+		af_discontinuity = (ts_buffer[5] & 0x80) >> 7;
+
+		// PCR in adaptation field
+		uint8_t af_pcr_exists = (ts_buffer[5] & 0x10) >> 4;
+		if ((af_pcr_exists > 0) && (ts_buffer[4] >= 7)) {
+			uint64_t pts = 0;
+			pts |= (ts_buffer[6] << 25);
+			pts |= (ts_buffer[7] << 17);
+			pts |= (ts_buffer[8] << 9);
+			pts |= (ts_buffer[9] << 1);
+			pts |= (ts_buffer[10] >> 7);
+			decoder->global_timestamp = pts/90;
+			pts = ((ts_buffer[10] & 0x01) << 8);
+			pts |= ts_buffer[11];
+			decoder->global_timestamp += pts/27000;
+
+			if (decoder->config.live == 1) live_check_timeouts(decoder);
+		}
+	}
+
+	// no payload
+	if (ts_payload_exists == 0) return;
+
+	// payload follows adaptation field, ISO/IEC 13818-1, chapter 2.4.3.4
+	uint16_t payload_offset = 4;
+	if (ts_adaptation_field_exists > 0) payload_offset += 1 + ts_buffer[4];
+
+	// PAT and PMTs
+	if ((decoder->psi != NULL) && (decoder->psi->section_index[ts_pid] > 0)) {
+		if (ts_transport_error == 0) process_psi_packet(decoder, &decoder->psi->sections[decoder->psi->section_index[ts_pid] - 1], (ts_pid == 0), ts_buffer, ts_payload_unit_start);
+		return;
+	}
+
+	// PID filter
+	if ((decoder->config.all_pids == 0) && (decoder->config.pid > 0) && (decoder->config.pid != ts_pid)) return;
+
+	// uncorrectable error?
+	if (ts_transport_error > 0) {
+		decoder->stats.transport_errors++;
+		VERBOSE log_message(decoder, "- Uncorrectable TS packet error (received CC %1x)\n", ts_continuity_counter);
+		return;
+	}
+
+	// adaptation field leaves no room for payload
+	if (payload_offset >= TS_PACKET_SIZE) {
+		VERBOSE log_message(decoder, "- Invalid adaptation field length in TS packet of PID %"PRIu16"\n", ts_pid);
+		return;
+	}
+	const uint8_t *payload = ts_buffer + payload_offset;
+	uint8_t payload_size = TS_PACKET_SIZE - payload_offset;
+
+	ts_stream_t *stream = NULL;
+	if (decoder->stream_index[ts_pid] == STREAM_IGNORED) return;
+	else if (decoder->stream_index[ts_pid] > 0) stream = decoder->streams[decoder->stream_index[ts_pid] - 1];
+	else {
+		// Private Stream 1 PES start
+		if ((ts_payload_unit_start == 0) || (payload_size < 9) || (payload[0] != 0x00) || (payload[1] != 0x00) || (payload[2] != 0x01) || (payload[3] != 0xbd)) return;
+
+		if (decoder->config.all_pids == 1) {
+			// ETSI EN 300 472, chapter 4.3: data_identifier 0x10 -- 0x1f is EBU data (Private Stream 1 carries AC-3, DVB subtitles etc. too)
+			uint16_t data_identifier = 9 + payload[8];
+			// not in this TS packet (short payload after adaptation field), next PES start is tested
+			if ((data_identifier >= payload_size) && (data_identifier < TS_PACKET_SIZE - 4)) return;
+			if ((data_identifier >= payload_size) || (payload[data_identifier] < 0x10) || (payload[data_identifier] > 0x1f)) {
+				// do not test this PID again
+				decoder->stream_index[ts_pid] = STREAM_IGNORED;
+				decoder->pid_filter[ts_pid] = PID_SKIP;
+				return;
+			}
+			log_message(decoder, "- Teletext stream PID %"PRIu16" (0x%x) found\n", ts_pid, ts_pid);
+		}
+		// Choose first suitable PID if not set
+		else if (decoder->config.pid == 0) {
+			decoder->config.pid = ts_pid;
+			memset(decoder->pid_filter, PID_SKIP, 8192);
+			if (decoder->psi != NULL) psi_mark_pids(decoder);
+			log_message(decoder, "- No teletext PID specified, first received suitable stream PID is %"PRIu16" (0x%x), not guaranteed\n", ts_pid, ts_pid);
+		}
+
+		stream = add_stream(decoder, ts_pid);
+		if (stream == NULL) {
+			decoder->stream_index[ts_pid] = STREAM_IGNORED;
+			decoder->pid_filter[ts_pid] = PID_SKIP;
+			return;
+		}
+	}
+
+	stream->stats->packets++;
+
+	// packet events are not timed (stage times are not measured per TS packet)
+	if (decoder->config.packet_events == 1) {
+		telxcc_event_t event = {
+			.type = TELXCC_EVENT_PACKET,
+			.pid = ts_pid,
+			.position = decoder->position,
+			.pcr = decoder->global_timestamp
+		};
+		decoder->callback(decoder->user_data, &event);
+	}
+
+	// TS continuity check
+	if (stream->continuity_counter == 255) {
+		stream->continuity_counter = ts_continuity_counter;
+	}
+	else {
+		if (af_discontinuity == 0) {
+			stream->continuity_counter = (stream->continuity_counter + 1) % 16;
+			if (ts_continuity_counter != stream->continuity_counter) {
+				VERBOSE log_message(decoder, "- Missing TS packet of PID %"PRIu16", flushing pes_buffer (expected CC %1x, received CC %1x, TS discontinuity %s, TS priority %s)\n",
+					ts_pid, stream->continuity_counter, ts_continuity_counter, (af_discontinuity ? "YES" : "NO"), (ts_transport_priority ? "YES" : "NO"));
+				pes_reset(decoder, stream);
+				stream->continuity_counter = 255;
+				stream->stats->continuity_errors++;
+			}
+		}
+	}
+
+	// waiting for first payload_unit_start indicator
+	if ((ts_payload_unit_start == 0) && (stream->pes_assembling == 0)) return;
+
+	// proceed with pes buffer
+	if ((ts_payload_unit_start > 0) && (stream->pes_assembling > 0)) process_pes_packet(decoder, stream);
+
+	// new pes frame start
+	if (ts_payload_unit_start > 0) {
+		pes_reset(decoder, stream);
+		stream->pes_assembling = 1;
+		stream->pes_position = decoder->position;
+
+		// timestamp base for stitching with decoder of following input part
+		if ((decoder->config.end_position > 0) && (decoder->position >= decoder->config.end_position) && (stream->end_reached == 0)) {
+			stream->end_delta = stream->delta;
+			stream->end_t0 = stream->t0;
+			stream->end_initialized = stream->initialized;
+			stream->end_reached = 1;
+		}
+	}
+
+	// add pes data to buffer
+	if (pes_append(decoder, stream, payload, payload_size) == 1) {
+		if ((decoder->config.end_position == 0) || (decoder->position < decoder->config.end_position)) decoder->stats.packets++;
+	}
+	else {
+		stream->stats->pes_overflows++;
+		VERBOSE log_message(decoder, "- PES packet size exceeds maximum PES size, probably not teletext stream\n");
+	}
+}
+
+// TS packet pre-filter: out of a block of packets, selects only those which can affect decoding -- packets of PIDs
+// being decoded, PES starts of PIDs which can be teletext, packets carrying PCR, packets with transport error
+// indicator (reported) and packets without sync byte (sync lost); all other packets are skipped without parsing
+static inline uint32_t load_u32(const uint8_t *p) {
+	uint32_t v;
+	memcpy(&v, p, 4);
+	return v;
+}
+
+static size_t prefilter_scalar(const uint8_t *data, size_t count, uint16_t stride, const uint8_t *pid_filter, uint16_t *selected) {
+	size_t n = 0;
+	for (size_t i = 0; i < count; i++, data += stride) {
+		uint16_t pid = ((data[1] & 0x1f) << 8) | data[2];
+		uint8_t pes_start = (data[1] & 0x40) >> 6;
+		uint8_t pcr = ((data[3] & 0x20) > 0) && (data[4] >= 7) && ((data[5] & 0x10) > 0);
+		if ((data[0] != 0x47) || ((data[1] & 0x80) > 0) || (pcr == 1) || ((pid_filter[pid] & (PID_STREAM | pes_start)) > 0)) selected[n++] = i;
+	}
+	return n;
+}
+
+// vector versions process words of TS header bytes 0 -- 3 (h) and 4 -- 7 (a), byte 0 being the least significant;
+// PCR flag counts only in adaptation field long enough to carry PCR (adaptation_field_length, byte 4, at least 7)
+#if defined(__SSE2__)
+// 4 packets at once; PID filter lookups stay scalar (no gathers)
+static size_t prefilter_sse2(const uint8_t *data, size_t count, uint16_t stride, const uint8_t *pid_filter, uint16_t *selected) {
+	const __m128i byte = _mm_set1_epi32(0xff);
+	const __m128i ones = _mm_set1_epi32(-1);
+	const __m128i pcr_flags = _mm_set1_epi32(0x20000000);
+	const __m128i pcr_flag = _mm_set1_epi32(0x1000);
+	const __m128i pcr_length = _mm_set1_epi32(6);
+	size_t n = 0;
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const uint8_t *p = data + i * stride;
+		__m128i h = _mm_setr_epi32(load_u32(p), load_u32(p + stride), load_u32(p + 2 * stride), load_u32(p + 3 * stride));
+		__m128i a = _mm_setr_epi32(load_u32(p + 4), load_u32(p + stride + 4), load_u32(p + 2 * stride + 4), load_u32(p + 3 * stride + 4));
+
+		__m128i no_sync = _mm_xor_si128(_mm_cmpeq_epi32(_mm_and_si128(h, byte), _mm_set1_epi32(0x47)), ones);
+		__m128i error = _mm_slli_epi32(h, 16);
+		__m128i pcr = _mm_and_si128(_mm_cmpeq_epi32(_mm_and_si128(h, pcr_flags), pcr_flags), _mm_cmpeq_epi32(_mm_and_si128(a, pcr_flag), pcr_flag));
+		pcr = _mm_and_si128(pcr, _mm_cmpgt_epi32(_mm_and_si128(a, byte), pcr_length));
+		uint32_t mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_or_si128(_mm_or_si128(no_sync, error), pcr)));
+
+		// 13-bit PID with PID_STREAM | payload_unit_start above it
+		__m128i pid = _mm_or_si128(_mm_slli_epi32(_mm_and_si128(_mm_srli_epi32(h, 8), _mm_set1_epi32(0x1f)), 8), _mm_and_si128(_mm_srli_epi32(h, 16), byte));
+		__m128i key = _mm_or_si128(_mm_and_si128(_mm_srli_epi32(h, 14), _mm_set1_epi32(PID_PES_START)), _mm_set1_epi32(PID_STREAM));
+		__m128i x = _mm_or_si128(pid, _mm_slli_epi32(key, 13));
+		uint16_t x0 = _mm_extract_epi16(x, 0), x1 = _mm_extract_epi16(x, 2), x2 = _mm_extract_epi16(x, 4), x3 = _mm_extract_epi16(x, 6);
+		mask |= ((pid_filter[x0 & 0x1fff] & (x0 >> 13)) > 0) | (((pid_filter[x1 & 0x1fff] & (x1 >> 13)) > 0) << 1) |
+			(((pid_filter[x2 & 0x1fff] & (x2 >> 13)) > 0) << 2) | (((pid_filter[x3 & 0x1fff] & (x3 >> 13)) > 0) << 3);
+
+		for (; mask != 0; mask &= mask - 1) selected[n++] = i + __builtin_ctz(mask);
+	}
+
+	size_t tail = prefilter_scalar(data + i * stride, count - i, stride, pid_filter, selected + n);
+	for (size_t j = n; j < n + tail; j++) selected[j] += i;
+	return n + tail;
+}
+#endif
+
+#if defined(PREFILTER_AVX2)
+// 8 packets at once, TS headers and PID filter entries are gathered
+__attribute__((target("avx2")))
+static size_t prefilter_avx2(const uint8_t *data, size_t count, uint16_t stride, const uint8_t *pid_filter, uint16_t *selected) {
+	const __m256i byte = _mm256_set1_epi32(0xff);
+	const __m256i ones = _mm256_set1_epi32(-1);
+	const __m256i pcr_flags = _mm256_set1_epi32(0x20000000);
+	const __m256i pcr_flag = _mm256_set1_epi32(0x1000);
+	const __m256i pcr_length = _mm256_set1_epi32(6);
+	const __m256i offsets = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(stride));
+	size_t n = 0;
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		const uint8_t *p = data + i * stride;
+		__m256i h = _mm256_i32gather_epi32((const int *)p, offsets, 1);
+		__m256i a = _mm256_i32gather_epi32((const int *)(p + 4), offsets, 1);
+
+		__m256i no_sync = _mm256_xor_si256(_mm256_cmpeq_epi32(_mm256_and_si256(h, byte), _mm256_set1_epi32(0x47)), ones);
+		__m256i error = _mm256_slli_epi32(h, 16);
+		__m256i pcr = _mm256_and_si256(_mm256_cmpeq_epi32(_mm256_and_si256(h, pcr_flags), pcr_flags), _mm256_cmpeq_epi32(_mm256_and_si256(a, pcr_flag), pcr_flag));
+		pcr = _mm256_and_si256(pcr, _mm256_cmpgt_epi32(_mm256_and_si256(a, byte), pcr_length));
+
+		// pid_filter is padded, so 4 bytes can be gathered at any PID
+		__m256i pid = _mm256_or_si256(_mm256_slli_epi32(_mm256_and_si256(_mm256_srli_epi32(h, 8), _mm256_set1_epi32(0x1f)), 8), _mm256_and_si256(_mm256_srli_epi32(h, 16), byte));
+		__m256i key = _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi32(h, 14), _mm256_set1_epi32(PID_PES_START)), _mm256_set1_epi32(PID_STREAM));
+		__m256i wanted = _mm256_and_si256(_mm256_i32gather_epi32((const int *)pid_filter, pid, 1), key);
+		wanted = _mm256_xor_si256(_mm256_cmpeq_epi32(wanted, _mm256_setzero_si256()), ones);
+
+		uint32_t mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_or_si256(_mm256_or_si256(no_sync, error), _mm256_or_si256(pcr, wanted))));
+		for (; mask != 0; mask &= mask - 1) selected[n++] = i + __builtin_ctz(mask);
+	}
+
+	size_t tail = prefilter_scalar(data + i * stride, count - i, stride, pid_filter, selected + n);
+	for (size_t j = n; j < n + tail; j++) selected[j] += i;
+	return n + tail;
+}
+#endif
+
+#if defined(PREFILTER_NEON)
+// 4 packets at once; PID filter lookups stay scalar (no gathers)
+static size_t prefilter_neon(const uint8_t *data, size_t count, uint16_t stride, const uint8_t *pid_filter, uint16_t *selected) {
+	static const uint32_t BITS[4] = { 1, 2, 4, 8 };
+	const uint32x4_t bits = vld1q_u32(BITS);
+	const uint32x4_t byte = vdupq_n_u32(0xff);
+	size_t n = 0;
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const uint8_t *p = data + i * stride;
+		const uint32_t hw[4] = { load_u32(p), load_u32(p + stride), load_u32(p + 2 * stride), load_u32(p + 3 * stride) };
+		const uint32_t aw[4] = { load_u32(p + 4), load_u32(p + stride + 4), load_u32(p + 2 * stride + 4), load_u32(p + 3 * stride + 4) };
+		uint32x4_t h = vld1q_u32(hw);
+		uint32x4_t a = vld1q_u32(aw);
+
+		uint32x4_t no_sync = vmvnq_u32(vceqq_u32(vandq_u32(h, byte), vdupq_n_u32(0x47)));
+		uint32x4_t error = vtstq_u32(h, vdupq_n_u32(0x8000));
+		uint32x4_t pcr = vandq_u32(vtstq_u32(h, vdupq_n_u32(0x20000000)), vtstq_u32(a, vdupq_n_u32(0x1000)));
+		pcr = vandq_u32(pcr, vcgtq_u32(vandq_u32(a, byte), vdupq_n_u32(6)));
+		uint32_t mask = vaddvq_u32(vandq_u32(vorrq_u32(vorrq_u32(no_sync, error), pcr), bits));
+
+		// 13-bit PID with PID_STREAM | payload_unit_start above it
+		uint32x4_t pid = vorrq_u32(vshlq_n_u32(vandq_u32(vshrq_n_u32(h, 8), vdupq_n_u32(0x1f)), 8), vandq_u32(vshrq_n_u32(h, 16), byte));
+		uint32x4_t key = vorrq_u32(vandq_u32(vshrq_n_u32(h, 14), vdupq_n_u32(PID_PES_START)), vdupq_n_u32(PID_STREAM));
+		uint32x4_t x = vorrq_u32(pid, vshlq_n_u32(key, 13));
+		uint32_t x0 = vgetq_lane_u32(x, 0), x1 = vgetq_lane_u32(x, 1), x2 = vgetq_lane_u32(x, 2), x3 = vgetq_lane_u32(x, 3);
+		mask |= ((pid_filter[x0 & 0x1fff] & (x0 >> 13)) > 0) | (((pid_filter[x1 & 0x1fff] & (x1 >> 13)) > 0) << 1) |
+			(((pid_filter[x2 & 0x1fff] & (x2 >> 13)) > 0) << 2) | (((pid_filter[x3 & 0x1fff] & (x3 >> 13)) > 0) << 3);
+
+		for (; mask != 0; mask &= mask - 1) selected[n++] = i + __builtin_ctz(mask);
+	}
+
+	size_t tail = prefilter_scalar(data + i * stride, count - i, stride, pid_filter, selected + n);
+	for (size_t j = n; j < n + tail; j++) selected[j] += i;
+	return n + tail;
+}
+#endif
+
+// the fastest pre-filter running CPU supports
+static prefilter_t select_prefilter(const char **name) {
+#if defined(PREFILTER_AVX2)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		*name = "AVX2";
+		return prefilter_avx2;
+	}
+#endif
+#if defined(__SSE2__)
+	*name = "SSE2";
+	return prefilter_sse2;
+#elif defined(PREFILTER_NEON)
+	*name = "NEON";
+	return prefilter_neon;
+#else
+	*name = "scalar";
+	return prefilter_scalar;
+#endif
+}
+
+void telxcc_config_init(telxcc_config_t *config) {
+	memset(config, 0, sizeof(telxcc_config_t));
+	config->log = stderr;
+}
+
+telxcc_decoder_t *telxcc_create(const telxcc_config_t *config, telxcc_callback_t callback, void *user_data) {
+	telxcc_decoder_t *decoder = calloc(1, sizeof(telxcc_decoder_t));
+	if (decoder == NULL) return NULL;
+
+	decoder->config = *config;
+	decoder->callback = callback;
+	decoder->user_data = user_data;
+	decoder->position = config->start_position;
+	decoder->input_position = config->start_position;
+
+	// unknown PIDs matter only when starting PES (see process_ts_packet)
+	if ((config->all_pids == 0) && (config->pid > 0)) decoder->pid_filter[config->pid & 0x1fff] = PID_PES_START;
+	else memset(decoder->pid_filter, PID_PES_START, 8192);
+
+	if (config->psi == 1) {
+		decoder->psi = calloc(1, sizeof(psi_t));
+		if (decoder->psi == NULL) {
+			free(decoder);
+			return NULL;
+		}
+		decoder->psi->sections[0].continuity_counter = 255;
+		decoder->psi->section_index[0] = 1;
+		decoder->psi->sections_count = 1;
+		psi_mark_pids(decoder);
+	}
+
+	if (config->page_store == 1) {
+		decoder->store = store_create(config->page_store_budget);
+		if (decoder->store == NULL) {
+			free(decoder->psi);
+			free(decoder);
+			return NULL;
+		}
+	}
+
+	const char *prefilter_name = NULL;
+	decoder->prefilter = select_prefilter(&prefilter_name);
+	VERBOSE log_message(decoder, "- TS packet pre-filter: %s\n", prefilter_name);
+
+	decoder->kernels = select_row_kernels();
+	VERBOSE log_message(decoder, "- Teletext row kernels: %s\n", decoder->kernels->name);
+
+	return decoder;
+}
+
+// finds first position followed by SYNC_LOCK_PACKETS sync bytes at packet size distance; returns 1 and sets
+// offset and packet_size, or returns 0 and sets offset to the first position which could not be decided yet
+static int find_sync(const telxcc_decoder_t *decoder, const uint8_t *buffer, size_t size, size_t *offset, uint16_t *packet_size) {
+	// packet sizes ascending, smaller preferred
+	const uint16_t *sizes = PACKET_SIZES;
+	uint8_t sizes_count = 3;
+	if (decoder->config.packet_size > 0) {
+		sizes = &decoder->config.packet_size;
+		sizes_count = 1;
+	}
+	size_t window = (SYNC_LOCK_PACKETS - 1) * sizes[sizes_count - 1];
+	size_t p = 0;
+
+#if defined(__SSE2__)
+	// 16 candidate positions at once: bit i of mask is set if all sync bytes of position p + i are present
+	const __m128i sync = _mm_set1_epi8(0x47);
+	for (; p + 16 + window <= size; p += 16) {
+		uint32_t masks[3] = { 0 };
+		uint32_t any = 0;
+		for (uint8_t i = 0; i < sizes_count; i++) {
+			uint32_t mask = 0xffff;
+			for (uint8_t k = 0; (mask != 0) && (k < SYNC_LOCK_PACKETS); k++)
+				mask &= _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(buffer + p + k * sizes[i])), sync));
+			masks[i] = mask;
+			any |= mask;
+		}
+		if (any == 0) continue;
+
+		uint8_t bit = __builtin_ctz(any);
+		for (uint8_t i = 0; i < sizes_count; i++)
+			if (((masks[i] >> bit) & 1) > 0) {
+				*offset = p + bit;
+				*packet_size = sizes[i];
+				return 1;
+			}
+	}
+#endif
+
+	for (; p < size; p++) {
+		if (buffer[p] != 0x47) continue;
+		for (uint8_t i = 0; i < sizes_count; i++) {
+			// not enough data to decide
+			if (p + (SYNC_LOCK_PACKETS - 1) * sizes[i] >= size) {
+				*offset = p;
+				return 0;
+			}
+			uint8_t k = 1;
+			while ((k < SYNC_LOCK_PACKETS) && (buffer[p + k * sizes[i]] == 0x47)) k++;
+			if (k == SYNC_LOCK_PACKETS) {
+				*offset = p;
+				*packet_size = sizes[i];
+				return 1;
+			}
+		}
+	}
+
+	*offset = size;
+	return 0;
+}
+
+// processes packet stream locked on; returns 0 when all data are consumed, -1 when sync byte is missing
+// (data then point to the missing sync byte)
+static int push_locked(telxcc_decoder_t *decoder, const uint8_t **data, size_t *size, uint64_t *position) {
+	const uint8_t *d = *data;
+	size_t s = *size;
+	uint64_t pos = *position;
+	int r = 0;
+
+	while (s > 0) {
+		// bytes following previous TS packet
+		if (decoder->skip > 0) {
+			size_t n = (decoder->skip < s) ? decoder->skip : s;
+			decoder->skip -= n;
+			d += n;
+			s -= n;
+			pos += n;
+			continue;
+		}
+
+		// TS packet split by previous call
+		if (decoder->carry_size > 0) {
+			size_t n = TS_PACKET_SIZE - decoder->carry_size;
+			if (n > s) n = s;
+			memcpy(decoder->carry + decoder->carry_size, d, n);
+			decoder->carry_size += n;
+			d += n;
+			s -= n;
+			pos += n;
+			if (decoder->carry_size < TS_PACKET_SIZE) break;
+			decoder->carry_size = 0;
+			decoder->position = decoder->carry_position;
+			decoder->stats.ts_packets++;
+			process_ts_packet(decoder, decoder->carry);
+			decoder->skip = decoder->packet_size - TS_PACKET_SIZE;
+			continue;
+		}
+
+		if (d[0] != 0x47) {
+			r = -1;
+			break;
+		}
+
+		// block of whole TS packets: only pre-filtered ones are parsed
+		size_t count = (s >= TS_PACKET_SIZE) ? (s - TS_PACKET_SIZE) / decoder->packet_size + 1 : 0;
+		if (count >= PREFILTER_MIN_PACKETS) {
+			if (count > PREFILTER_PACKETS) count = PREFILTER_PACKETS;
+			uint16_t selected[PREFILTER_PACKETS];
+			size_t first = 0;
+			while ((r == 0) && (first < count)) {
+				size_t n = decoder->prefilter(d + first * decoder->packet_size, count - first, decoder->packet_size, decoder->pid_filter, selected);
+				decoder->pid_filter_raised = 0;
+				size_t next = count;
+				for (size_t k = 0; k < n; k++) {
+					size_t i = first + selected[k];
+					const uint8_t *packet = d + i * decoder->packet_size;
+					if (packet[0] != 0x47) {
+						r = -1;
+						next = i;
+						break;
+					}
+					decoder->position = pos + i * decoder->packet_size;
+					process_ts_packet(decoder, packet);
+					// packets skipped so far could be selected now
+					if (decoder->pid_filter_raised > 0) {
+						next = i + 1;
+						break;
+					}
+				}
+				first = next;
+			}
+
+			if (r < 0) {
+				decoder->stats.ts_packets += first;
+				d += first * decoder->packet_size;
+				s -= first * decoder->packet_size;
+				pos += first * decoder->packet_size;
+				break;
+			}
+			decoder->stats.ts_packets += count;
+			size_t n = (count - 1) * decoder->packet_size + TS_PACKET_SIZE;
+			d += n;
+			s -= n;
+			pos += n;
+			decoder->skip = decoder->packet_size - TS_PACKET_SIZE;
+			continue;
+		}
+
+		// whole TS packets are processed in place
+		if (s >= TS_PACKET_SIZE) {
+			decoder->position = pos;
+			decoder->stats.ts_packets++;
+			process_ts_packet(decoder, d);
+			d += TS_PACKET_SIZE;
+			s -= TS_PACKET_SIZE;
+			pos += TS_PACKET_SIZE;
+			decoder->skip = decoder->packet_size - TS_PACKET_SIZE;
+			continue;
+		}
+
+		decoder->carry_position = pos;
+		memcpy(decoder->carry, d, s);
+		decoder->carry_size = s;
+		d += s;
+		pos += s;
+		s = 0;
+	}
+
+	*data = d;
+	*size = s;
+	*position = pos;
+	return r;
+}
+
+static void sync_lost(telxcc_decoder_t *decoder, uint64_t position) {
+	log_message(decoder, "- TS sync lost at position %"PRIu64", resynchronising\n", position);
+	decoder->packet_size = 0;
+	decoder->stats.sync_losses++;
+}
+
+// searches for packet stream; returns number of bytes consumed
+static size_t push_unlocked(telxcc_decoder_t *decoder, const uint8_t *data, size_t size) {
+	size_t n = SYNC_BUFFER_SIZE - decoder->sync_size;
+	if (n > size) n = size;
+	memcpy(decoder->sync_buffer + decoder->sync_size, data, n);
+	decoder->sync_size += n;
+	decoder->input_position += n;
+
+	while ((decoder->packet_size == 0) && (decoder->sync_size > 0)) {
+		uint64_t position = decoder->input_position - decoder->sync_size;
+		size_t offset = 0;
+		uint16_t packet_size = 0;
+		uint8_t found = find_sync(decoder, decoder->sync_buffer, decoder->sync_size, &offset, &packet_size);
+		decoder->stats.bytes_skipped += offset;
+		if (found == 0) {
+			memmove(decoder->sync_buffer, decoder->sync_buffer + offset, decoder->sync_size - offset);
+			decoder->sync_size -= offset;
+			break;
+		}
+
+		position += offset;
+		if (decoder->sync_locked_once == 0) {
+			VERBOSE log_message(decoder, "- TS packet size is %"PRIu16" bytes\n", packet_size);
+		}
+		else log_message(decoder, "- TS sync found at position %"PRIu64" (packet size %"PRIu16" bytes)\n", position, packet_size);
+		decoder->sync_locked_once = 1;
+		decoder->packet_size = packet_size;
+		decoder->skip = 0;
+		decoder->carry_size = 0;
+
+		// rest of buffer is a locked packet stream
+		const uint8_t *rest = decoder->sync_buffer + offset;
+		size_t rest_size = decoder->sync_size - offset;
+		if (push_locked(decoder, &rest, &rest_size, &position) == 0) {
+			decoder->sync_size = 0;
+			break;
+		}
+		sync_lost(decoder, position);
+		memmove(decoder->sync_buffer, rest, rest_size);
+		decoder->sync_size = rest_size;
+	}
+
+	return n;
+}
+
+int telxcc_push(telxcc_decoder_t *decoder, const uint8_t *data, size_t size) {
+	decoder->stats.bytes += size;
+	decoder->push_data = data;
+	decoder->push_end = data + size;
+	while (size > 0) {
+		if (decoder->packet_size > 0) {
+			if (push_locked(decoder, &data, &size, &decoder->input_position) == 0) break;
+			sync_lost(decoder, decoder->input_position);
+		}
+		size_t n = push_unlocked(decoder, data, size);
+		data += n;
+		size -= n;
+	}
+
+	// data pushed are not referenced after return: PES being assembled are copied out
+	for (uint8_t k = 0; k < decoder->streams_count; k++) {
+		ts_stream_t *stream = decoder->streams[k];
+		if (stream->pes_segments_count > ((stream->pes_buffer != NULL) ? 1 : 0)) {
+			if (pes_gather(decoder, stream, stream->pes_size) == 0) {
+				log_message(decoder, "- Out of memory, PES packet of PID %"PRIu16" dropped\n", stream->pid);
+				pes_reset(decoder, stream);
+			}
+		}
+	}
+	decoder->push_data = NULL;
+	decoder->push_end = NULL;
+
+	return 0;
+}
+
+void telxcc_get_stats(const telxcc_decoder_t *decoder, telxcc_stats_t *stats) {
+	*stats = decoder->stats;
+}
+
+int telxcc_pending(const telxcc_decoder_t *decoder) {
+	if (decoder->config.end_position == 0) return 0;
+
+	for (uint8_t k = 0; k < decoder->streams_count; k++) {
+		const ts_stream_t *stream = decoder->streams[k];
+		// PES started before end position has not been processed yet
+		if ((stream->pes_assembling > 0) && (stream->pes_position < decoder->config.end_position)) return 1;
+		for (uint8_t i = 0; i < stream->page_states_count; i++) {
+			const teletext_page_state_t *state = &stream->page_states[i];
+			// page with header before end position is not terminated yet
+			if ((state->header_received == 1) && (state->page_buffer.show_position < decoder->config.end_position)) return 1;
+			// caption held (config.merge_repeats) with header before end position is not emitted yet
+			if ((state->held_pending == 1) && (state->held.show_position < decoder->config.end_position)) return 1;
+		}
+	}
+	return 0;
+}
+
+int telxcc_get_stream_info(const telxcc_decoder_t *decoder, uint8_t index, telxcc_stream_info_t *info) {
+	if (index >= decoder->streams_count) return 0;
+	const ts_stream_t *stream = decoder->streams[index];
+	info->pid = stream->pid;
+	info->cc_map = stream->cc_map;
+	info->timing_initialized = stream->initialized;
+	info->end_timing_initialized = (stream->end_reached == 1) ? stream->end_initialized : stream->initialized;
+	info->first_t = stream->first_t;
+	info->first_delta = stream->first_delta;
+	info->end_delta = (stream->end_reached == 1) ? stream->end_delta : stream->delta;
+	info->end_t0 = (stream->end_reached == 1) ? stream->end_t0 : stream->t0;
+	return 1;
+}
+
+void telxcc_flush(telxcc_decoder_t *decoder) {
+	for (uint8_t k = 0; k < decoder->streams_count; k++) {
+		ts_stream_t *stream = decoder->streams[k];
+		for (uint8_t i = 0; i < stream->page_states_count; i++) emit_held(decoder, stream, &stream->page_states[i]);
+	}
+}
+
+void telxcc_get_psi(const telxcc_decoder_t *decoder, telxcc_psi_t *psi) {
+	if (decoder->psi != NULL) *psi = decoder->psi->info;
+	else memset(psi, 0, sizeof(telxcc_psi_t));
+}
+
+// first subpage of page of stream with pid, 0 = none
+static uint32_t store_first(const telxcc_decoder_t *decoder, uint16_t pid, uint16_t page, uint8_t *k) {
+	const page_store_t *store = decoder->store;
+	uint8_t index = decoder->stream_index[pid & 0x1fff];
+	uint8_t m = magazine(page);
+	if ((store == NULL) || (index == 0) || (index == STREAM_IGNORED) || (m < 1) || (m > 8)) return 0;
+	*k = index - 1;
+	if (store->pages[*k] == NULL) return 0;
+	return store->pages[*k][((m - 1) << 8) | (page & 0xff)];
+}
+
+int telxcc_store_get(const telxcc_decoder_t *decoder, uint16_t pid, uint16_t page, uint16_t subpage, telxcc_stored_page_t *stored) {
+	const page_store_t *store = decoder->store;
+	uint8_t k = 0;
+	const store_entry_t *found = NULL;
+	for (uint32_t i = store_first(decoder, pid, page, &k); i > 0; i = store->entries[i - 1].next) {
+		const store_entry_t *entry = &store->entries[i - 1];
+		if (subpage == 0xffff) {
+			if ((found == NULL) || (entry->updated > found->updated)) found = entry;
+		}
+		else if (entry->page.subpage == subpage) found = entry;
+	}
+	if (found == NULL) return 0;
+	*stored = found->page;
+	return 1;
+}
+
+int telxcc_store_next(const telxcc_decoder_t *decoder, telxcc_stored_page_t *stored) {
+	const page_store_t *store = decoder->store;
+	if (store == NULL) return 0;
+
+	uint8_t k = 0;
+	uint16_t slot = 0;
+	if (stored->pid > 0) {
+		uint8_t index = decoder->stream_index[stored->pid & 0x1fff];
+		uint8_t m = magazine(stored->page);
+		if ((index == 0) || (index == STREAM_IGNORED) || (m < 1) || (m > 8)) return 0;
+		k = index - 1;
+		uint32_t i = store_first(decoder, stored->pid, stored->page, &k);
+		while ((i > 0) && (store->entries[i - 1].page.subpage <= stored->subpage)) i = store->entries[i - 1].next;
+		if (i > 0) {
+			*stored = store->entries[i - 1].page;
+			return 1;
+		}
+		slot = (((m - 1) << 8) | (stored->page & 0xff)) + 1;
+	}
+
+	for (; k < decoder->streams_count; k++, slot = 0) {
+		if (store->pages[k] == NULL) continue;
+		for (; slot < 8 * 256; slot++) {
+			if (store->pages[k][slot] == 0) continue;
+			*stored = store->entries[store->pages[k][slot] - 1].page;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+size_t telxcc_store_text(const telxcc_stored_page_t *stored, char *text) {
+	const char *name = NULL;
+	const uint16_t *g0 = g0_set(stored->g0, &name);
+	const uint16_t *g0_secondary = (stored->g0_secondary != 255) ? g0_set(stored->g0_secondary, &name) : g0;
+
+	size_t size = 0;
+	for (uint8_t row = 0; row < 25; row++) {
+		for (uint8_t col = 0; col < 40; col++) {
+			uint8_t g = stored->glyphs[row][col];
+			uint8_t a = stored->attrs[row][col];
+			uint16_t ch = 32;
+			if (((stored->rows & (1 << row)) == 0) || (g < 0x20) || (g >= 0xe0)) ch = 32;
+			else if (g >= 0x80) ch = G2[0][g - 0x80];
+			else if (((a & TELXCC_ATTR_MOSAIC) > 0) && ((g < 0x40) || (g > 0x5f))) ch = 32;
+			else {
+				ch = ((a & TELXCC_ATTR_SECOND_G0) > 0) ? g0_secondary[g - 32] : g0[g - 32];
+				if ((a & TELXCC_ATTR_ENHANCED) > 0) {
+					for (uint8_t n = 0; n < stored->marks_count; n++) {
+						if ((stored->marks[n][0] != row) || (stored->marks[n][1] != col)) continue;
+						if ((g >= 65) && (g <= 90)) ch = G2_ACCENTS[stored->marks[n][2] - 1][g - 65];
+						else if ((g >= 97) && (g <= 122)) ch = G2_ACCENTS[stored->marks[n][2] - 1][g - 71];
+					}
+				}
+			}
+
+			if (ch < 0x800) {
+				// always copy 4 bytes, only valid ones are accounted (TELXCC_STORE_TEXT_SIZE leaves room for it)
+				uint32_t u = UTF8[ch];
+				memcpy(text + size, &u, 4);
+				size += u >> 24;
+			}
+			else {
+				text[size++] = (ch >> 12) | 0xe0;
+				text[size++] = ((ch >> 6) & 0x3f) | 0x80;
+				text[size++] = (ch & 0x3f) | 0x80;
+			}
+		}
+		text[size++] = '\n';
+	}
+	text[size] = '\0';
+	return size;
+}
+
+void telxcc_destroy(telxcc_decoder_t *decoder) {
+	if (decoder == NULL) return;
+	for (uint8_t i = 0; i < decoder->streams_count; i++) {
+		for (uint8_t j = 0; j < decoder->streams[i]->page_states_count; j++) free(decoder->streams[i]->page_states[j].held_text.data);
+		free(decoder->streams[i]->pes_buffer);
+		free(decoder->streams[i]);
+	}
+	for (uint8_t c = 0; c < PES_POOL_CLASSES; c++) {
+		for (uint8_t i = 0; i < decoder->pes_pool_count[c]; i++) free(decoder->pes_pool[c][i]);
+	}
+	free(decoder->text.data);
+	free(decoder->psi);
+	store_destroy(decoder->store);
+	free(decoder);
+}
@@ -32,7 +32,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
 
 #include <inttypes.h>
 
-const uint8_t PARITY_8[256] = {
+static const uint8_t PARITY_8[256] = {
 	0x00, 0x01, 0x01, 0x00, 0x01, 0x00, 0x00, 0x01, 0x01, 0x00, 0x00, 0x01, 0x00, 0x01, 0x01, 0x00,
 	0x01, 0x00, 0x00, 0x01, 0x00, 0x01, 0x01, 0x00, 0x00, 0x01, 0x01, 0x00, 0x01, 0x00, 0x00, 0x01,
 	0x01, 0x00, 0x00, 0x01, 0x00, 0x01, 0x01, 0x00, 0x00, 0x01, 0x01, 0x00, 0x01, 0x00, 0x00, 0x01,
@@ -51,7 +51,7 @@ const uint8_t PARITY_8[256] = {
 	0x00, 0x01, 0x01, 0x00, 0x01, 0x00, 0x00, 0x01, 0x01, 0x00, 0x00, 0x01, 0x00, 0x01, 0x01, 0x00
 };
 
-const uint8_t REVERSE_8[256] = {
+static const uint8_t REVERSE_8[256] = {
 	0x00, 0x80, 0x40, 0xc0, 0x20, 0xa0, 0x60, 0xe0, 0x10, 0x90, 0x50, 0xd0, 0x30, 0xb0, 0x70, 0xf0,
 	0x08, 0x88, 0x48, 0xc8, 0x28, 0xa8, 0x68, 0xe8, 0x18, 0x98, 0x58, 0xd8, 0x38, 0xb8, 0x78, 0xf8,
 	0x04, 0x84, 0x44, 0xc4, 0x24, 0xa4, 0x64, 0xe4, 0x14, 0x94, 0x54, 0xd4, 0x34, 0xb4, 0x74, 0xf4,
@@ -70,7 +70,10 @@ const uint8_t REVERSE_8[256] = {
 	0x0f, 0x8f, 0x4f, 0xcf, 0x2f, 0xaf, 0x6f, 0xef, 0x1f, 0x9f, 0x5f, 0xdf, 0x3f, 0xbf, 0x7f, 0xff
 };
 
-const uint8_t UNHAM_8_4[256] = {
+// Hamming 8/4 codes of nibbles (encoding, used by generator and benchmarks)
+static const uint8_t HAM_8_4[16] = { 0x15, 0x02, 0x49, 0x5e, 0x64, 0x73, 0x38, 0x2f, 0xd0, 0xc7, 0x8c, 0x9b, 0xa1, 0xb6, 0xfd, 0xea };
+
+static const uint8_t UNHAM_8_4[256] = {
 	0x01, 0xff, 0x01, 0x01, 0xff, 0x00, 0x01, 0xff, 0xff, 0x02, 0x01, 0xff, 0x0a, 0xff, 0xff, 0x07,
 	0xff, 0x00, 0x01, 0xff, 0x00, 0x00, 0xff, 0x00, 0x06, 0xff, 0xff, 0x0b, 0xff, 0x00, 0x03, 0xff,
 	0xff, 0x0c, 0x01, 0xff, 0x04, 0xff, 0xff, 0x07, 0x06, 0xff, 0xff, 0x07, 0xff, 0x07, 0x07, 0x07,
@@ -89,7 +92,7 @@ const uint8_t UNHAM_8_4[256] = {
 	0x08, 0xff, 0xff, 0x05, 0xff, 0x0e, 0x0d, 0xff, 0xff, 0x0e, 0x0f, 0xff, 0x0e, 0x0e, 0xff, 0x0e
 };
 
-const uint8_t UNHAM_24_18_PAR[3][256] = {
+static const uint8_t UNHAM_24_18_PAR[3][256] = {
 	{
 		0x00, 0x21, 0x22, 0x03, 0x23, 0x02, 0x01, 0x20, 0x24, 0x05, 0x06, 0x27, 0x07, 0x26, 0x25, 0x04,
 		0x25, 0x04, 0x07, 0x26, 0x06, 0x27, 0x24, 0x05, 0x01, 0x20, 0x23, 0x02, 0x22, 0x03, 0x00, 0x21,
@@ -146,14 +149,14 @@ const uint8_t UNHAM_24_18_PAR[3][256] = {
 	}
 };
 
-const uint8_t UNHAM_24_18_D1_D4[64] = {
+static const uint8_t UNHAM_24_18_D1_D4[64] = {
 	0x00, 0x01, 0x00, 0x01, 0x02, 0x03, 0x02, 0x03, 0x04, 0x05, 0x04, 0x05, 0x06, 0x07, 0x06, 0x07,
 	0x08, 0x09, 0x08, 0x09, 0x0a, 0x0b, 0x0a, 0x0b, 0x0c, 0x0d, 0x0c, 0x0d, 0x0e, 0x0f, 0x0e, 0x0f,
 	0x00, 0x01, 0x00, 0x01, 0x02, 0x03, 0x02, 0x03, 0x04, 0x05, 0x04, 0x05, 0x06, 0x07, 0x06, 0x07,
 	0x08, 0x09, 0x08, 0x09, 0x0a, 0x0b, 0x0a, 0x0b, 0x0c, 0x0d, 0x0c, 0x0d, 0x0e, 0x0f, 0x0e, 0x0f
 };
 
-const uint32_t UNHAM_24_18_ERR[64] = {
+static const uint32_t UNHAM_24_18_ERR[64] = {
 	0x00000000, 0x80000000, 0x80000000, 0x80000000, 0x80000000, 0x80000000, 0x80000000, 0x80000000,
 	0x80000000, 0x80000000, 0x80000000, 0x80000000, 0x80000000, 0x80000000, 0x80000000, 0x80000000,
 	0x80000000, 0x80000000, 0x80000000, 0x80000000, 0x80000000, 0x80000000, 0x80000000, 0x80000000,
@@ -164,4 +167,111 @@ const uint32_t UNHAM_24_18_ERR[64] = {
 	0x80000000, 0x80000000, 0x80000000, 0x80000000, 0x80000000, 0x80000000, 0x80000000, 0x80000000
 };
 
+// UNHAM_24_18_D1_D4, data bits D5 -- D18 and UNHAM_24_18_PAR combined per triplet byte: data bits in their place
+// in decoded value, parity check bits ABCDEF in the upper byte; byte values are XORed
+static const uint32_t UNHAM_24_18_DATA_PAR[3][256] = {
+	{
+		0x00000000, 0x21000000, 0x22000000, 0x03000000, 0x23000001, 0x02000001, 0x01000001, 0x20000001,
+		0x24000000, 0x05000000, 0x06000000, 0x27000000, 0x07000001, 0x26000001, 0x25000001, 0x04000001,
+		0x25000002, 0x04000002, 0x07000002, 0x26000002, 0x06000003, 0x27000003, 0x24000003, 0x05000003,
+		0x01000002, 0x20000002, 0x23000002, 0x02000002, 0x22000003, 0x03000003, 0x00000003, 0x21000003,
+		0x26000004, 0x07000004, 0x04000004, 0x25000004, 0x05000005, 0x24000005, 0x27000005, 0x06000005,
+		0x02000004, 0x23000004, 0x20000004, 0x01000004, 0x21000005, 0x00000005, 0x03000005, 0x22000005,
+		0x03000006, 0x22000006, 0x21000006, 0x00000006, 0x20000007, 0x01000007, 0x02000007, 0x23000007,
+		0x27000006, 0x06000006, 0x05000006, 0x24000006, 0x04000007, 0x25000007, 0x26000007, 0x07000007,
+		0x27000008, 0x06000008, 0x05000008, 0x24000008, 0x04000009, 0x25000009, 0x26000009, 0x07000009,
+		0x03000008, 0x22000008, 0x21000008, 0x00000008, 0x20000009, 0x01000009, 0x02000009, 0x23000009,
+		0x0200000a, 0x2300000a, 0x2000000a, 0x0100000a, 0x2100000b, 0x0000000b, 0x0300000b, 0x2200000b,
+		0x2600000a, 0x0700000a, 0x0400000a, 0x2500000a, 0x0500000b, 0x2400000b, 0x2700000b, 0x0600000b,
+		0x0100000c, 0x2000000c, 0x2300000c, 0x0200000c, 0x2200000d, 0x0300000d, 0x0000000d, 0x2100000d,
+		0x2500000c, 0x0400000c, 0x0700000c, 0x2600000c, 0x0600000d, 0x2700000d, 0x2400000d, 0x0500000d,
+		0x2400000e, 0x0500000e, 0x0600000e, 0x2700000e, 0x0700000f, 0x2600000f, 0x2500000f, 0x0400000f,
+		0x0000000e, 0x2100000e, 0x2200000e, 0x0300000e, 0x2300000f, 0x0200000f, 0x0100000f, 0x2000000f,
+		0x28000000, 0x09000000, 0x0a000000, 0x2b000000, 0x0b000001, 0x2a000001, 0x29000001, 0x08000001,
+		0x0c000000, 0x2d000000, 0x2e000000, 0x0f000000, 0x2f000001, 0x0e000001, 0x0d000001, 0x2c000001,
+		0x0d000002, 0x2c000002, 0x2f000002, 0x0e000002, 0x2e000003, 0x0f000003, 0x0c000003, 0x2d000003,
+		0x29000002, 0x08000002, 0x0b000002, 0x2a000002, 0x0a000003, 0x2b000003, 0x28000003, 0x09000003,
+		0x0e000004, 0x2f000004, 0x2c000004, 0x0d000004, 0x2d000005, 0x0c000005, 0x0f000005, 0x2e000005,
+		0x2a000004, 0x0b000004, 0x08000004, 0x29000004, 0x09000005, 0x28000005, 0x2b000005, 0x0a000005,
+		0x2b000006, 0x0a000006, 0x09000006, 0x28000006, 0x08000007, 0x29000007, 0x2a000007, 0x0b000007,
+		0x0f000006, 0x2e000006, 0x2d000006, 0x0c000006, 0x2c000007, 0x0d000007, 0x0e000007, 0x2f000007,
+		0x0f000008, 0x2e000008, 0x2d000008, 0x0c000008, 0x2c000009, 0x0d000009, 0x0e000009, 0x2f000009,
+		0x2b000008, 0x0a000008, 0x09000008, 0x28000008, 0x08000009, 0x29000009, 0x2a000009, 0x0b000009,
+		0x2a00000a, 0x0b00000a, 0x0800000a, 0x2900000a, 0x0900000b, 0x2800000b, 0x2b00000b, 0x0a00000b,
+		0x0e00000a, 0x2f00000a, 0x2c00000a, 0x0d00000a, 0x2d00000b, 0x0c00000b, 0x0f00000b, 0x2e00000b,
+		0x2900000c, 0x0800000c, 0x0b00000c, 0x2a00000c, 0x0a00000d, 0x2b00000d, 0x2800000d, 0x0900000d,
+		0x0d00000c, 0x2c00000c, 0x2f00000c, 0x0e00000c, 0x2e00000d, 0x0f00000d, 0x0c00000d, 0x2d00000d,
+		0x0c00000e, 0x2d00000e, 0x2e00000e, 0x0f00000e, 0x2f00000f, 0x0e00000f, 0x0d00000f, 0x2c00000f,
+		0x2800000e, 0x0900000e, 0x0a00000e, 0x2b00000e, 0x0b00000f, 0x2a00000f, 0x2900000f, 0x0800000f
+	},
+	{
+		0x00000000, 0x29000010, 0x2a000020, 0x03000030, 0x2b000040, 0x02000050, 0x01000060, 0x28000070,
+		0x2c000080, 0x05000090, 0x060000a0, 0x2f0000b0, 0x070000c0, 0x2e0000d0, 0x2d0000e0, 0x040000f0,
+		0x2d000100, 0x04000110, 0x07000120, 0x2e000130, 0x06000140, 0x2f000150, 0x2c000160, 0x05000170,
+		0x01000180, 0x28000190, 0x2b0001a0, 0x020001b0, 0x2a0001c0, 0x030001d0, 0x000001e0, 0x290001f0,
+		0x2e000200, 0x07000210, 0x04000220, 0x2d000230, 0x05000240, 0x2c000250, 0x2f000260, 0x06000270,
+		0x02000280, 0x2b000290, 0x280002a0, 0x010002b0, 0x290002c0, 0x000002d0, 0x030002e0, 0x2a0002f0,
+		0x03000300, 0x2a000310, 0x29000320, 0x00000330, 0x28000340, 0x01000350, 0x02000360, 0x2b000370,
+		0x2f000380, 0x06000390, 0x050003a0, 0x2c0003b0, 0x040003c0, 0x2d0003d0, 0x2e0003e0, 0x070003f0,
+		0x2f000400, 0x06000410, 0x05000420, 0x2c000430, 0x04000440, 0x2d000450, 0x2e000460, 0x07000470,
+		0x03000480, 0x2a000490, 0x290004a0, 0x000004b0, 0x280004c0, 0x010004d0, 0x020004e0, 0x2b0004f0,
+		0x02000500, 0x2b000510, 0x28000520, 0x01000530, 0x29000540, 0x00000550, 0x03000560, 0x2a000570,
+		0x2e000580, 0x07000590, 0x040005a0, 0x2d0005b0, 0x050005c0, 0x2c0005d0, 0x2f0005e0, 0x060005f0,
+		0x01000600, 0x28000610, 0x2b000620, 0x02000630, 0x2a000640, 0x03000650, 0x00000660, 0x29000670,
+		0x2d000680, 0x04000690, 0x070006a0, 0x2e0006b0, 0x060006c0, 0x2f0006d0, 0x2c0006e0, 0x050006f0,
+		0x2c000700, 0x05000710, 0x06000720, 0x2f000730, 0x07000740, 0x2e000750, 0x2d000760, 0x04000770,
+		0x00000780, 0x29000790, 0x2a0007a0, 0x030007b0, 0x2b0007c0, 0x020007d0, 0x010007e0, 0x280007f0,
+		0x30000000, 0x19000010, 0x1a000020, 0x33000030, 0x1b000040, 0x32000050, 0x31000060, 0x18000070,
+		0x1c000080, 0x35000090, 0x360000a0, 0x1f0000b0, 0x370000c0, 0x1e0000d0, 0x1d0000e0, 0x340000f0,
+		0x1d000100, 0x34000110, 0x37000120, 0x1e000130, 0x36000140, 0x1f000150, 0x1c000160, 0x35000170,
+		0x31000180, 0x18000190, 0x1b0001a0, 0x320001b0, 0x1a0001c0, 0x330001d0, 0x300001e0, 0x190001f0,
+		0x1e000200, 0x37000210, 0x34000220, 0x1d000230, 0x35000240, 0x1c000250, 0x1f000260, 0x36000270,
+		0x32000280, 0x1b000290, 0x180002a0, 0x310002b0, 0x190002c0, 0x300002d0, 0x330002e0, 0x1a0002f0,
+		0x33000300, 0x1a000310, 0x19000320, 0x30000330, 0x18000340, 0x31000350, 0x32000360, 0x1b000370,
+		0x1f000380, 0x36000390, 0x350003a0, 0x1c0003b0, 0x340003c0, 0x1d0003d0, 0x1e0003e0, 0x370003f0,
+		0x1f000400, 0x36000410, 0x35000420, 0x1c000430, 0x34000440, 0x1d000450, 0x1e000460, 0x37000470,
+		0x33000480, 0x1a000490, 0x190004a0, 0x300004b0, 0x180004c0, 0x310004d0, 0x320004e0, 0x1b0004f0,
+		0x32000500, 0x1b000510, 0x18000520, 0x31000530, 0x19000540, 0x30000550, 0x33000560, 0x1a000570,
+		0x1e000580, 0x37000590, 0x340005a0, 0x1d0005b0, 0x350005c0, 0x1c0005d0, 0x1f0005e0, 0x360005f0,
+		0x31000600, 0x18000610, 0x1b000620, 0x32000630, 0x1a000640, 0x33000650, 0x30000660, 0x19000670,
+		0x1d000680, 0x34000690, 0x370006a0, 0x1e0006b0, 0x360006c0, 0x1f0006d0, 0x1c0006e0, 0x350006f0,
+		0x1c000700, 0x35000710, 0x36000720, 0x1f000730, 0x37000740, 0x1e000750, 0x1d000760, 0x34000770,
+		0x30000780, 0x19000790, 0x1a0007a0, 0x330007b0, 0x1b0007c0, 0x320007d0, 0x310007e0, 0x180007f0
+	},
+	{
+		0x3f000000, 0x0e000800, 0x0d001000, 0x3c001800, 0x0c002000, 0x3d002800, 0x3e003000, 0x0f003800,
+		0x0b004000, 0x3a004800, 0x39005000, 0x08005800, 0x38006000, 0x09006800, 0x0a007000, 0x3b007800,
+		0x0a008000, 0x3b008800, 0x38009000, 0x09009800, 0x3900a000, 0x0800a800, 0x0b00b000, 0x3a00b800,
+		0x3e00c000, 0x0f00c800, 0x0c00d000, 0x3d00d800, 0x0d00e000, 0x3c00e800, 0x3f00f000, 0x0e00f800,
+		0x09010000, 0x38010800, 0x3b011000, 0x0a011800, 0x3a012000, 0x0b012800, 0x08013000, 0x39013800,
+		0x3d014000, 0x0c014800, 0x0f015000, 0x3e015800, 0x0e016000, 0x3f016800, 0x3c017000, 0x0d017800,
+		0x3c018000, 0x0d018800, 0x0e019000, 0x3f019800, 0x0f01a000, 0x3e01a800, 0x3d01b000, 0x0c01b800,
+		0x0801c000, 0x3901c800, 0x3a01d000, 0x0b01d800, 0x3b01e000, 0x0a01e800, 0x0901f000, 0x3801f800,
+		0x08020000, 0x39020800, 0x3a021000, 0x0b021800, 0x3b022000, 0x0a022800, 0x09023000, 0x38023800,
+		0x3c024000, 0x0d024800, 0x0e025000, 0x3f025800, 0x0f026000, 0x3e026800, 0x3d027000, 0x0c027800,
+		0x3d028000, 0x0c028800, 0x0f029000, 0x3e029800, 0x0e02a000, 0x3f02a800, 0x3c02b000, 0x0d02b800,
+		0x0902c000, 0x3802c800, 0x3b02d000, 0x0a02d800, 0x3a02e000, 0x0b02e800, 0x0802f000, 0x3902f800,
+		0x3e030000, 0x0f030800, 0x0c031000, 0x3d031800, 0x0d032000, 0x3c032800, 0x3f033000, 0x0e033800,
+		0x0a034000, 0x3b034800, 0x38035000, 0x09035800, 0x39036000, 0x08036800, 0x0b037000, 0x3a037800,
+		0x0b038000, 0x3a038800, 0x39039000, 0x08039800, 0x3803a000, 0x0903a800, 0x0a03b000, 0x3b03b800,
+		0x3f03c000, 0x0e03c800, 0x0d03d000, 0x3c03d800, 0x0c03e000, 0x3d03e800, 0x3e03f000, 0x0f03f800,
+		0x1f000000, 0x2e000800, 0x2d001000, 0x1c001800, 0x2c002000, 0x1d002800, 0x1e003000, 0x2f003800,
+		0x2b004000, 0x1a004800, 0x19005000, 0x28005800, 0x18006000, 0x29006800, 0x2a007000, 0x1b007800,
+		0x2a008000, 0x1b008800, 0x18009000, 0x29009800, 0x1900a000, 0x2800a800, 0x2b00b000, 0x1a00b800,
+		0x1e00c000, 0x2f00c800, 0x2c00d000, 0x1d00d800, 0x2d00e000, 0x1c00e800, 0x1f00f000, 0x2e00f800,
+		0x29010000, 0x18010800, 0x1b011000, 0x2a011800, 0x1a012000, 0x2b012800, 0x28013000, 0x19013800,
+		0x1d014000, 0x2c014800, 0x2f015000, 0x1e015800, 0x2e016000, 0x1f016800, 0x1c017000, 0x2d017800,
+		0x1c018000, 0x2d018800, 0x2e019000, 0x1f019800, 0x2f01a000, 0x1e01a800, 0x1d01b000, 0x2c01b800,
+		0x2801c000, 0x1901c800, 0x1a01d000, 0x2b01d800, 0x1b01e000, 0x2a01e800, 0x2901f000, 0x1801f800,
+		0x28020000, 0x19020800, 0x1a021000, 0x2b021800, 0x1b022000, 0x2a022800, 0x29023000, 0x18023800,
+		0x1c024000, 0x2d024800, 0x2e025000, 0x1f025800, 0x2f026000, 0x1e026800, 0x1d027000, 0x2c027800,
+		0x1d028000, 0x2c028800, 0x2f029000, 0x1e029800, 0x2e02a000, 0x1f02a800, 0x1c02b000, 0x2d02b800,
+		0x2902c000, 0x1802c800, 0x1b02d000, 0x2a02d800, 0x1a02e000, 0x2b02e800, 0x2802f000, 0x1902f800,
+		0x1e030000, 0x2f030800, 0x2c031000, 0x1d031800, 0x2d032000, 0x1c032800, 0x1f033000, 0x2e033800,
+		0x2a034000, 0x1b034800, 0x18035000, 0x29035800, 0x19036000, 0x28036800, 0x2b037000, 0x1a037800,
+		0x2b038000, 0x1a038800, 0x19039000, 0x28039800, 0x1803a000, 0x2903a800, 0x2a03b000, 0x1b03b800,
+		0x1f03c000, 0x2e03c800, 0x2d03d000, 0x1c03d800, 0x2c03e000, 0x1d03e800, 0x1e03f000, 0x2f03f800
+	}
+};
+
 #endif
@@ -54,50 +54,8 @@ typedef enum {
 	HEBREW
 } g0_charsets_t;
 
-struct {
-	uint8_t id;
-	g0_charsets_t charset;
-	const char *name;
-} const LANGUAGES[] = {
-	{ 0x00, LATIN,     "English" },
-	{ 0x01, LATIN,     "French" },
-	{ 0x02, LATIN,     "Swedish/Finnish/Hungarian" },
-	{ 0x03, LATIN,     "Czech/Slovak" },
-	{ 0x04, LATIN,     "German" },
-	{ 0x05, LATIN,     "Portuguese/Spanish" },
-	{ 0x06, LATIN,     "Italian" },
-	{ 0x08, LATIN,     "Polish" },
-	{ 0x09, LATIN,     "French" },
-	{ 0x0a, LATIN,     "Swedish/Finnish/Hungarian" },
-	{ 0x0b, LATIN,     "Czech/Slovak" },
-	{ 0x0c, LATIN,     "German" },
-	{ 0x0e, LATIN,     "Italian" },
-	{ 0x10, LATIN,     "English" },
-	{ 0x11, LATIN,     "French" },
-	{ 0x12, LATIN,     "Swedish/Finnish/Hungarian" },
-	{ 0x13, LATIN,     "Turkish" },
-	{ 0x14, LATIN,     "German" },
-	{ 0x15, LATIN,     "Portuguese/Spanish" },
-	{ 0x16, LATIN,     "Italian" },
-	{ 0x1d, LATIN,     "Serbian/Croatian/Slovenian (Latin)" },
-	{ 0x20, CYRILLIC1, "Serbian/Croatian (Cyrillic)" },
-	{ 0x21, CYRILLIC2, "Russian, Bulgarian" },
-	{ 0x22, LATIN,     "Estonian" },
-	{ 0x23, LATIN,     "Czech/Slovak" },
-	{ 0x24, LATIN,     "German" },
-	{ 0x25, CYRILLIC3, "Ukrainian" },
-	{ 0x26, LATIN,     "Lettish/Lithuanian" },
-	{ 0x33, LATIN,     "Turkish" },
-	{ 0x37, GREEK,     "Greek" },
-	{ 0x40, LATIN,     "English" },
-	{ 0x41, LATIN,     "French" },
-	{ 0x47, ARABIC,    "Arabic" },
-	{ 0x55, HEBREW,    "Hebrew" },
-	{ 0x57, ARABIC,    "Arabic" }
-};
-
 // G0 charsets
-uint16_t G0[5][96] = {
+static const uint16_t G0[5][96] = {
 	{ // Latin G0 Primary Set
 		0x0020, 0x0021, 0x0022, 0x00a3, 0x0024, 0x0025, 0x0026, 0x0027, 0x0028, 0x0029, 0x002a, 0x002b, 0x002c, 0x002d, 0x002e, 0x002f,
 		0x0030, 0x0031, 0x0032, 0x0033, 0x0034, 0x0035, 0x0036, 0x0037, 0x0038, 0x0039, 0x003a, 0x003b, 0x003c, 0x003d, 0x003e, 0x003f,
@@ -139,40 +97,191 @@ uint16_t G0[5][96] = {
 		0x03c0, 0x03c1, 0x03c2, 0x03c3, 0x03c4, 0x03c5, 0x03c6, 0x03c7, 0x03c8, 0x03c9, 0x03ca, 0x03cb, 0x03cc, 0x03cd, 0x03ce, 0x03cf
 	}
 	//{ // Arabic G0 Primary Set
-	//},
-	//{ // Hebrew G0 Primary Set
 	//}
 };
 
-// Latin National Option Sub-sets
-const uint16_t G0_LATIN_NATIONAL_SUBSETS[8][13] = {
+// Hebrew G0 Primary Set
+static const uint16_t G0_HEBREW[96] = {
+	0x0020, 0x0021, 0x0022, 0x00a3, 0x0024, 0x0025, 0x0026, 0x0027, 0x0028, 0x0029, 0x002a, 0x002b, 0x002c, 0x002d, 0x002e, 0x002f,
+	0x0030, 0x0031, 0x0032, 0x0033, 0x0034, 0x0035, 0x0036, 0x0037, 0x0038, 0x0039, 0x003a, 0x003b, 0x003c, 0x003d, 0x003e, 0x003f,
+	0x0040, 0x0041, 0x0042, 0x0043, 0x0044, 0x0045, 0x0046, 0x0047, 0x0048, 0x0049, 0x004a, 0x004b, 0x004c, 0x004d, 0x004e, 0x004f,
+	0x0050, 0x0051, 0x0052, 0x0053, 0x0054, 0x0055, 0x0056, 0x0057, 0x0058, 0x0059, 0x005a, 0x2190, 0x00bd, 0x2192, 0x2191, 0x0023,
+	0x05d0, 0x05d1, 0x05d2, 0x05d3, 0x05d4, 0x05d5, 0x05d6, 0x05d7, 0x05d8, 0x05d9, 0x05da, 0x05db, 0x05dc, 0x05dd, 0x05de, 0x05df,
+	0x05e0, 0x05e1, 0x05e2, 0x05e3, 0x05e4, 0x05e5, 0x05e6, 0x05e7, 0x05e8, 0x05e9, 0x05ea, 0x20aa, 0x2016, 0x00be, 0x00f7, 0x007f
+};
+
+// Latin G0 Primary Set with National Option Sub-sets applied (ETS 300 706, chapter 15.2, table 36), selected
+// by G0_LATIN_* index; sub-sets 000 -- 111 are those of page header bits C12 -- C14 in default (Latin) group
+typedef enum {
+	G0_LATIN_ENGLISH = 0,
+	G0_LATIN_FRENCH,
+	G0_LATIN_SWEDISH,
+	G0_LATIN_CZECH,
+	G0_LATIN_GERMAN,
+	G0_LATIN_PORTUGUESE,
+	G0_LATIN_ITALIAN,
+	G0_LATIN_ROMANIAN,
+	G0_LATIN_POLISH,
+	G0_LATIN_TURKISH,
+	G0_LATIN_SERBIAN,
+	G0_LATIN_ESTONIAN,
+	G0_LATIN_LETTISH,
+	G0_LATIN_SUBSETS_COUNT
+} g0_latin_subset_t;
+
+static const uint16_t G0_LATIN_NATIONAL[G0_LATIN_SUBSETS_COUNT][96] = {
 	{ // 000 = English
-		0x00a3, 0x0024, 0x0040, 0x00ab, 0x00bd, 0x00bb, 0x005e, 0x0023, 0x002d, 0x00bc, 0x00a6, 0x00be, 0x00f7
+		0x0020, 0x0021, 0x0022, 0x00a3, 0x0024, 0x0025, 0x0026, 0x0027, 0x0028, 0x0029, 0x002a, 0x002b, 0x002c, 0x002d, 0x002e, 0x002f,
+		0x0030, 0x0031, 0x0032, 0x0033, 0x0034, 0x0035, 0x0036, 0x0037, 0x0038, 0x0039, 0x003a, 0x003b, 0x003c, 0x003d, 0x003e, 0x003f,
+		0x0040, 0x0041, 0x0042, 0x0043, 0x0044, 0x0045, 0x0046, 0x0047, 0x0048, 0x0049, 0x004a, 0x004b, 0x004c, 0x004d, 0x004e, 0x004f,
+		0x0050, 0x0051, 0x0052, 0x0053, 0x0054, 0x0055, 0x0056, 0x0057, 0x0058, 0x0059, 0x005a, 0x00ab, 0x00bd, 0x00bb, 0x005e, 0x0023,
+		0x002d, 0x0061, 0x0062, 0x0063, 0x0064, 0x0065, 0x0066, 0x0067, 0x0068, 0x0069, 0x006a, 0x006b, 0x006c, 0x006d, 0x006e, 0x006f,
+		0x0070, 0x0071, 0x0072, 0x0073, 0x0074, 0x0075, 0x0076, 0x0077, 0x0078, 0x0079, 0x007a, 0x00bc, 0x00a6, 0x00be, 0x00f7, 0x007f
 	},
 	{ // 001 = French
-		0x00e9, 0x00ef, 0x00e0, 0x00eb, 0x00ea, 0x00f9, 0x00ee, 0x0023, 0x00e8, 0x00e2, 0x00f4, 0x00fb, 0x00e7
+		0x0020, 0x0021, 0x0022, 0x00e9, 0x00ef, 0x0025, 0x0026, 0x0027, 0x0028, 0x0029, 0x002a, 0x002b, 0x002c, 0x002d, 0x002e, 0x002f,
+		0x0030, 0x0031, 0x0032, 0x0033, 0x0034, 0x0035, 0x0036, 0x0037, 0x0038, 0x0039, 0x003a, 0x003b, 0x003c, 0x003d, 0x003e, 0x003f,
+		0x00e0, 0x0041, 0x0042, 0x0043, 0x0044, 0x0045, 0x0046, 0x0047, 0x0048, 0x0049, 0x004a, 0x004b, 0x004c, 0x004d, 0x004e, 0x004f,
+		0x0050, 0x0051, 0x0052, 0x0053, 0x0054, 0x0055, 0x0056, 0x0057, 0x0058, 0x0059, 0x005a, 0x00eb, 0x00ea, 0x00f9, 0x00ee, 0x0023,
+		0x00e8, 0x0061, 0x0062, 0x0063, 0x0064, 0x0065, 0x0066, 0x0067, 0x0068, 0x0069, 0x006a, 0x006b, 0x006c, 0x006d, 0x006e, 0x006f,
+		0x0070, 0x0071, 0x0072, 0x0073, 0x0074, 0x0075, 0x0076, 0x0077, 0x0078, 0x0079, 0x007a, 0x00e2, 0x00f4, 0x00fb, 0x00e7, 0x007f
 	},
 	{ // 010 = Swedish, Finnish, Hungarian
-		0x0023, 0x00a4, 0x00c9, 0x00c4, 0x00d6, 0x00c5, 0x00dc, 0x005f, 0x00e9, 0x00e4, 0x00f6, 0x00e5, 0x00fc
+		0x0020, 0x0021, 0x0022, 0x0023, 0x00a4, 0x0025, 0x0026, 0x0027, 0x0028, 0x0029, 0x002a, 0x002b, 0x002c, 0x002d, 0x002e, 0x002f,
+		0x0030, 0x0031, 0x0032, 0x0033, 0x0034, 0x0035, 0x0036, 0x0037, 0x0038, 0x0039, 0x003a, 0x003b, 0x003c, 0x003d, 0x003e, 0x003f,
+		0x00c9, 0x0041, 0x0042, 0x0043, 0x0044, 0x0045, 0x0046, 0x0047, 0x0048, 0x0049, 0x004a, 0x004b, 0x004c, 0x004d, 0x004e, 0x004f,
+		0x0050, 0x0051, 0x0052, 0x0053, 0x0054, 0x0055, 0x0056, 0x0057, 0x0058, 0x0059, 0x005a, 0x00c4, 0x00d6, 0x00c5, 0x00dc, 0x005f,
+		0x00e9, 0x0061, 0x0062, 0x0063, 0x0064, 0x0065, 0x0066, 0x0067, 0x0068, 0x0069, 0x006a, 0x006b, 0x006c, 0x006d, 0x006e, 0x006f,
+		0x0070, 0x0071, 0x0072, 0x0073, 0x0074, 0x0075, 0x0076, 0x0077, 0x0078, 0x0079, 0x007a, 0x00e4, 0x00f6, 0x00e5, 0x00fc, 0x007f
 	},
 	{ // 011 = Czech, Slovak
-		0x0023, 0x016f, 0x010d, 0x0165, 0x017e, 0x00fd, 0x00ed, 0x0159, 0x00e9, 0x00e1, 0x011b, 0x00fa, 0x0161
+		0x0020, 0x0021, 0x0022, 0x0023, 0x016f, 0x0025, 0x0026, 0x0027, 0x0028, 0x0029, 0x002a, 0x002b, 0x002c, 0x002d, 0x002e, 0x002f,
+		0x0030, 0x0031, 0x0032, 0x0033, 0x0034, 0x0035, 0x0036, 0x0037, 0x0038, 0x0039, 0x003a, 0x003b, 0x003c, 0x003d, 0x003e, 0x003f,
+		0x010d, 0x0041, 0x0042, 0x0043, 0x0044, 0x0045, 0x0046, 0x0047, 0x0048, 0x0049, 0x004a, 0x004b, 0x004c, 0x004d, 0x004e, 0x004f,
+		0x0050, 0x0051, 0x0052, 0x0053, 0x0054, 0x0055, 0x0056, 0x0057, 0x0058, 0x0059, 0x005a, 0x0165, 0x017e, 0x00fd, 0x00ed, 0x0159,
+		0x00e9, 0x0061, 0x0062, 0x0063, 0x0064, 0x0065, 0x0066, 0x0067, 0x0068, 0x0069, 0x006a, 0x006b, 0x006c, 0x006d, 0x006e, 0x006f,
+		0x0070, 0x0071, 0x0072, 0x0073, 0x0074, 0x0075, 0x0076, 0x0077, 0x0078, 0x0079, 0x007a, 0x00e1, 0x011b, 0x00fa, 0x0161, 0x007f
 	},
 	{ // 100 = German
-		0x0023, 0x0024, 0x00a7, 0x00c4, 0x00d6, 0x00dc, 0x005e, 0x005f, 0x00b0, 0x00e4, 0x00f6, 0x00fc, 0x00df
+		0x0020, 0x0021, 0x0022, 0x0023, 0x0024, 0x0025, 0x0026, 0x0027, 0x0028, 0x0029, 0x002a, 0x002b, 0x002c, 0x002d, 0x002e, 0x002f,
+		0x0030, 0x0031, 0x0032, 0x0033, 0x0034, 0x0035, 0x0036, 0x0037, 0x0038, 0x0039, 0x003a, 0x003b, 0x003c, 0x003d, 0x003e, 0x003f,
+		0x00a7, 0x0041, 0x0042, 0x0043, 0x0044, 0x0045, 0x0046, 0x0047, 0x0048, 0x0049, 0x004a, 0x004b, 0x004c, 0x004d, 0x004e, 0x004f,
+		0x0050, 0x0051, 0x0052, 0x0053, 0x0054, 0x0055, 0x0056, 0x0057, 0x0058, 0x0059, 0x005a, 0x00c4, 0x00d6, 0x00dc, 0x005e, 0x005f,
+		0x00b0, 0x0061, 0x0062, 0x0063, 0x0064, 0x0065, 0x0066, 0x0067, 0x0068, 0x0069, 0x006a, 0x006b, 0x006c, 0x006d, 0x006e, 0x006f,
+		0x0070, 0x0071, 0x0072, 0x0073, 0x0074, 0x0075, 0x0076, 0x0077, 0x0078, 0x0079, 0x007a, 0x00e4, 0x00f6, 0x00fc, 0x00df, 0x007f
 	},
 	{ // 101 = Portuguese, Spanish
-		0x00e7, 0x0024, 0x00a1, 0x00e1, 0x00e9, 0x00ed, 0x00f3, 0x00fa, 0x00bf, 0x00fc, 0x00f1, 0x00e8, 0x00e0
+		0x0020, 0x0021, 0x0022, 0x00e7, 0x0024, 0x0025, 0x0026, 0x0027, 0x0028, 0x0029, 0x002a, 0x002b, 0x002c, 0x002d, 0x002e, 0x002f,
+		0x0030, 0x0031, 0x0032, 0x0033, 0x0034, 0x0035, 0x0036, 0x0037, 0x0038, 0x0039, 0x003a, 0x003b, 0x003c, 0x003d, 0x003e, 0x003f,
+		0x00a1, 0x0041, 0x0042, 0x0043, 0x0044, 0x0045, 0x0046, 0x0047, 0x0048, 0x0049, 0x004a, 0x004b, 0x004c, 0x004d, 0x004e, 0x004f,
+		0x0050, 0x0051, 0x0052, 0x0053, 0x0054, 0x0055, 0x0056, 0x0057, 0x0058, 0x0059, 0x005a, 0x00e1, 0x00e9, 0x00ed, 0x00f3, 0x00fa,
+		0x00bf, 0x0061, 0x0062, 0x0063, 0x0064, 0x0065, 0x0066, 0x0067, 0x0068, 0x0069, 0x006a, 0x006b, 0x006c, 0x006d, 0x006e, 0x006f,
+		0x0070, 0x0071, 0x0072, 0x0073, 0x0074, 0x0075, 0x0076, 0x0077, 0x0078, 0x0079, 0x007a, 0x00fc, 0x00f1, 0x00e8, 0x00e0, 0x007f
 	},
 	{ // 110 = Italian
-		0x00a3, 0x0024, 0x00e9, 0x00b0, 0x00e7, 0x00bb, 0x005e, 0x0023, 0x00f9, 0x00e0, 0x00f2, 0x00e8, 0x00ec
+		0x0020, 0x0021, 0x0022, 0x00a3, 0x0024, 0x0025, 0x0026, 0x0027, 0x0028, 0x0029, 0x002a, 0x002b, 0x002c, 0x002d, 0x002e, 0x002f,
+		0x0030, 0x0031, 0x0032, 0x0033, 0x0034, 0x0035, 0x0036, 0x0037, 0x0038, 0x0039, 0x003a, 0x003b, 0x003c, 0x003d, 0x003e, 0x003f,
+		0x00e9, 0x0041, 0x0042, 0x0043, 0x0044, 0x0045, 0x0046, 0x0047, 0x0048, 0x0049, 0x004a, 0x004b, 0x004c, 0x004d, 0x004e, 0x004f,
+		0x0050, 0x0051, 0x0052, 0x0053, 0x0054, 0x0055, 0x0056, 0x0057, 0x0058, 0x0059, 0x005a, 0x00b0, 0x00e7, 0x00bb, 0x005e, 0x0023,
+		0x00f9, 0x0061, 0x0062, 0x0063, 0x0064, 0x0065, 0x0066, 0x0067, 0x0068, 0x0069, 0x006a, 0x006b, 0x006c, 0x006d, 0x006e, 0x006f,
+		0x0070, 0x0071, 0x0072, 0x0073, 0x0074, 0x0075, 0x0076, 0x0077, 0x0078, 0x0079, 0x007a, 0x00e0, 0x00f2, 0x00e8, 0x00ec, 0x007f
 	},
 	{ // 111 = Romanian
-		0x0023, 0x00a4, 0x0162, 0x00c2, 0x015e, 0x0102, 0x00ce, 0x0131, 0x0163, 0x00e2, 0x015f, 0x0103, 0x00ee
+		0x0020, 0x0021, 0x0022, 0x0023, 0x00a4, 0x0025, 0x0026, 0x0027, 0x0028, 0x0029, 0x002a, 0x002b, 0x002c, 0x002d, 0x002e, 0x002f,
+		0x0030, 0x0031, 0x0032, 0x0033, 0x0034, 0x0035, 0x0036, 0x0037, 0x0038, 0x0039, 0x003a, 0x003b, 0x003c, 0x003d, 0x003e, 0x003f,
+		0x0162, 0x0041, 0x0042, 0x0043, 0x0044, 0x0045, 0x0046, 0x0047, 0x0048, 0x0049, 0x004a, 0x004b, 0x004c, 0x004d, 0x004e, 0x004f,
+		0x0050, 0x0051, 0x0052, 0x0053, 0x0054, 0x0055, 0x0056, 0x0057, 0x0058, 0x0059, 0x005a, 0x00c2, 0x015e, 0x0102, 0x00ce, 0x0131,
+		0x0163, 0x0061, 0x0062, 0x0063, 0x0064, 0x0065, 0x0066, 0x0067, 0x0068, 0x0069, 0x006a, 0x006b, 0x006c, 0x006d, 0x006e, 0x006f,
+		0x0070, 0x0071, 0x0072, 0x0073, 0x0074, 0x0075, 0x0076, 0x0077, 0x0078, 0x0079, 0x007a, 0x00e2, 0x015f, 0x0103, 0x00ee, 0x007f
+	},
+	{ // Polish
+		0x0020, 0x0021, 0x0022, 0x0023, 0x0144, 0x0025, 0x0026, 0x0027, 0x0028, 0x0029, 0x002a, 0x002b, 0x002c, 0x002d, 0x002e, 0x002f,
+		0x0030, 0x0031, 0x0032, 0x0033, 0x0034, 0x0035, 0x0036, 0x0037, 0x0038, 0x0039, 0x003a, 0x003b, 0x003c, 0x003d, 0x003e, 0x003f,
+		0x0105, 0x0041, 0x0042, 0x0043, 0x0044, 0x0045, 0x0046, 0x0047, 0x0048, 0x0049, 0x004a, 0x004b, 0x004c, 0x004d, 0x004e, 0x004f,
+		0x0050, 0x0051, 0x0052, 0x0053, 0x0054, 0x0055, 0x0056, 0x0057, 0x0058, 0x0059, 0x005a, 0x017b, 0x015a, 0x0141, 0x0107, 0x00f3,
+		0x0119, 0x0061, 0x0062, 0x0063, 0x0064, 0x0065, 0x0066, 0x0067, 0x0068, 0x0069, 0x006a, 0x006b, 0x006c, 0x006d, 0x006e, 0x006f,
+		0x0070, 0x0071, 0x0072, 0x0073, 0x0074, 0x0075, 0x0076, 0x0077, 0x0078, 0x0079, 0x007a, 0x017c, 0x015b, 0x0142, 0x017a, 0x007f
+	},
+	{ // Turkish
+		0x0020, 0x0021, 0x0022, 0x20a4, 0x011f, 0x0025, 0x0026, 0x0027, 0x0028, 0x0029, 0x002a, 0x002b, 0x002c, 0x002d, 0x002e, 0x002f,
+		0x0030, 0x0031, 0x0032, 0x0033, 0x0034, 0x0035, 0x0036, 0x0037, 0x0038, 0x0039, 0x003a, 0x003b, 0x003c, 0x003d, 0x003e, 0x003f,
+		0x0130, 0x0041, 0x0042, 0x0043, 0x0044, 0x0045, 0x0046, 0x0047, 0x0048, 0x0049, 0x004a, 0x004b, 0x004c, 0x004d, 0x004e, 0x004f,
+		0x0050, 0x0051, 0x0052, 0x0053, 0x0054, 0x0055, 0x0056, 0x0057, 0x0058, 0x0059, 0x005a, 0x015e, 0x00d6, 0x00c7, 0x00dc, 0x011e,
+		0x0131, 0x0061, 0x0062, 0x0063, 0x0064, 0x0065, 0x0066, 0x0067, 0x0068, 0x0069, 0x006a, 0x006b, 0x006c, 0x006d, 0x006e, 0x006f,
+		0x0070, 0x0071, 0x0072, 0x0073, 0x0074, 0x0075, 0x0076, 0x0077, 0x0078, 0x0079, 0x007a, 0x015f, 0x00f6, 0x00e7, 0x00fc, 0x007f
+	},
+	{ // Serbian, Croatian, Slovenian
+		0x0020, 0x0021, 0x0022, 0x0023, 0x00cb, 0x0025, 0x0026, 0x0027, 0x0028, 0x0029, 0x002a, 0x002b, 0x002c, 0x002d, 0x002e, 0x002f,
+		0x0030, 0x0031, 0x0032, 0x0033, 0x0034, 0x0035, 0x0036, 0x0037, 0x0038, 0x0039, 0x003a, 0x003b, 0x003c, 0x003d, 0x003e, 0x003f,
+		0x010c, 0x0041, 0x0042, 0x0043, 0x0044, 0x0045, 0x0046, 0x0047, 0x0048, 0x0049, 0x004a, 0x004b, 0x004c, 0x004d, 0x004e, 0x004f,
+		0x0050, 0x0051, 0x0052, 0x0053, 0x0054, 0x0055, 0x0056, 0x0057, 0x0058, 0x0059, 0x005a, 0x0106, 0x017d, 0x0110, 0x0160, 0x00eb,
+		0x010d, 0x0061, 0x0062, 0x0063, 0x0064, 0x0065, 0x0066, 0x0067, 0x0068, 0x0069, 0x006a, 0x006b, 0x006c, 0x006d, 0x006e, 0x006f,
+		0x0070, 0x0071, 0x0072, 0x0073, 0x0074, 0x0075, 0x0076, 0x0077, 0x0078, 0x0079, 0x007a, 0x0107, 0x017e, 0x0111, 0x0161, 0x007f
+	},
+	{ // Estonian
+		0x0020, 0x0021, 0x0022, 0x0023, 0x00f5, 0x0025, 0x0026, 0x0027, 0x0028, 0x0029, 0x002a, 0x002b, 0x002c, 0x002d, 0x002e, 0x002f,
+		0x0030, 0x0031, 0x0032, 0x0033, 0x0034, 0x0035, 0x0036, 0x0037, 0x0038, 0x0039, 0x003a, 0x003b, 0x003c, 0x003d, 0x003e, 0x003f,
+		0x0160, 0x0041, 0x0042, 0x0043, 0x0044, 0x0045, 0x0046, 0x0047, 0x0048, 0x0049, 0x004a, 0x004b, 0x004c, 0x004d, 0x004e, 0x004f,
+		0x0050, 0x0051, 0x0052, 0x0053, 0x0054, 0x0055, 0x0056, 0x0057, 0x0058, 0x0059, 0x005a, 0x00c4, 0x00d6, 0x017d, 0x00dc, 0x00d5,
+		0x0161, 0x0061, 0x0062, 0x0063, 0x0064, 0x0065, 0x0066, 0x0067, 0x0068, 0x0069, 0x006a, 0x006b, 0x006c, 0x006d, 0x006e, 0x006f,
+		0x0070, 0x0071, 0x0072, 0x0073, 0x0074, 0x0075, 0x0076, 0x0077, 0x0078, 0x0079, 0x007a, 0x00e4, 0x00f6, 0x017e, 0x00fc, 0x007f
+	},
+	{ // Lettish, Lithuanian
+		0x0020, 0x0021, 0x0022, 0x0023, 0x0024, 0x0025, 0x0026, 0x0027, 0x0028, 0x0029, 0x002a, 0x002b, 0x002c, 0x002d, 0x002e, 0x002f,
+		0x0030, 0x0031, 0x0032, 0x0033, 0x0034, 0x0035, 0x0036, 0x0037, 0x0038, 0x0039, 0x003a, 0x003b, 0x003c, 0x003d, 0x003e, 0x003f,
+		0x0160, 0x0041, 0x0042, 0x0043, 0x0044, 0x0045, 0x0046, 0x0047, 0x0048, 0x0049, 0x004a, 0x004b, 0x004c, 0x004d, 0x004e, 0x004f,
+		0x0050, 0x0051, 0x0052, 0x0053, 0x0054, 0x0055, 0x0056, 0x0057, 0x0058, 0x0059, 0x005a, 0x0117, 0x0119, 0x017d, 0x010d, 0x016b,
+		0x0161, 0x0061, 0x0062, 0x0063, 0x0064, 0x0065, 0x0066, 0x0067, 0x0068, 0x0069, 0x006a, 0x006b, 0x006c, 0x006d, 0x006e, 0x006f,
+		0x0070, 0x0071, 0x0072, 0x0073, 0x0074, 0x0075, 0x0076, 0x0077, 0x0078, 0x0079, 0x007a, 0x0105, 0x0173, 0x017e, 0x012f, 0x007f
 	}
 };
 
-const uint16_t G2[1][96] = {
+static const struct {
+	uint8_t id;
+	g0_charsets_t charset;
+	// Latin national option sub-set, if charset is LATIN
+	uint8_t subset;
+	const char *name;
+} LANGUAGES[] = {
+	{ 0x00, LATIN,     G0_LATIN_ENGLISH,    "English" },
+	{ 0x01, LATIN,     G0_LATIN_FRENCH,     "French" },
+	{ 0x02, LATIN,     G0_LATIN_SWEDISH,    "Swedish/Finnish/Hungarian" },
+	{ 0x03, LATIN,     G0_LATIN_CZECH,      "Czech/Slovak" },
+	{ 0x04, LATIN,     G0_LATIN_GERMAN,     "German" },
+	{ 0x05, LATIN,     G0_LATIN_PORTUGUESE, "Portuguese/Spanish" },
+	{ 0x06, LATIN,     G0_LATIN_ITALIAN,    "Italian" },
+	{ 0x08, LATIN,     G0_LATIN_POLISH,     "Polish" },
+	{ 0x09, LATIN,     G0_LATIN_FRENCH,     "French" },
+	{ 0x0a, LATIN,     G0_LATIN_SWEDISH,    "Swedish/Finnish/Hungarian" },
+	{ 0x0b, LATIN,     G0_LATIN_CZECH,      "Czech/Slovak" },
+	{ 0x0c, LATIN,     G0_LATIN_GERMAN,     "German" },
+	{ 0x0e, LATIN,     G0_LATIN_ITALIAN,    "Italian" },
+	{ 0x10, LATIN,     G0_LATIN_ENGLISH,    "English" },
+	{ 0x11, LATIN,     G0_LATIN_FRENCH,     "French" },
+	{ 0x12, LATIN,     G0_LATIN_SWEDISH,    "Swedish/Finnish/Hungarian" },
+	{ 0x13, LATIN,     G0_LATIN_TURKISH,    "Turkish" },
+	{ 0x14, LATIN,     G0_LATIN_GERMAN,     "German" },
+	{ 0x15, LATIN,     G0_LATIN_PORTUGUESE, "Portuguese/Spanish" },
+	{ 0x16, LATIN,     G0_LATIN_ITALIAN,    "Italian" },
+	{ 0x1d, LATIN,     G0_LATIN_SERBIAN,    "Serbian/Croatian/Slovenian (Latin)" },
+	{ 0x1f, LATIN,     G0_LATIN_ROMANIAN,   "Romanian" },
+	{ 0x20, CYRILLIC1, G0_LATIN_ENGLISH,    "Serbian/Croatian (Cyrillic)" },
+	{ 0x21, CYRILLIC2, G0_LATIN_ENGLISH,    "Russian, Bulgarian" },
+	{ 0x22, LATIN,     G0_LATIN_ESTONIAN,   "Estonian" },
+	{ 0x23, LATIN,     G0_LATIN_CZECH,      "Czech/Slovak" },
+	{ 0x24, LATIN,     G0_LATIN_GERMAN,     "German" },
+	{ 0x25, CYRILLIC3, G0_LATIN_ENGLISH,    "Ukrainian" },
+	{ 0x26, LATIN,     G0_LATIN_LETTISH,    "Lettish/Lithuanian" },
+	{ 0x33, LATIN,     G0_LATIN_TURKISH,    "Turkish" },
+	{ 0x37, GREEK,     G0_LATIN_ENGLISH,    "Greek" },
+	{ 0x40, LATIN,     G0_LATIN_ENGLISH,    "English" },
+	{ 0x41, LATIN,     G0_LATIN_FRENCH,     "French" },
+	{ 0x47, ARABIC,    G0_LATIN_ENGLISH,    "Arabic" },
+	{ 0x55, HEBREW,    G0_LATIN_ENGLISH,    "Hebrew" },
+	{ 0x57, ARABIC,    G0_LATIN_ENGLISH,    "Arabic" }
+};
+
+static const uint16_t G2[1][96] = {
 	{ // Latin G2 Supplementary Set
 		0x0020, 0x00a1, 0x00a2, 0x00a3, 0x0024, 0x00a5, 0x0023, 0x00a7, 0x00a4, 0x2018, 0x201c, 0x00ab, 0x2190, 0x2191, 0x2192, 0x2193,
 		0x00b0, 0x00b1, 0x00b2, 0x00b3, 0x00d7, 0x00b5, 0x00b6, 0x00b7, 0x00f7, 0x2019, 0x201d, 0x00bb, 0x00bc, 0x00bd, 0x00be, 0x00bf,
@@ -189,7 +298,7 @@ const uint16_t G2[1][96] = {
 //	}
 };
 
-const uint16_t G2_ACCENTS[15][52] = {
+static const uint16_t G2_ACCENTS[15][52] = {
 	// A B C D E F G H I J K L M N O P Q R S T U V W X Y Z a b c d e f g h i j k l m n o p q r s t u v w x y z
 	{ // grave
 		0x00c0, 0x0000, 0x0000, 0x0000, 0x00c8, 0x0000, 0x0000, 0x0000, 0x00cc, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x00d2, 0x0000,
@@ -286,7 +395,7 @@ typedef enum {
 	TRANSMISSION_MODE_SERIAL
 } transmission_mode_t;
 
-const char* COLOURS[8] = {
+static const char *const COLOURS[8] = {
 	// black,  red,       green,     yellow,    blue,      magenta,   cyan,      white
 	"#000000", "#ff0000", "#00ff00", "#ffff00", "#0000ff", "#ff00ff", "#00ffff", "#ffffff"
 };
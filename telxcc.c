@@ -40,10 +40,8 @@ telxcc conforms to ETSI 300 706 Presentation Level 1.5:
 	the character repertoire is extended via packets X/26.
 
 Algorithm workflow:
-	main (processing TS)
-	process_pes_packet (processing PS)
-	process_telx_packet (processing teletext stream)
-	process_page (processing teletext data)
+	main (reading TS, see libtelxcc.c for decoder itself)
+	caption_callback (writing SRT frames)
 
 Further Documentation:
 	ISO/IEC 13818-1 (Information technology - Generic coding of moving pictures and associated audio information: Systems):
@@ -59,545 +57,2864 @@ Further Documentation:
 		http://webstore.iec.ch/preview/info_isoiec6937%7Bed3.0%7Den.pdf
 */
 
+#define _POSIX_C_SOURCE 200809L
+#if defined(__linux__)
+// recvmmsg()
+#define _GNU_SOURCE
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
 #include <signal.h>
-#include <time.h>
 #include <inttypes.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <dirent.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#endif
+// io_uring is used by raw syscalls, no library needed
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#define IO_URING
+#endif
+#endif
+
+#include "telxcc.h"
+
+// size of a TS packet in bytes
+#define TS_PACKET_SIZE TELXCC_TS_PACKET_SIZE
+
+// size of an input block in bytes; multiple of both TS packet size and memory page size
+#define INPUT_BLOCK_SIZE (TS_PACKET_SIZE * 4096)
+
+// size of data pushed to decoder at once; PES payload within is not copied (see libtelxcc.c), graceful exit stops
+// processing after it
+#define PUSH_SIZE (TS_PACKET_SIZE * 256)
+
+// maximum number of outputs, one per page of each stream
+#define MAX_OUTPUTS (TELXCC_MAX_STREAMS * TELXCC_MAX_PAGES)
+
+// maximum number of worker threads
+#define MAX_WORKERS 256
+
+// minimal size of an input part decoded on its own in split mode
+#define MIN_SPLIT_PART_SIZE (TS_PACKET_SIZE * 8192)
+
+// asynchronous input: number of reads in flight and their size; multiple of O_DIRECT alignment,
+// each block has headroom before it for incomplete TS packet of the previous one
+#define ASYNC_DEPTH 8
+#define ASYNC_BLOCK_SIZE (4 * 1024 * 1024)
+#define ASYNC_ALIGNMENT 4096
+
+// UDP input: datagrams received by one syscall, max. datagram size (jumbo frame);
+// a batch fits into INPUT_BLOCK_SIZE behind carry
+#define UDP_BATCH 64
+#define UDP_DATAGRAM_SIZE 9216
+
+// live UDP input counters
+typedef struct {
+	uint64_t datagrams;
+	uint64_t rtp_datagrams;
+	// datagrams missing in RTP sequence
+	uint64_t rtp_lost;
+	// datagrams dropped by kernel (receive buffer full), if kernel reports it
+	uint64_t kernel_drops;
+	// datagrams larger than UDP_DATAGRAM_SIZE, or not RTP on rtp:// input
+	uint64_t malformed;
+} udp_stats_t;
+
+// maximum number of output formats written at once
+#define MAX_WRITERS 4
+
+// output buffer capacity allocated in advance, enough for any caption in any format
+#define OUTPUT_BUFFER_SIZE 16384
+
+// output buffer; whole caption is formatted in memory and written by a single syscall
+typedef struct {
+	char *data;
+	size_t size;
+	size_t capacity;
+} output_buffer_t;
+
+// output format; each writer formats into output buffer what is then written to its own file
+typedef struct {
+	const char *name; // -F value
+	const char *extension;
+	// 1 = live mode events are written as they come (caption without hide time, clear), 0 = complete captions only
+	uint8_t live_events;
+	// header and footer of file, NULL = none
+	void (*header)(output_buffer_t *output);
+	void (*footer)(output_buffer_t *output);
+	// index = 1-based number of caption in its output
+	void (*caption)(output_buffer_t *output, uint32_t index, const telxcc_event_t *event);
+} output_writer_t;
+
+// output of one page
+typedef struct {
+	uint16_t pid;
+	uint16_t page; // page number (BCD)
+	uint32_t frames_produced;
+	int fds[MAX_WRITERS]; // output file descriptor of each writer
+	// live mode: caption waiting for its hide time; writers of complete captions get it with clear event
+	output_buffer_t pending;
+	telxcc_event_t pending_event;
+	uint8_t pending_valid;
+} page_output_t;
+
+// packet index of input: runs of TS packets of teletext streams, so that repeated runs on the same input
+// read just them (few MiBs instead of whole recording)
+#define INDEX_MAGIC "TELXIDX1"
+
+// input ranges closer than this are read at once (gap within a page costs no extra I/O)
+#define INDEX_GAP 4096
+
+typedef struct {
+	uint64_t position; // input position of the first TS packet
+	uint32_t pcr; // TS PCR (in ms) at the first TS packet
+	uint16_t pid;
+	uint16_t packets;
+	uint16_t stride; // distance of TS packets (packet size)
+} index_run_t;
+
+typedef struct {
+	// input the index belongs to
+	uint64_t input_size;
+	int64_t input_mtime_s;
+	int64_t input_mtime_ns;
+	// teletext streams indexed, in order of detection; all_pids = all teletext streams of input (-t all)
+	uint8_t all_pids;
+	uint16_t pids[TELXCC_MAX_STREAMS];
+	uint8_t pids_count;
+	index_run_t *runs;
+	uint64_t runs_count;
+	uint64_t runs_capacity;
+	uint64_t packets;
+} packet_index_t;
+
+// pipelined mode: reader, decoder and writer threads hand over input blocks and formatted output through
+// bounded single-producer single-consumer rings
+#define PIPELINE_INPUT_SLOTS 16
+#define PIPELINE_OUTPUT_SLOTS 64
+// output batch is handed over when its data reach this size (or at the end of each input block)
+#define PIPELINE_BATCH_SIZE 65536
+#define PIPELINE_BATCH_SEGMENTS 256
+
+// Producer fills slot at tail and publishes it, consumer takes slot at head and releases it back; both indices
+// only grow and are published by release stores, so slots are reused in place without locks. Waits on full
+// ring (producer) and empty ring (consumer) are counted as backpressure.
+#define CACHE_LINE_SIZE 64
+typedef struct {
+	// producer and consumer fields on cache lines of their own (ring is aligned, see pipeline_start)
+	uint32_t tail __attribute__((aligned(CACHE_LINE_SIZE)));
+	uint8_t done; // producer finished
+	uint64_t full_waits;
+	uint32_t head __attribute__((aligned(CACHE_LINE_SIZE)));
+	uint8_t stop; // consumer finished
+	uint64_t empty_waits;
+} spsc_ring_t;
+
+// block of input TS packets; points into memory-mapped input, or into buffer
+typedef struct {
+	const uint8_t *data;
+	size_t size;
+	uint8_t *buffer;
+} pipeline_block_t;
+
+// formatted output; consecutive data of one fd form one segment
+typedef struct {
+	output_buffer_t data;
+	int fds[PIPELINE_BATCH_SEGMENTS];
+	size_t sizes[PIPELINE_BATCH_SEGMENTS];
+	uint16_t segments_count;
+} pipeline_batch_t;
+
+typedef struct {
+	spsc_ring_t input_ring;
+	pipeline_block_t blocks[PIPELINE_INPUT_SLOTS];
+	spsc_ring_t output_ring;
+	pipeline_batch_t batches[PIPELINE_OUTPUT_SLOTS];
+	// batch being filled by decoder thread, NULL = none acquired yet
+	pipeline_batch_t *batch;
+	struct ts_input *input;
+	pthread_t reader;
+	pthread_t writer;
+	// time spent by reader thread reading input (in ns)
+	uint64_t read_ns;
+	uint8_t write_failed;
+} pipeline_t;
+
+// backpressure counters of pipelined mode
+typedef struct {
+	uint64_t input_full;
+	uint64_t input_empty;
+	uint64_t output_full;
+	uint64_t output_empty;
+} pipeline_stats_t;
+
+// one input file and its outputs
+typedef struct {
+	const char *input; // NULL = stdin
+	const char *output_prefix; // NULL = stdout
+	uint8_t output_per_page; // 1 = PREFIX-PAGE.srt per page, 0 = single output PREFIX.srt (or stdout)
+
+	page_output_t outputs[MAX_OUTPUTS];
+	uint16_t outputs_count;
+	output_buffer_t output;
+
+	// teletext streams found
+	uint16_t stream_pids[TELXCC_MAX_STREAMS];
+	uint8_t stream_cc_maps[TELXCC_MAX_STREAMS][256];
+	uint8_t streams_count;
+
+	uint32_t packets;
+	uint32_t frames_produced;
+	uint8_t failed;
+
+	// decoder counters and time spent reading input and in telxcc_push() (in ns)
+	telxcc_stats_t stats;
+	uint64_t read_ns;
+	uint64_t decode_ns;
+	uint64_t start_ns;
+	// UDP input counters, NULL = file input
+	const udp_stats_t *udp;
+	// packet index being built while input is decoded, NULL = none
+	packet_index_t *index;
+	// pipelined mode: output goes to writer thread, NULL = written directly
+	pipeline_t *pipeline;
+	uint8_t pipelined;
+	pipeline_stats_t pipeline_stats;
+} job_t;
+
+// be verbose?
+uint16_t config_verbose = 0;
+#define VERBOSE if (config_verbose > 0)
+
+// output file name prefix for per-page output files, NULL = stdout
+const char *config_output_prefix = NULL;
+
+// print UTF-8 BOM at the beginning of each output?
+uint8_t config_bom = 1;
+
+// produce at least one (dummy) frame?
+uint8_t config_nonempty = 0;
+
+// decoder configuration set by command line params
+telxcc_config_t config;
+
+// batch mode input files
+const char **config_inputs = NULL;
+uint32_t config_inputs_count = 0;
+
+// number of worker threads, 0 = number of CPUs
+uint16_t config_workers = 0;
+
+// decode parts of input file in parallel?
+uint8_t config_split = 0;
+
+// decoder statistics output (JSON, one object per line), NULL = none
+FILE *config_stats = NULL;
+
+// live UDP/RTP input URL instead of STDIN, NULL = none
+const char *config_udp = NULL;
+
+// packet index file of STDIN input, NULL = none
+const char *config_index = NULL;
+
+// probe mode: report PSI and teletext pages of each input instead of decoding it?
+uint8_t config_probe = 0;
+
+// read regular files asynchronously (instead of memory map), with O_DIRECT?
+uint8_t config_async = 0;
+uint8_t config_direct = 0;
+
+// read input, decode and write output in threads of their own?
+uint8_t config_pipeline = 0;
+
+// page store output (JSON, one object per stored subpage and line), NULL = none; page store budget in bytes
+FILE *config_store = NULL;
+size_t config_store_budget = 0;
+
+// UDP socket receive buffer size in bytes, 0 = system default
+int config_udp_buffer = 0;
+
+// output formats, first one goes to stdout
+const output_writer_t *config_writers[MAX_WRITERS];
+uint8_t config_writers_count = 0;
+
+void output_reserve(output_buffer_t *output, size_t size) {
+	if (output->size + size <= output->capacity) return;
+	size_t capacity = (output->capacity > 0) ? output->capacity : 4096;
+	while (capacity < output->size + size) capacity *= 2;
+	char *data = realloc(output->data, capacity);
+	if (data == NULL) {
+		fprintf(stderr, "- Could not allocate output buffer\n");
+		exit(EXIT_FAILURE);
+	}
+	output->data = data;
+	output->capacity = capacity;
+}
+
+void output_append(output_buffer_t *output, const char *s, size_t size) {
+	output_reserve(output, size);
+	memcpy(output->data + output->size, s, size);
+	output->size += size;
+}
+
+#define output_append_literal(output, s) output_append((output), (s), sizeof(s) - 1)
+
+// writes out and empties output buffer; returns -1 on write error
+int output_flush(output_buffer_t *output, int fd) {
+	size_t written = 0;
+	while (written < output->size) {
+		ssize_t r = write(fd, output->data + written, output->size - written);
+		if (r < 0) {
+			if (errno == EINTR) continue;
+			fprintf(stderr, "- Output write error (%s)\n", strerror(errno));
+			output->size = 0;
+			return -1;
+		}
+		written += r;
+	}
+	output->size = 0;
+	return 0;
+}
+
+// writes "HH:MM:SS,mmm" (without terminating zero)
+static inline void timestamp_to_srttime(uint64_t timestamp, char *buffer) {
+	uint64_t p = timestamp;
+	uint8_t h = p / 3600000;
+	uint8_t m = p / 60000 - 60 * h;
+	uint8_t s = p / 1000 - 3600 * h - 60 * m;
+	uint16_t u = p - 3600000 * h - 60000 * m - 1000 * s;
+	// more than 99 hours is printed modulo 100
+	buffer[0] = '0' + (h / 10) % 10;
+	buffer[1] = '0' + h % 10;
+	buffer[2] = ':';
+	buffer[3] = '0' + m / 10;
+	buffer[4] = '0' + m % 10;
+	buffer[5] = ':';
+	buffer[6] = '0' + s / 10;
+	buffer[7] = '0' + s % 10;
+	buffer[8] = ',';
+	buffer[9] = '0' + u / 100;
+	buffer[10] = '0' + (u / 10) % 10;
+	buffer[11] = '0' + u % 10;
+}
+
+// appends size bytes of text as JSON string
+void output_append_json_text(output_buffer_t *output, const char *text, size_t size) {
+	output_append_literal(output, "\"");
+	for (const char *s = text; s < text + size; s++) {
+		char escaped[8];
+		if ((*s == '"') || (*s == '\\')) {
+			escaped[0] = '\\';
+			escaped[1] = *s;
+			output_append(output, escaped, 2);
+		}
+		else if (*s == '\n') output_append_literal(output, "\\n");
+		else if ((uint8_t)*s < 0x20) output_append(output, escaped, snprintf(escaped, sizeof(escaped), "\\u%04x", (uint8_t)*s));
+		else output_append(output, s, 1);
+	}
+	output_append_literal(output, "\"");
+}
+
+void output_append_json_string(output_buffer_t *output, const char *s) {
+	output_append_json_text(output, s, strlen(s));
+}
+
+#define output_append_format(output, ...) do { \
+	char formatted[128]; \
+	output_append((output), formatted, snprintf(formatted, sizeof(formatted), __VA_ARGS__)); \
+} while (0)
+
+// appends text with lines terminated by newline instead of \n
+void output_append_lines(output_buffer_t *output, const char *text, size_t size, const char *newline, size_t newline_size) {
+	const char *end = text + size;
+	while (text < end) {
+		const char *eol = memchr(text, '\n', end - text);
+		if (eol == NULL) eol = end;
+		output_append(output, text, eol - text);
+		if (eol < end) output_append(output, newline, newline_size);
+		text = eol + 1;
+	}
+}
+
+// appends text with XML (and WebVTT) markup characters escaped; lines are terminated by newline
+void output_append_escaped(output_buffer_t *output, const char *text, size_t size, const char *newline, size_t newline_size) {
+	const char *end = text + size;
+	for (const char *s = text; s < end; s++) {
+		if (*s == '&') output_append_literal(output, "&amp;");
+		else if (*s == '<') output_append_literal(output, "&lt;");
+		else if (*s == '>') output_append_literal(output, "&gt;");
+		// trailing newline is not needed
+		else if (*s == '\n') { if (s + 1 < end) output_append(output, newline, newline_size); }
+		else output_append(output, s, 1);
+	}
+}
+
+void bom_header(output_buffer_t *output) {
+	if (config_bom == 1) output_append_literal(output, "\xef\xbb\xbf");
+}
+
+// SubRip
+void srt_caption(output_buffer_t *output, uint32_t index, const telxcc_event_t *event) {
+	char timecode[32] = " --> ";
+	output_append_format(output, "%"PRIu32"\r\n", index);
+	timestamp_to_srttime(event->show_timestamp, timecode + 5);
+	output_append(output, timecode + 5, 12);
+	timestamp_to_srttime(event->hide_timestamp, timecode + 5);
+	output_append(output, timecode, 17);
+	output_append_literal(output, "\r\n");
+	output_append_lines(output, event->utf8, event->utf8_size, "\r\n", 2);
+	output_append_literal(output, "\r\n");
+}
+
+// WebVTT (W3C), for HLS and HTML5 players
+void vtt_header(output_buffer_t *output) {
+	bom_header(output);
+	output_append_literal(output, "WEBVTT\n\n");
+}
+
+void vtt_caption(output_buffer_t *output, uint32_t index, const telxcc_event_t *event) {
+	char timecode[32] = " --> ";
+	timestamp_to_srttime(event->show_timestamp, timecode + 5);
+	timecode[5 + 8] = '.';
+	output_append(output, timecode + 5, 12);
+	timestamp_to_srttime(event->hide_timestamp, timecode + 5);
+	timecode[5 + 8] = '.';
+	output_append(output, timecode, 17);
+	output_append_literal(output, "\n");
+	output_append_escaped(output, event->utf8, event->utf8_size, "\n", 1);
+	output_append_literal(output, "\n\n");
+}
+
+// TTML (W3C), timing as of EBU-TT-D
+void ttml_header(output_buffer_t *output) {
+	output_append_literal(output, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+		"<tt xmlns=\"http://www.w3.org/ns/ttml\" xmlns:ttp=\"http://www.w3.org/ns/ttml#parameter\" ttp:timeBase=\"media\" xml:lang=\"\">\n"
+		"<body>\n<div>\n");
+}
+
+void ttml_footer(output_buffer_t *output) {
+	output_append_literal(output, "</div>\n</body>\n</tt>\n");
+}
+
+void ttml_caption(output_buffer_t *output, uint32_t index, const telxcc_event_t *event) {
+	char timecode[16];
+	output_append_literal(output, "<p begin=\"");
+	timestamp_to_srttime(event->show_timestamp, timecode);
+	timecode[8] = '.';
+	output_append(output, timecode, 12);
+	output_append_literal(output, "\" end=\"");
+	timestamp_to_srttime(event->hide_timestamp, timecode);
+	timecode[8] = '.';
+	output_append(output, timecode, 12);
+	output_append_literal(output, "\">");
+	output_append_escaped(output, event->utf8, event->utf8_size, "<br/>", 5);
+	output_append_literal(output, "</p>\n");
+}
+
+// JSON lines, one object per event; live mode captions have no hide time (null) until their clear event
+void json_caption(output_buffer_t *output, uint32_t index, const telxcc_event_t *event) {
+	output_append_format(output, "{\"type\":\"%s\",\"pid\":%"PRIu16",\"page\":\"%03x\",\"show_ms\":%"PRIu64,
+		(event->type == TELXCC_EVENT_CLEAR) ? "clear" : "caption", event->pid, event->page, event->show_timestamp);
+	if ((event->type == TELXCC_EVENT_CAPTION) && (event->hide_timestamp == 0) && (config.live == 1)) output_append_literal(output, ",\"hide_ms\":null");
+	else output_append_format(output, ",\"hide_ms\":%"PRIu64, event->hide_timestamp);
+	if (event->type == TELXCC_EVENT_CAPTION) {
+		output_append_literal(output, ",\"text\":");
+		output_append_json_text(output, event->utf8, event->utf8_size);
+	}
+	output_append_literal(output, "}\n");
+}
+
+const output_writer_t WRITERS[] = {
+	{ "srt", "srt", 0, bom_header, NULL, srt_caption },
+	{ "vtt", "vtt", 0, vtt_header, NULL, vtt_caption },
+	{ "ttml", "ttml", 0, ttml_header, ttml_footer, ttml_caption },
+	{ "json", "jsonl", 1, NULL, NULL, json_caption }
+};
+
+const output_writer_t *find_writer(const char *name, size_t size) {
+	for (uint8_t i = 0; i < sizeof(WRITERS) / sizeof(WRITERS[0]); i++)
+		if ((strlen(WRITERS[i].name) == size) && (strncmp(WRITERS[i].name, name, size) == 0)) return &WRITERS[i];
+	return NULL;
+}
+
+// short waits yield, longer ones sleep
+static inline void ring_pause(uint32_t *spins) {
+	if (*spins < 64) {
+		(*spins)++;
+		sched_yield();
+		return;
+	}
+	struct timespec t = { 0, 50000 };
+	nanosleep(&t, NULL);
+}
+
+// producer: returns slot to be filled, -1 when consumer stopped
+int32_t ring_acquire(spsc_ring_t *ring, uint32_t capacity) {
+	uint32_t spins = 0;
+	for (;;) {
+		if (__atomic_load_n(&ring->stop, __ATOMIC_ACQUIRE) == 1) return -1;
+		if (ring->tail - __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) < capacity) return ring->tail % capacity;
+		if (spins == 0) __atomic_fetch_add(&ring->full_waits, 1, __ATOMIC_RELAXED);
+		ring_pause(&spins);
+	}
+}
+
+void ring_publish(spsc_ring_t *ring) {
+	__atomic_store_n(&ring->tail, ring->tail + 1, __ATOMIC_RELEASE);
+}
+
+void ring_finish(spsc_ring_t *ring) {
+	__atomic_store_n(&ring->done, 1, __ATOMIC_RELEASE);
+}
+
+// consumer: returns slot to be taken, -1 when producer finished and ring is empty
+int32_t ring_peek(spsc_ring_t *ring, uint32_t capacity) {
+	uint32_t spins = 0;
+	while (__atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) == ring->head) {
+		if (__atomic_load_n(&ring->done, __ATOMIC_ACQUIRE) == 1) {
+			// slot could be published right before producer finished
+			if (__atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) == ring->head) return -1;
+			break;
+		}
+		if (spins == 0) __atomic_fetch_add(&ring->empty_waits, 1, __ATOMIC_RELAXED);
+		ring_pause(&spins);
+	}
+	return ring->head % capacity;
+}
+
+void ring_release(spsc_ring_t *ring) {
+	__atomic_store_n(&ring->head, ring->head + 1, __ATOMIC_RELEASE);
+}
+
+void ring_stop(spsc_ring_t *ring) {
+	__atomic_store_n(&ring->stop, 1, __ATOMIC_RELEASE);
+}
+
+// pipelined mode: output batch being filled is handed over to writer thread
+void pipeline_output_publish(pipeline_t *pipeline) {
+	if (pipeline->batch == NULL) return;
+	ring_publish(&pipeline->output_ring);
+	pipeline->batch = NULL;
+}
+
+// pipelined mode: output formatted in output buffer is queued for writer thread; returns -1 when writer stopped
+int pipeline_output(pipeline_t *pipeline, output_buffer_t *output, int fd) {
+	if (output->size == 0) return 0;
+	if (pipeline->batch == NULL) {
+		int32_t slot = ring_acquire(&pipeline->output_ring, PIPELINE_OUTPUT_SLOTS);
+		if (slot < 0) {
+			output->size = 0;
+			return -1;
+		}
+		pipeline->batch = &pipeline->batches[slot];
+		pipeline->batch->data.size = 0;
+		pipeline->batch->segments_count = 0;
+	}
+
+	pipeline_batch_t *batch = pipeline->batch;
+	uint16_t n = batch->segments_count;
+	if ((n > 0) && (batch->fds[n - 1] == fd)) batch->sizes[n - 1] += output->size;
+	else {
+		batch->fds[n] = fd;
+		batch->sizes[n] = output->size;
+		batch->segments_count++;
+	}
+	output_append(&batch->data, output->data, output->size);
+	output->size = 0;
+
+	if ((batch->data.size >= PIPELINE_BATCH_SIZE) || (batch->segments_count == PIPELINE_BATCH_SEGMENTS)) pipeline_output_publish(pipeline);
+	return 0;
+}
+
+void get_pipeline_stats(const job_t *job, pipeline_stats_t *stats) {
+	if (job->pipeline == NULL) {
+		*stats = job->pipeline_stats;
+		return;
+	}
+	stats->input_full = __atomic_load_n(&job->pipeline->input_ring.full_waits, __ATOMIC_RELAXED);
+	stats->input_empty = __atomic_load_n(&job->pipeline->input_ring.empty_waits, __ATOMIC_RELAXED);
+	stats->output_full = __atomic_load_n(&job->pipeline->output_ring.full_waits, __ATOMIC_RELAXED);
+	stats->output_empty = __atomic_load_n(&job->pipeline->output_ring.empty_waits, __ATOMIC_RELAXED);
+}
+
+// output formatted in job output buffer goes to fd, through writer thread in pipelined mode
+int job_output_flush(job_t *job, int fd) {
+	if (job->pipeline != NULL) return pipeline_output(job->pipeline, &job->output, fd);
+	return output_flush(&job->output, fd);
+}
+
+// writes header (or footer) of writer into fd
+void write_header(job_t *job, void (*header)(output_buffer_t *output), int fd) {
+	if (header == NULL) return;
+	header(&job->output);
+	if (job_output_flush(job, fd) < 0) job->failed = 1;
+}
+
+page_output_t *find_page_output(job_t *job, uint16_t pid, uint16_t page) {
+	for (uint16_t i = 0; i < job->outputs_count; i++)
+		if ((job->outputs[i].pid == pid) && (job->outputs[i].page == page)) return &job->outputs[i];
+	return NULL;
+}
+
+// returns NULL if output file could not be opened
+page_output_t *add_page_output(job_t *job, uint16_t pid, uint16_t page) {
+	page_output_t *state = &job->outputs[job->outputs_count];
+	memset(state, 0, sizeof(page_output_t));
+	state->pid = pid;
+	state->page = page;
+	for (uint8_t i = 0; i < config_writers_count; i++) state->fds[i] = STDOUT_FILENO;
+
+	// stdout gets its header at startup
+	if (job->output_prefix != NULL) {
+		for (uint8_t i = 0; i < config_writers_count; i++) {
+			const char *extension = config_writers[i]->extension;
+			char filename[FILENAME_MAX];
+			// in multiplex mode PID is part of file name
+			if (job->output_per_page == 0) snprintf(filename, sizeof(filename), "%s.%s", job->output_prefix, extension);
+			else if (config.all_pids == 1) snprintf(filename, sizeof(filename), "%s-%"PRIu16"-%03x.%s", job->output_prefix, pid, page, extension);
+			else snprintf(filename, sizeof(filename), "%s-%03x.%s", job->output_prefix, page, extension);
+			state->fds[i] = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+			if (state->fds[i] < 0) {
+				fprintf(stderr, "- Could not open output file %s (%s)\n", filename, strerror(errno));
+				while (i > 0) close(state->fds[--i]);
+				job->failed = 1;
+				return NULL;
+			}
+			VERBOSE fprintf(stderr, "- PID %"PRIu16" page %03x is written to %s\n", pid, page, filename);
+			write_header(job, config_writers[i]->header, state->fds[i]);
+		}
+	}
+	job->outputs_count++;
+
+	return state;
+}
+
+// writes complete caption to outputs of all writers (or of those of complete captions only)
+void write_caption(job_t *job, page_output_t *state, const telxcc_event_t *event, uint8_t all) {
+	state->frames_produced++;
+	for (uint8_t i = 0; i < config_writers_count; i++) {
+		if ((all == 0) && (config_writers[i]->live_events == 1)) continue;
+		config_writers[i]->caption(&job->output, state->frames_produced, event);
+		if (job_output_flush(job, state->fds[i]) < 0) job->failed = 1;
+	}
+}
+
+// writes live mode event to outputs of writers of live events
+void write_live_event(job_t *job, page_output_t *state, const telxcc_event_t *event) {
+	for (uint8_t i = 0; i < config_writers_count; i++) {
+		if (config_writers[i]->live_events == 0) continue;
+		config_writers[i]->caption(&job->output, state->frames_produced + 1, event);
+		if (job_output_flush(job, state->fds[i]) < 0) job->failed = 1;
+	}
+}
+
+// TS packet of teletext stream joins the last run if it follows right after it, with the same PCR
+void index_add(packet_index_t *index, const telxcc_event_t *event) {
+	index->packets++;
+	if (index->runs_count > 0) {
+		index_run_t *run = &index->runs[index->runs_count - 1];
+		uint64_t d = event->position - (run->position + (uint64_t)(run->packets - 1) * run->stride);
+		// run is read at once (see decode_index)
+		if ((run->pid == event->pid) && (run->pcr == event->pcr) && ((uint64_t)run->packets * d + TS_PACKET_SIZE <= INPUT_BLOCK_SIZE)
+			&& (((run->packets == 1) && ((d == 188) || (d == 192) || (d == 204))) || (d == run->stride))) {
+			run->stride = d;
+			run->packets++;
+			return;
+		}
+	}
+
+	if (index->runs_count == index->runs_capacity) {
+		uint64_t capacity = (index->runs_capacity > 0) ? 2 * index->runs_capacity : 4096;
+		index_run_t *runs = realloc(index->runs, capacity * sizeof(index_run_t));
+		if (runs == NULL) {
+			fprintf(stderr, "- Could not allocate packet index\n");
+			exit(EXIT_FAILURE);
+		}
+		index->runs = runs;
+		index->runs_capacity = capacity;
+	}
+	index_run_t *run = &index->runs[index->runs_count++];
+	run->position = event->position;
+	run->pcr = event->pcr;
+	run->pid = event->pid;
+	run->packets = 1;
+	run->stride = TS_PACKET_SIZE;
+}
+
+void caption_callback(void *user_data, const telxcc_event_t *event) {
+	job_t *job = user_data;
+
+	if (event->type == TELXCC_EVENT_PACKET) {
+		index_add(job->index, event);
+		return;
+	}
+
+	if (event->type == TELXCC_EVENT_PAGE) {
+		if ((find_page_output(job, event->pid, event->page) == NULL) && (job->outputs_count < MAX_OUTPUTS)) add_page_output(job, event->pid, event->page);
+		return;
+	}
+
+	page_output_t *state = find_page_output(job, event->pid, event->page);
+	if (state == NULL) return;
+
+	// live mode: caption is complete (has its hide time) with its clear event
+	if (config.live == 1) {
+		write_live_event(job, state, event);
+		if (event->type == TELXCC_EVENT_CAPTION) {
+			state->pending.size = 0;
+			output_append(&state->pending, event->utf8, event->utf8_size + 1);
+			state->pending_event = *event;
+			state->pending_valid = 1;
+			return;
+		}
+		if (state->pending_valid == 0) return;
+		state->pending_valid = 0;
+		telxcc_event_t caption = state->pending_event;
+		caption.hide_timestamp = event->hide_timestamp;
+		caption.utf8 = state->pending.data;
+		write_caption(job, state, &caption, 0);
+		return;
+	}
+
+	write_caption(job, state, event, 1);
+}
+
+// graceful exit support
+uint8_t exit_request = 0;
 
-#include "tables_hamming.h"
-#include "tables_teletext.h"
+// number of SIGUSR1 received; decoding loops print statistics whenever it changes
+volatile sig_atomic_t stats_requests = 0;
+
+// number of SIGUSR2 received; decoding loops print page store whenever it changes
+volatile sig_atomic_t store_requests = 0;
+
+void signal_handler(int sig) {
+	if ((sig == SIGINT) || (sig == SIGTERM)) {
+		fprintf(stderr, "- SIGINT/SIGTERM received, performing graceful exit\n");
+		exit_request = 1;
+	}
+	else if (sig == SIGUSR1) stats_requests++;
+	else if (sig == SIGUSR2) store_requests++;
+}
+
+static inline uint64_t clock_ns(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// sums decoder counters (of input parts or of more inputs)
+void add_stats(telxcc_stats_t *total, const telxcc_stats_t *stats) {
+	total->packets += stats->packets;
+	total->bytes_skipped += stats->bytes_skipped;
+	total->sync_losses += stats->sync_losses;
+	total->bytes += stats->bytes;
+	total->ts_packets += stats->ts_packets;
+	total->ts_packets_parsed += stats->ts_packets_parsed;
+	total->transport_errors += stats->transport_errors;
+	for (uint8_t k = 0; k < stats->streams_count; k++) {
+		const telxcc_stream_stats_t *s = &stats->streams[k];
+		uint8_t i = 0;
+		while ((i < total->streams_count) && (total->streams[i].pid != s->pid)) i++;
+		if (i == TELXCC_MAX_STREAMS) continue;
+		if (i == total->streams_count) {
+			memset(&total->streams[i], 0, sizeof(telxcc_stream_stats_t));
+			total->streams[i].pid = s->pid;
+			total->streams_count++;
+		}
+		total->streams[i].packets += s->packets;
+		total->streams[i].continuity_errors += s->continuity_errors;
+		total->streams[i].pes += s->pes;
+		total->streams[i].pes_truncated += s->pes_truncated;
+		total->streams[i].pes_overflows += s->pes_overflows;
+	}
+	for (uint16_t i = 0; i < 256; i++) total->data_units[i] += stats->data_units[i];
+	for (uint8_t m = 0; m < 8; m++)
+		for (uint8_t y = 0; y < 32; y++) total->rows[m][y] += stats->rows[m][y];
+	total->pages += stats->pages;
+	total->captions += stats->captions;
+	total->repeats += stats->repeats;
+	for (uint8_t i = 0; i < TELXCC_LATENCY_BUCKETS; i++) total->latency[i] += stats->latency[i];
+	total->stage_pes_ns += stats->stage_pes_ns;
+	total->stage_render_ns += stats->stage_render_ns;
+	total->stage_callback_ns += stats->stage_callback_ns;
+}
+
+// prints statistics as a single line JSON object; part is the split mode input part, or -1 for whole input,
+// final is 0 for snapshots requested by SIGUSR1
+void print_stats(const job_t *job, const telxcc_stats_t *stats, uint64_t read_ns, uint64_t decode_ns, int64_t part, uint8_t final) {
+	output_buffer_t json = { NULL, 0, 0 };
+
+	output_append_literal(&json, "{\"type\":\"stats\",\"input\":");
+	output_append_json_string(&json, (job->input != NULL) ? job->input : ((config_udp != NULL) ? config_udp : "-"));
+	if (part >= 0) output_append_format(&json, ",\"part\":%"PRId64, part);
+	output_append_format(&json, ",\"final\":%s,\"elapsed_ns\":%"PRIu64, (final == 1) ? "true" : "false", clock_ns() - job->start_ns);
+	output_append_format(&json, ",\"bytes\":%"PRIu64",\"bytes_skipped\":%"PRIu64",\"sync_losses\":%"PRIu32, stats->bytes, stats->bytes_skipped, stats->sync_losses);
+	output_append_format(&json, ",\"ts_packets\":%"PRIu64",\"ts_packets_parsed\":%"PRIu64",\"transport_errors\":%"PRIu32, stats->ts_packets, stats->ts_packets_parsed, stats->transport_errors);
+	output_append_format(&json, ",\"teletext_packets\":%"PRIu32",\"pages\":%"PRIu32",\"captions\":%"PRIu64",\"repeats\":%"PRIu64, stats->packets, stats->pages, stats->captions, stats->repeats);
+	if (job->pipelined == 1) {
+		pipeline_stats_t pipeline_stats;
+		get_pipeline_stats(job, &pipeline_stats);
+		output_append_format(&json, ",\"pipeline\":{\"input_full\":%"PRIu64",\"input_empty\":%"PRIu64",\"output_full\":%"PRIu64",\"output_empty\":%"PRIu64"}",
+			pipeline_stats.input_full, pipeline_stats.input_empty, pipeline_stats.output_full, pipeline_stats.output_empty);
+	}
+	if (job->udp != NULL) {
+		output_append_format(&json, ",\"udp\":{\"datagrams\":%"PRIu64",\"rtp_datagrams\":%"PRIu64",\"rtp_lost\":%"PRIu64, job->udp->datagrams, job->udp->rtp_datagrams, job->udp->rtp_lost);
+		output_append_format(&json, ",\"kernel_drops\":%"PRIu64",\"malformed\":%"PRIu64"}", job->udp->kernel_drops, job->udp->malformed);
+	}
+
+	output_append_literal(&json, ",\"streams\":[");
+	for (uint8_t k = 0; k < stats->streams_count; k++) {
+		const telxcc_stream_stats_t *s = &stats->streams[k];
+		output_append_format(&json, "%s{\"pid\":%"PRIu16",\"packets\":%"PRIu64",\"continuity_errors\":%"PRIu32, (k > 0) ? "," : "", s->pid, s->packets, s->continuity_errors);
+		output_append_format(&json, ",\"pes\":%"PRIu64",\"pes_truncated\":%"PRIu32",\"pes_overflows\":%"PRIu32"}", s->pes, s->pes_truncated, s->pes_overflows);
+	}
+
+	// non-zero counters only
+	output_append_literal(&json, "],\"data_units\":{");
+	uint8_t first = 1;
+	for (uint16_t i = 0; i < 256; i++) {
+		if (stats->data_units[i] == 0) continue;
+		output_append_format(&json, "%s\"0x%02x\":%"PRIu64, (first == 1) ? "" : ",", i, stats->data_units[i]);
+		first = 0;
+	}
+	output_append_literal(&json, "},\"rows\":{");
+	first = 1;
+	for (uint8_t m = 0; m < 8; m++) {
+		uint8_t first_row = 1;
+		for (uint8_t y = 0; y < 32; y++) {
+			if (stats->rows[m][y] == 0) continue;
+			if (first_row == 1) output_append_format(&json, "%s\"%u\":{", (first == 1) ? "" : ",", m + 1);
+			output_append_format(&json, "%s\"%u\":%"PRIu64, (first_row == 1) ? "" : ",", y, stats->rows[m][y]);
+			first_row = 0;
+			first = 0;
+		}
+		if (first_row == 0) output_append_literal(&json, "}");
+	}
+
+	// caption latency buckets by their upper bound in ms
+	output_append_literal(&json, "},\"latency_ms\":{");
+	for (uint8_t i = 0; i < TELXCC_LATENCY_BUCKETS - 1; i++) output_append_format(&json, "\"%u\":%"PRIu32",", 16u << i, stats->latency[i]);
+	output_append_format(&json, "\"inf\":%"PRIu32, stats->latency[TELXCC_LATENCY_BUCKETS - 1]);
+
+	// TS demux is what remains of telxcc_push() time; output is SRT formatting and writing in callback
+	uint64_t nested_ns = stats->stage_pes_ns + stats->stage_render_ns + stats->stage_callback_ns;
+	output_append_format(&json, "},\"stage_ns\":{\"read\":%"PRIu64",\"demux\":%"PRIu64, read_ns, (decode_ns > nested_ns) ? decode_ns - nested_ns : 0);
+	output_append_format(&json, ",\"pes\":%"PRIu64",\"render\":%"PRIu64",\"output\":%"PRIu64"}}\n", stats->stage_pes_ns, stats->stage_render_ns, stats->stage_callback_ns);
+
+	fwrite(json.data, 1, json.size, config_stats);
+	fflush(config_stats);
+	free(json.data);
+}
+
+// prints all subpages in page store of decoder as single line JSON objects: text rendered, and glyphs and
+// attributes (25 rows of 40 bytes) in hex; final is 0 for snapshots requested by SIGUSR2
+void print_store(const job_t *job, const telxcc_decoder_t *decoder, uint8_t final) {
+	static const char HEX[] = "0123456789abcdef";
+	output_buffer_t json = { NULL, 0, 0 };
+	char text[TELXCC_STORE_TEXT_SIZE];
+	char hex[2 * 40];
+
+	telxcc_stored_page_t stored;
+	stored.pid = 0;
+	while (telxcc_store_next(decoder, &stored) == 1) {
+		output_append_literal(&json, "{\"type\":\"page\",\"input\":");
+		output_append_json_string(&json, (job->input != NULL) ? job->input : ((config_udp != NULL) ? config_udp : "-"));
+		output_append_format(&json, ",\"final\":%s,\"pid\":%"PRIu16",\"page\":\"%03x\",\"subpage\":\"%04x\"", (final == 1) ? "true" : "false", stored.pid, stored.page, stored.subpage);
+		output_append_format(&json, ",\"control\":%"PRIu16",\"g0\":%u", stored.control, stored.g0);
+		if (stored.g0_secondary != 255) output_append_format(&json, ",\"g0_secondary\":%u", stored.g0_secondary);
+		output_append_format(&json, ",\"rows\":%"PRIu32",\"position\":%"PRIu64",\"timestamp\":%"PRIu64",\"updates\":%"PRIu32, stored.rows, stored.position, stored.timestamp, stored.updates);
+
+		telxcc_store_text(&stored, text);
+		output_append_literal(&json, ",\"text\":");
+		output_append_json_string(&json, text);
+
+		const uint8_t (*planes[2])[40] = { stored.glyphs, stored.attrs };
+		for (uint8_t p = 0; p < 2; p++) {
+			if (p == 0) output_append_literal(&json, ",\"glyphs\":[");
+			else output_append_literal(&json, "],\"attrs\":[");
+			for (uint8_t row = 0; row < 25; row++) {
+				for (uint8_t col = 0; col < 40; col++) {
+					hex[2 * col] = HEX[planes[p][row][col] >> 4];
+					hex[2 * col + 1] = HEX[planes[p][row][col] & 0x0f];
+				}
+				output_append_literal(&json, "\"");
+				output_append(&json, hex, sizeof(hex));
+				output_append(&json, (row < 24) ? "\"," : "\"", (row < 24) ? 2 : 1);
+			}
+		}
+		output_append_literal(&json, "]}\n");
+	}
+
+	if (json.size > 0) {
+		fwrite(json.data, 1, json.size, config_store);
+		fflush(config_store);
+	}
+	free(json.data);
+}
+
+// asynchronous input block states
+#define ASYNC_IDLE 0
+#define ASYNC_PENDING 1
+#define ASYNC_DONE 2
+
+typedef struct {
+	// ASYNC_ALIGNMENT bytes of headroom, then data
+	uint8_t *buffer;
+	uint8_t *data;
+	uint64_t offset;
+	size_t size;
+	ssize_t result;
+	uint8_t state;
+} async_block_t;
+
+// Asynchronous input of regular file: ASYNC_DEPTH reads are kept in flight (io_uring, or a pread() thread where
+// io_uring is not available), blocks are consumed in input order and the block consumed is read again (further
+// in file) when the next one is requested. With O_DIRECT the page cache is bypassed.
+typedef struct {
+	// fd read (reopened with O_DIRECT), input fd (buffered, completes short direct reads)
+	int fd;
+	int buffered_fd;
+	uint8_t direct;
+	uint64_t file_size;
+	// file offset of next block read
+	uint64_t next_offset;
+	async_block_t blocks[ASYNC_DEPTH];
+	// block consumed next; previous one was handed out and is to be read again
+	uint8_t next;
+	uint8_t consumed;
+	// blocks being read
+	uint8_t pending;
+#ifdef IO_URING
+	// -1 = pread() thread
+	int ring_fd;
+	void *sq_ring;
+	size_t sq_ring_size;
+	void *cq_ring;
+	size_t cq_ring_size;
+	struct io_uring_sqe *sqes;
+	size_t sqes_size;
+	unsigned *sq_head;
+	unsigned *sq_tail;
+	unsigned *sq_mask;
+	unsigned *sq_array;
+	unsigned *cq_head;
+	unsigned *cq_tail;
+	unsigned *cq_mask;
+	struct io_uring_cqe *cqes;
+#endif
+	// pread() thread reads blocks in ring order
+	uint8_t thread_started;
+	pthread_t thread;
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	uint8_t stop;
+} async_input_t;
+
+// TS input: regular files are memory-mapped and walked in place, anything else (pipes, terminals)
+// is read in large aligned blocks, UDP datagrams are received in batches; all hand out whole TS packets only
+typedef struct ts_input {
+	int fd;
+	// memory-mapped input
+	uint8_t *map;
+	size_t map_size;
+	size_t map_offset;
+	// block-read input
+	uint8_t *buffer;
+	uint8_t carry[TS_PACKET_SIZE];
+	size_t carry_size;
+	// UDP input (fd is a socket): 0 = RTP detected per datagram, 1 = RTP only (rtp:// URL)
+	uint8_t udp;
+	uint8_t rtp_only;
+	uint8_t rtp_sequence_valid;
+	uint16_t rtp_sequence;
+	uint32_t kernel_drops;
+	udp_stats_t udp_stats;
+	// asynchronous regular file input, NULL = none
+	async_input_t *async;
+} ts_input_t;
+
+#ifndef _WIN32
+#ifdef IO_URING
+// sets up io_uring of ASYNC_DEPTH entries; returns -1 if io_uring (with IORING_OP_READ) is not available
+int async_ring_open(async_input_t *async) {
+	struct io_uring_params params;
+	memset(&params, 0, sizeof(params));
+	int fd = syscall(__NR_io_uring_setup, ASYNC_DEPTH, &params);
+	if (fd < 0) return -1;
+	// IORING_OP_READ came with IORING_FEAT_RW_CUR_POS (Linux 5.6)
+	if ((params.features & IORING_FEAT_RW_CUR_POS) == 0) {
+		close(fd);
+		return -1;
+	}
+
+	async->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	async->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+	uint8_t single_mmap = ((params.features & IORING_FEAT_SINGLE_MMAP) > 0);
+	if ((single_mmap == 1) && (async->cq_ring_size > async->sq_ring_size)) async->sq_ring_size = async->cq_ring_size;
+	async->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+
+	async->sq_ring = mmap(NULL, async->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+	if (async->sq_ring == MAP_FAILED) {
+		close(fd);
+		return -1;
+	}
+	async->cq_ring = async->sq_ring;
+	if (single_mmap == 0) {
+		async->cq_ring = mmap(NULL, async->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+		if (async->cq_ring == MAP_FAILED) {
+			munmap(async->sq_ring, async->sq_ring_size);
+			close(fd);
+			return -1;
+		}
+	}
+	async->sqes = mmap(NULL, async->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+	if (async->sqes == MAP_FAILED) {
+		if (single_mmap == 0) munmap(async->cq_ring, async->cq_ring_size);
+		munmap(async->sq_ring, async->sq_ring_size);
+		close(fd);
+		return -1;
+	}
+
+	uint8_t *sq = async->sq_ring;
+	uint8_t *cq = async->cq_ring;
+	async->sq_head = (unsigned *)(sq + params.sq_off.head);
+	async->sq_tail = (unsigned *)(sq + params.sq_off.tail);
+	async->sq_mask = (unsigned *)(sq + params.sq_off.ring_mask);
+	async->sq_array = (unsigned *)(sq + params.sq_off.array);
+	async->cq_head = (unsigned *)(cq + params.cq_off.head);
+	async->cq_tail = (unsigned *)(cq + params.cq_off.tail);
+	async->cq_mask = (unsigned *)(cq + params.cq_off.ring_mask);
+	async->cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+	async->ring_fd = fd;
+	return 0;
+}
+
+void async_ring_submit(async_input_t *async, uint8_t i) {
+	async_block_t *block = &async->blocks[i];
+	unsigned tail = *async->sq_tail;
+	unsigned index = tail & *async->sq_mask;
+	struct io_uring_sqe *sqe = &async->sqes[index];
+	memset(sqe, 0, sizeof(struct io_uring_sqe));
+	sqe->opcode = IORING_OP_READ;
+	sqe->fd = async->fd;
+	sqe->addr = (uintptr_t)block->data;
+	sqe->len = block->size;
+	sqe->off = block->offset;
+	sqe->user_data = i;
+	async->sq_array[index] = index;
+	__atomic_store_n(async->sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+	for (;;) {
+		long submitted = syscall(__NR_io_uring_enter, async->ring_fd, 1, 0, 0, NULL, 0);
+		if (submitted == 1) return;
+		if ((submitted < 0) && (errno == EINTR)) continue;
+		int error = (submitted < 0) ? errno : EAGAIN;
+		// SQE taken by kernel anyway completes as any other
+		if (__atomic_load_n(async->sq_head, __ATOMIC_ACQUIRE) != tail) return;
+		// SQE left in ring is withdrawn, so that no later io_uring_enter() submits it; read is completed by pread()
+		// (see async_wait)
+		__atomic_store_n(async->sq_tail, tail, __ATOMIC_RELEASE);
+		block->result = -error;
+		block->state = ASYNC_DONE;
+		async->pending--;
+		return;
+	}
+}
+
+// takes completions, waits for at least one if there is none; returns -1 on failure
+int async_ring_reap(async_input_t *async) {
+	unsigned head = *async->cq_head;
+	unsigned tail = __atomic_load_n(async->cq_tail, __ATOMIC_ACQUIRE);
+	if (head == tail) {
+		if ((syscall(__NR_io_uring_enter, async->ring_fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0) && (errno != EINTR)) {
+			fprintf(stderr, "- Input read error (%s)\n", strerror(errno));
+			return -1;
+		}
+		return 0;
+	}
+	for (; head != tail; head++) {
+		const struct io_uring_cqe *cqe = &async->cqes[head & *async->cq_mask];
+		async_block_t *block = &async->blocks[cqe->user_data];
+		block->result = cqe->res;
+		block->state = ASYNC_DONE;
+		async->pending--;
+	}
+	__atomic_store_n(async->cq_head, head, __ATOMIC_RELEASE);
+	return 0;
+}
+#endif
+
+// pread() thread reads blocks in ring order, in which they are submitted
+void *async_thread(void *arg) {
+	async_input_t *async = arg;
+	uint8_t i = 0;
+	pthread_mutex_lock(&async->mutex);
+	for (;;) {
+		while ((async->stop == 0) && (async->blocks[i].state != ASYNC_PENDING)) pthread_cond_wait(&async->cond, &async->mutex);
+		if (async->stop == 1) break;
+		async_block_t *block = &async->blocks[i];
+		pthread_mutex_unlock(&async->mutex);
+
+		ssize_t r;
+		while (((r = pread(async->fd, block->data, block->size, block->offset)) < 0) && (errno == EINTR));
+		if (r < 0) r = -errno;
+
+		pthread_mutex_lock(&async->mutex);
+		block->result = r;
+		block->state = ASYNC_DONE;
+		async->pending--;
+		pthread_cond_broadcast(&async->cond);
+		i = (i + 1) % ASYNC_DEPTH;
+	}
+	pthread_mutex_unlock(&async->mutex);
+	return NULL;
+}
+
+// block i is read from the next file offset; nothing is read beyond the end of file
+void async_submit(async_input_t *async, uint8_t i) {
+	async_block_t *block = &async->blocks[i];
+	if (async->next_offset >= async->file_size) return;
+	block->offset = async->next_offset;
+	// the last block is read short (O_DIRECT read size must stay aligned)
+	block->size = ASYNC_BLOCK_SIZE;
+	async->next_offset += ASYNC_BLOCK_SIZE;
+	async->pending++;
+
+#ifdef IO_URING
+	if (async->ring_fd >= 0) {
+		block->state = ASYNC_PENDING;
+		async_ring_submit(async, i);
+		return;
+	}
+#endif
+	pthread_mutex_lock(&async->mutex);
+	block->state = ASYNC_PENDING;
+	pthread_cond_broadcast(&async->cond);
+	pthread_mutex_unlock(&async->mutex);
+}
+
+// waits for block i to be read; returns its size, 0 on failure or exit request
+size_t async_wait(async_input_t *async, uint8_t i) {
+	async_block_t *block = &async->blocks[i];
+#ifdef IO_URING
+	if (async->ring_fd >= 0) {
+		while (block->state == ASYNC_PENDING) {
+			if ((exit_request == 1) || (async_ring_reap(async) < 0)) return 0;
+		}
+	}
+	else
+#endif
+	{
+		pthread_mutex_lock(&async->mutex);
+		while (block->state == ASYNC_PENDING) pthread_cond_wait(&async->cond, &async->mutex);
+		pthread_mutex_unlock(&async->mutex);
+	}
+	block->state = ASYNC_IDLE;
+
+	// short read, or failed read (e.g. O_DIRECT refused by file system), is completed by buffered pread()
+	size_t size = (block->result > 0) ? (size_t)block->result : 0;
+	uint64_t expected = async->file_size - block->offset;
+	if (expected > ASYNC_BLOCK_SIZE) expected = ASYNC_BLOCK_SIZE;
+	if ((block->result < 0) && (async->direct == 1)) VERBOSE fprintf(stderr, "- O_DIRECT read failed (%s), reading by page cache\n", strerror(-block->result));
+	while (size < expected) {
+		ssize_t r = pread(async->buffered_fd, block->data + size, expected - size, block->offset + size);
+		if (r < 0) {
+			if (errno == EINTR) continue;
+			fprintf(stderr, "- Input read error (%s)\n", strerror(errno));
+			return 0;
+		}
+		if (r == 0) break;
+		size += r;
+	}
+	return size;
+}
+
+// regular file input by asynchronous reads; returns -1 if it could not be set up
+int async_open(ts_input_t *input, int fd, uint64_t file_size) {
+	async_input_t *async = calloc(1, sizeof(async_input_t));
+	if (async == NULL) return -1;
+	async->fd = fd;
+	async->buffered_fd = fd;
+	async->file_size = file_size;
+#ifdef IO_URING
+	async->ring_fd = -1;
+#endif
+	for (uint8_t i = 0; i < ASYNC_DEPTH; i++) {
+		if (posix_memalign((void **)&async->blocks[i].buffer, ASYNC_ALIGNMENT, ASYNC_ALIGNMENT + ASYNC_BLOCK_SIZE) != 0) {
+			for (uint8_t j = 0; j < i; j++) free(async->blocks[j].buffer);
+			free(async);
+			return -1;
+		}
+		async->blocks[i].data = async->blocks[i].buffer + ASYNC_ALIGNMENT;
+	}
+
+#ifdef O_DIRECT
+	// reopened, O_DIRECT would affect file description shared with the input fd
+	if (config_direct == 1) {
+		char path[64];
+		snprintf(path, sizeof(path), "/proc/self/fd/%d", fd);
+		int direct_fd = open(path, O_RDONLY | O_DIRECT);
+		if (direct_fd >= 0) {
+			async->fd = direct_fd;
+			async->direct = 1;
+		}
+		else VERBOSE fprintf(stderr, "- Input could not be opened with O_DIRECT (%s), reading by page cache\n", strerror(errno));
+	}
+#endif
+
+	const char *engine = "io_uring";
+#ifdef IO_URING
+	if (async_ring_open(async) < 0)
+#endif
+	{
+		engine = "pread() thread";
+		pthread_mutex_init(&async->mutex, NULL);
+		pthread_cond_init(&async->cond, NULL);
+		if (pthread_create(&async->thread, NULL, async_thread, async) != 0) {
+			pthread_mutex_destroy(&async->mutex);
+			pthread_cond_destroy(&async->cond);
+			if (async->direct == 1) close(async->fd);
+			for (uint8_t i = 0; i < ASYNC_DEPTH; i++) free(async->blocks[i].buffer);
+			free(async);
+			return -1;
+		}
+		async->thread_started = 1;
+	}
+
+	for (uint8_t i = 0; i < ASYNC_DEPTH; i++) async_submit(async, i);
+	input->async = async;
+	VERBOSE fprintf(stderr, "- Input is a regular file, read by %s (%u reads of %u KiB queued%s)\n",
+		engine, ASYNC_DEPTH, ASYNC_BLOCK_SIZE / 1024, (async->direct == 1) ? ", O_DIRECT" : "");
+	return 0;
+}
+
+// hands out blocks in input order, incomplete TS packet at the end of a block is moved to headroom of the next one
+size_t async_read(ts_input_t *input, const uint8_t **block) {
+	async_input_t *async = input->async;
+
+	// block handed out last time is consumed
+	if (async->consumed == 1) {
+		async_submit(async, (async->next + ASYNC_DEPTH - 1) % ASYNC_DEPTH);
+		async->consumed = 0;
+	}
+
+	uint8_t i = async->next;
+	if (async->blocks[i].state == ASYNC_IDLE) return 0;
+	size_t size = async_wait(async, i);
+	async->next = (i + 1) % ASYNC_DEPTH;
+	async->consumed = 1;
+	if (size == 0) return 0;
+
+	uint8_t *data = async->blocks[i].data - input->carry_size;
+	memcpy(data, input->carry, input->carry_size);
+	size += input->carry_size;
+
+	input->carry_size = size % TS_PACKET_SIZE;
+	size -= input->carry_size;
+	memcpy(input->carry, data + size, input->carry_size);
+
+	*block = data;
+	return size;
+}
+
+void async_close(async_input_t *async) {
+#ifdef IO_URING
+	if (async->ring_fd >= 0) {
+		// buffers are released only when no read is in flight; when completions cannot be reaped, reads may still
+		// write into buffers, so they are left allocated (and ring mapped) instead
+		while ((async->pending > 0) && (async_ring_reap(async) == 0));
+		if (async->pending > 0) return;
+		munmap(async->sqes, async->sqes_size);
+		if (async->cq_ring != async->sq_ring) munmap(async->cq_ring, async->cq_ring_size);
+		munmap(async->sq_ring, async->sq_ring_size);
+		close(async->ring_fd);
+	}
+#endif
+	if (async->thread_started == 1) {
+		pthread_mutex_lock(&async->mutex);
+		while (async->pending > 0) pthread_cond_wait(&async->cond, &async->mutex);
+		async->stop = 1;
+		pthread_cond_broadcast(&async->cond);
+		pthread_mutex_unlock(&async->mutex);
+		pthread_join(async->thread, NULL);
+		pthread_mutex_destroy(&async->mutex);
+		pthread_cond_destroy(&async->cond);
+	}
+	if (async->direct == 1) close(async->fd);
+	if (async->pending > 0) return;
+	for (uint8_t i = 0; i < ASYNC_DEPTH; i++) free(async->blocks[i].buffer);
+	free(async);
+}
+#endif
+
+void ts_input_open(ts_input_t *input, int fd) {
+	memset(input, 0, sizeof(ts_input_t));
+	input->fd = fd;
+	if (fd < 0) return;
+
+#ifndef _WIN32
+	struct stat st;
+	uint8_t regular = (fstat(fd, &st) == 0) && (S_ISREG(st.st_mode));
+	if ((regular == 1) && (config_async == 1) && (async_open(input, fd, st.st_size) == 0)) return;
+	if ((regular == 1) && (st.st_size >= TS_PACKET_SIZE) && ((uint64_t)st.st_size <= SIZE_MAX)) {
+		void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (map != MAP_FAILED) {
+			posix_madvise(map, st.st_size, POSIX_MADV_SEQUENTIAL);
+			input->map = map;
+			input->map_size = st.st_size;
+			VERBOSE fprintf(stderr, "- Input is a regular file, memory-mapped %"PRIu64" bytes\n", (uint64_t)st.st_size);
+			return;
+		}
+	}
+#endif
+
+	if (posix_memalign((void **)&input->buffer, 4096, INPUT_BLOCK_SIZE) != 0) {
+		fprintf(stderr, "- Could not allocate input buffer\n");
+		exit(EXIT_FAILURE);
+	}
+}
+
+// opens live input udp://[SOURCE@]ADDRESS:PORT or rtp://[SOURCE@]ADDRESS:PORT; multicast ADDRESS is joined
+// (source-specific if SOURCE given), IPv6 addresses are in brackets; returns -1 on failure
+int ts_input_open_udp(ts_input_t *input, const char *url) {
+#ifdef _WIN32
+	fprintf(stderr, "- UDP input is not supported on this platform\n");
+	return -1;
+#else
+	uint8_t rtp_only = 0;
+	if (strncmp(url, "rtp://", 6) == 0) rtp_only = 1;
+	else if (strncmp(url, "udp://", 6) != 0) {
+		fprintf(stderr, "- Invalid UDP input URL %s (udp:// or rtp:// expected)\n", url);
+		return -1;
+	}
+
+	char spec[256];
+	snprintf(spec, sizeof(spec), "%s", url + 6);
+	char *source = NULL;
+	char *host = strrchr(spec, '@');
+	if (host != NULL) {
+		*host++ = '\0';
+		if (spec[0] != '\0') source = spec;
+	}
+	else host = spec;
+	char *port = NULL;
+	if (host[0] == '[') {
+		host++;
+		port = strchr(host, ']');
+		if (port != NULL) *port++ = '\0';
+	}
+	else port = strrchr(host, ':');
+	if ((port == NULL) || (*port != ':')) {
+		fprintf(stderr, "- Invalid UDP input URL %s (port missing)\n", url);
+		return -1;
+	}
+	*port++ = '\0';
+
+	struct addrinfo hints;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_DGRAM;
+	hints.ai_flags = AI_PASSIVE;
+	struct addrinfo *address = NULL;
+	int r = getaddrinfo((host[0] != '\0') ? host : NULL, port, &hints, &address);
+	if (r != 0) {
+		fprintf(stderr, "- Could not resolve UDP input address %s (%s)\n", url, gai_strerror(r));
+		return -1;
+	}
+
+	int fd = socket(address->ai_family, SOCK_DGRAM, 0);
+	if (fd < 0) {
+		fprintf(stderr, "- Could not create UDP socket (%s)\n", strerror(errno));
+		freeaddrinfo(address);
+		return -1;
+	}
+
+	// more receivers (e.g. one per channel) may share a multicast group
+	int on = 1;
+	setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+#ifdef SO_RXQ_OVFL
+	// number of datagrams dropped by kernel comes with each datagram
+	setsockopt(fd, SOL_SOCKET, SO_RXQ_OVFL, &on, sizeof(on));
+#endif
+	// receive times out, so graceful exit and statistics requests are served even without data
+	struct timeval timeout = { 1, 0 };
+	setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+	if (config_udp_buffer > 0) {
+		int size = config_udp_buffer;
+		setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+		socklen_t length = sizeof(size);
+#ifdef SO_RCVBUFFORCE
+		// above net.core.rmem_max with CAP_NET_ADMIN only
+		if ((getsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, &length) == 0) && (size < config_udp_buffer)) {
+			size = config_udp_buffer;
+			setsockopt(fd, SOL_SOCKET, SO_RCVBUFFORCE, &size, sizeof(size));
+		}
+#endif
+		length = sizeof(size);
+		if ((getsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, &length) == 0) && (size < config_udp_buffer))
+			fprintf(stderr, "- UDP receive buffer is only %d bytes (limited by system, see net.core.rmem_max)\n", size);
+	}
+
+	if (bind(fd, address->ai_addr, address->ai_addrlen) < 0) {
+		fprintf(stderr, "- Could not bind UDP socket to %s (%s)\n", url, strerror(errno));
+		close(fd);
+		freeaddrinfo(address);
+		return -1;
+	}
+
+	r = 0;
+	if (address->ai_family == AF_INET) {
+		struct in_addr group = ((struct sockaddr_in *)address->ai_addr)->sin_addr;
+		if (IN_MULTICAST(ntohl(group.s_addr))) {
+			if (source != NULL) {
+				struct ip_mreq_source mreq;
+				memset(&mreq, 0, sizeof(mreq));
+				mreq.imr_multiaddr = group;
+				mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+				if (inet_pton(AF_INET, source, &mreq.imr_sourceaddr) != 1) {
+					fprintf(stderr, "- Invalid multicast source address %s\n", source);
+					r = -1;
+				}
+				else r = setsockopt(fd, IPPROTO_IP, IP_ADD_SOURCE_MEMBERSHIP, &mreq, sizeof(mreq));
+			}
+			else {
+				struct ip_mreq mreq;
+				mreq.imr_multiaddr = group;
+				mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+				r = setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq));
+			}
+		}
+	}
+	else if (address->ai_family == AF_INET6) {
+		struct in6_addr group = ((struct sockaddr_in6 *)address->ai_addr)->sin6_addr;
+		if (IN6_IS_ADDR_MULTICAST(&group)) {
+			struct ipv6_mreq mreq;
+			mreq.ipv6mr_multiaddr = group;
+			mreq.ipv6mr_interface = 0;
+			r = setsockopt(fd, IPPROTO_IPV6, IPV6_JOIN_GROUP, &mreq, sizeof(mreq));
+		}
+	}
+	freeaddrinfo(address);
+	if (r < 0) {
+		if (errno != 0) fprintf(stderr, "- Could not join multicast group %s (%s)\n", url, strerror(errno));
+		close(fd);
+		return -1;
+	}
+
+	ts_input_open(input, fd);
+	input->udp = 1;
+	input->rtp_only = rtp_only;
+	VERBOSE fprintf(stderr, "- Receiving %s from %s\n", (rtp_only == 1) ? "RTP" : "UDP", url);
+	return 0;
+#endif
+}
+
+#ifndef _WIN32
+// RFC 3550, chapter 5.1: strips RTP header (with CSRCs, extension and padding) and counts datagrams missing
+// in sequence; returns payload size, payload starts at *offset
+size_t rtp_payload(ts_input_t *input, const uint8_t *data, size_t size, size_t *offset) {
+	uint8_t csrc_count = data[0] & 0x0f;
+	size_t header = 12 + 4 * csrc_count;
+	if (((data[0] & 0x10) > 0) && (header + 4 <= size)) header += 4 + 4 * ((data[header + 2] << 8) | data[header + 3]);
+	size_t padding = ((data[0] & 0x20) > 0) ? data[size - 1] : 0;
+	if (header + padding > size) {
+		input->udp_stats.malformed++;
+		return 0;
+	}
+
+	uint16_t sequence = (data[2] << 8) | data[3];
+	if (input->rtp_sequence_valid == 1) {
+		uint16_t lost = sequence - (uint16_t)(input->rtp_sequence + 1);
+		// datagrams reordered or repeated are not losses
+		if (lost < 0x8000) input->udp_stats.rtp_lost += lost;
+	}
+	input->rtp_sequence = sequence;
+	input->rtp_sequence_valid = 1;
+	input->udp_stats.rtp_datagrams++;
+
+	*offset = header;
+	return size - header - padding;
+}
+
+// receives queued datagrams (waits for the first one) into slots behind carry in input buffer and packs their TS
+// payloads right after carry (size bytes); returns number of bytes at buffer start, 0 on exit request or error
+size_t udp_receive(ts_input_t *input, size_t size) {
+	// slots lie behind the largest possible carry, so packed payloads never overrun a slot not processed yet
+	uint8_t *slots = input->buffer + TS_PACKET_SIZE;
+	struct iovec iovecs[UDP_BATCH];
+	uint64_t controls[UDP_BATCH][8];
+	struct msghdr *messages[UDP_BATCH];
+	uint32_t sizes[UDP_BATCH];
+	int count = 0;
+
+#if defined(__linux__)
+	// all datagrams queued are received by one syscall
+	struct mmsghdr mmsgs[UDP_BATCH];
+	memset(mmsgs, 0, sizeof(mmsgs));
+	for (uint16_t i = 0; i < UDP_BATCH; i++) {
+		iovecs[i].iov_base = slots + i * UDP_DATAGRAM_SIZE;
+		iovecs[i].iov_len = UDP_DATAGRAM_SIZE;
+		messages[i] = &mmsgs[i].msg_hdr;
+		messages[i]->msg_iov = &iovecs[i];
+		messages[i]->msg_iovlen = 1;
+		messages[i]->msg_control = controls[i];
+		messages[i]->msg_controllen = sizeof(controls[i]);
+	}
+	while (count <= 0) {
+		if (exit_request == 1) return 0;
+		count = recvmmsg(input->fd, mmsgs, UDP_BATCH, MSG_WAITFORONE, NULL);
+		if ((count < 0) && (errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)) {
+			fprintf(stderr, "- UDP receive error (%s)\n", strerror(errno));
+			return 0;
+		}
+	}
+	for (int i = 0; i < count; i++) sizes[i] = mmsgs[i].msg_len;
+#else
+	struct msghdr msg;
+	memset(&msg, 0, sizeof(msg));
+	iovecs[0].iov_base = slots;
+	iovecs[0].iov_len = UDP_DATAGRAM_SIZE;
+	messages[0] = &msg;
+	msg.msg_iov = &iovecs[0];
+	msg.msg_iovlen = 1;
+	while (count <= 0) {
+		if (exit_request == 1) return 0;
+		msg.msg_control = controls[0];
+		msg.msg_controllen = sizeof(controls[0]);
+		ssize_t r = recvmsg(input->fd, &msg, 0);
+		if (r >= 0) {
+			sizes[0] = r;
+			count = 1;
+		}
+		else if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)) {
+			fprintf(stderr, "- UDP receive error (%s)\n", strerror(errno));
+			return 0;
+		}
+	}
+#endif
+
+	for (int i = 0; i < count; i++) {
+		struct msghdr *message = messages[i];
+		uint8_t *data = iovecs[i].iov_base;
+		input->udp_stats.datagrams++;
+
+#ifdef SO_RXQ_OVFL
+		// kernel reports total number of datagrams dropped on socket so far
+		for (struct cmsghdr *c = CMSG_FIRSTHDR(message); c != NULL; c = CMSG_NXTHDR(message, c))
+			if ((c->cmsg_level == SOL_SOCKET) && (c->cmsg_type == SO_RXQ_OVFL)) {
+				uint32_t drops = 0;
+				memcpy(&drops, CMSG_DATA(c), sizeof(drops));
+				input->udp_stats.kernel_drops += (uint32_t)(drops - input->kernel_drops);
+				input->kernel_drops = drops;
+			}
+#endif
+
+		if (((message->msg_flags & MSG_TRUNC) > 0) || (sizes[i] == 0)) {
+			input->udp_stats.malformed++;
+			continue;
+		}
+
+		// RTP (RFC 2250) is recognised by version 2 in place of TS sync byte
+		size_t offset = 0;
+		size_t payload = sizes[i];
+		if ((input->rtp_only == 1) || ((data[0] != 0x47) && ((data[0] & 0xc0) == 0x80))) {
+			if ((sizes[i] < 12) || ((data[0] & 0xc0) != 0x80)) {
+				input->udp_stats.malformed++;
+				continue;
+			}
+			payload = rtp_payload(input, data, sizes[i], &offset);
+		}
+
+		memmove(input->buffer + size, data + offset, payload);
+		size += payload;
+	}
+
+	return size;
+}
+#endif
+
+// returns number of bytes available at *block (always multiple of TS_PACKET_SIZE), 0 at the end of input
+size_t ts_input_read(ts_input_t *input, const uint8_t **block) {
+#ifndef _WIN32
+	if (input->async != NULL) return async_read(input, block);
+#endif
+	if (input->map != NULL) {
+		size_t size = input->map_size - input->map_offset;
+		if (size > INPUT_BLOCK_SIZE) size = INPUT_BLOCK_SIZE;
+		size -= size % TS_PACKET_SIZE;
+		*block = input->map + input->map_offset;
+		input->map_offset += size;
+		return size;
+	}
+
+	// incomplete TS packet left from previous block goes first
+	size_t size = input->carry_size;
+	memcpy(input->buffer, input->carry, size);
+
+#ifndef _WIN32
+	if (input->udp == 1) size = udp_receive(input, size);
+	else
+#endif
+	while (size < INPUT_BLOCK_SIZE) {
+		ssize_t r = read(input->fd, input->buffer + size, INPUT_BLOCK_SIZE - size);
+		if (r < 0) {
+			if (errno == EINTR) {
+				if (exit_request == 1) break;
+				continue;
+			}
+			fprintf(stderr, "- Input read error (%s)\n", strerror(errno));
+			break;
+		}
+		if (r == 0) break;
+		size += r;
+		// return as soon as there is something to process, do not wait for a full block on live pipes
+		if (size >= TS_PACKET_SIZE) break;
+	}
 
-// size of a TS packet in bytes
-#define TS_PACKET_SIZE 188
+	input->carry_size = size % TS_PACKET_SIZE;
+	size -= input->carry_size;
+	memcpy(input->carry, input->buffer + size, input->carry_size);
 
-// size of a TS packet payload in bytes
-#define TS_PACKET_PAYLOAD_SIZE 184
+	*block = input->buffer;
+	return size;
+}
 
-typedef struct {
-	uint8_t _clock_run_in; // not needed
-	uint8_t _framing_code; // not needed, ETSI 300 706: const 0xe4
-	uint8_t address[2];
-	uint8_t data[40];
-} teletext_packet_payload_t;
+void ts_input_close(ts_input_t *input) {
+#ifndef _WIN32
+	if (input->async != NULL) async_close(input->async);
+	if (input->map != NULL) munmap(input->map, input->map_size);
+	if (input->udp == 1) close(input->fd);
+#endif
+	free(input->buffer);
+	memset(input, 0, sizeof(ts_input_t));
+}
 
-typedef struct {
-	uint64_t show_timestamp; // show at timestamp (in ms)
-	uint64_t hide_timestamp; // hide at timestamp (in ms)
-	uint16_t text[25][40]; // 25 lines x 40 cols (1 screen/page) of wide chars
-	uint8_t tainted; // 1 = text variable contains any data
-} teletext_page_t;
+// keeps teletext stream found in input for final report
+void add_job_stream(job_t *job, uint16_t pid, const uint8_t *cc_map) {
+	uint8_t i = 0;
+	while ((i < job->streams_count) && (job->stream_pids[i] != pid)) i++;
+	if (i == TELXCC_MAX_STREAMS) return;
+	if (i == job->streams_count) {
+		job->stream_pids[job->streams_count++] = pid;
+		memset(job->stream_cc_maps[i], 0, 256);
+	}
+	for (uint16_t j = 0; j < 256; j++) job->stream_cc_maps[i][j] |= cc_map[j];
+}
 
-// be verbose?
-uint16_t config_verbose = 0;
-#define VERBOSE if (config_verbose > 0)
+// index file is valid for input of the same size and modification time only
+void index_identify(packet_index_t *index, int fd) {
+	struct stat st;
+	if (fstat(fd, &st) != 0) return;
+	index->input_size = st.st_size;
+#ifndef _WIN32
+	index->input_mtime_s = st.st_mtim.tv_sec;
+	index->input_mtime_ns = st.st_mtim.tv_nsec;
+#else
+	index->input_mtime_s = st.st_mtime;
+#endif
+}
 
-// teletext page containing cc we want to filter
-uint16_t config_page = 0;
+// index file: INDEX_MAGIC, input size, input mtime (s, ns), all PIDs flag, PIDs count, PIDs, runs count, runs;
+// little-endian (see endianness test)
+int index_write(const packet_index_t *index, const char *path) {
+	output_buffer_t data = { NULL, 0, 0 };
+	output_append_literal(&data, INDEX_MAGIC);
+	output_append(&data, (const char *)&index->input_size, 8);
+	output_append(&data, (const char *)&index->input_mtime_s, 8);
+	output_append(&data, (const char *)&index->input_mtime_ns, 8);
+	output_append(&data, (const char *)&index->all_pids, 1);
+	output_append(&data, (const char *)&index->pids_count, 1);
+	for (uint8_t i = 0; i < index->pids_count; i++) output_append(&data, (const char *)&index->pids[i], 2);
+	output_append(&data, (const char *)&index->runs_count, 8);
+	for (uint64_t i = 0; i < index->runs_count; i++) {
+		const index_run_t *run = &index->runs[i];
+		output_append(&data, (const char *)&run->position, 8);
+		output_append(&data, (const char *)&run->pcr, 4);
+		output_append(&data, (const char *)&run->pid, 2);
+		output_append(&data, (const char *)&run->packets, 2);
+		output_append(&data, (const char *)&run->stride, 2);
+	}
 
-// 13-bit packet ID for teletext stream
-uint16_t config_tid = 0;
+	// written aside and renamed, so a valid index is never overwritten by a partial one
+	char *tmp = malloc(strlen(path) + 5);
+	if (tmp == NULL) {
+		free(data.data);
+		return -1;
+	}
+	sprintf(tmp, "%s.tmp", path);
+	int r = -1;
+	int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd >= 0) {
+		r = output_flush(&data, fd);
+		if (close(fd) != 0) r = -1;
+		if ((r == 0) && (rename(tmp, path) != 0)) r = -1;
+		if (r < 0) unlink(tmp);
+	}
+	if (r < 0) fprintf(stderr, "- Could not write packet index %s (%s)\n", path, strerror(errno));
+	free(tmp);
+	free(data.data);
+	return r;
+}
 
-// time offset in seconds
-double config_offset = 0;
+// returns 1 if index file is valid for input (its runs are then in index), 0 if not
+int index_read(packet_index_t *index, const char *path, int input_fd) {
+	packet_index_t input;
+	memset(&input, 0, sizeof(packet_index_t));
+	index_identify(&input, input_fd);
+
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) return 0;
+	struct stat st;
+	uint8_t *data = NULL;
+	size_t size = 0;
+	if ((fstat(fd, &st) == 0) && ((uint64_t)st.st_size <= SIZE_MAX) && ((data = malloc(st.st_size + 1)) != NULL)) {
+		while (size < (size_t)st.st_size) {
+			ssize_t r = read(fd, data + size, st.st_size - size);
+			if ((r < 0) && (errno == EINTR)) continue;
+			if (r <= 0) break;
+			size += r;
+		}
+	}
+	close(fd);
+
+	// header and runs, each field checked against size left
+	const uint8_t *p = data;
+	const uint8_t *end = data + size;
+	#define INDEX_LOAD(field, n) do { if (end - p < (n)) goto invalid; memcpy(&(field), p, (n)); p += (n); } while (0)
+	char magic[8];
+	INDEX_LOAD(magic, 8);
+	if (memcmp(magic, INDEX_MAGIC, 8) != 0) goto invalid;
+	INDEX_LOAD(index->input_size, 8);
+	INDEX_LOAD(index->input_mtime_s, 8);
+	INDEX_LOAD(index->input_mtime_ns, 8);
+	if ((index->input_size != input.input_size) || (index->input_mtime_s != input.input_mtime_s) || (index->input_mtime_ns != input.input_mtime_ns)) goto invalid;
+	INDEX_LOAD(index->all_pids, 1);
+	INDEX_LOAD(index->pids_count, 1);
+	if (index->pids_count > TELXCC_MAX_STREAMS) goto invalid;
+	for (uint8_t i = 0; i < index->pids_count; i++) INDEX_LOAD(index->pids[i], 2);
+	INDEX_LOAD(index->runs_count, 8);
+	// runs count is checked before multiplying, so that neither size can overflow
+	if (index->runs_count > (uint64_t)(end - p) / 18) goto invalid;
+	if ((uint64_t)(end - p) != index->runs_count * 18) goto invalid;
+	if (index->runs_count > SIZE_MAX / sizeof(index_run_t)) goto invalid;
+	index->runs = malloc((index->runs_count > 0 ? (size_t)index->runs_count : 1) * sizeof(index_run_t));
+	if (index->runs == NULL) goto invalid;
+	index->runs_capacity = index->runs_count;
+	for (uint64_t i = 0; i < index->runs_count; i++) {
+		index_run_t *run = &index->runs[i];
+		INDEX_LOAD(run->position, 8);
+		INDEX_LOAD(run->pcr, 4);
+		INDEX_LOAD(run->pid, 2);
+		INDEX_LOAD(run->packets, 2);
+		INDEX_LOAD(run->stride, 2);
+		uint64_t span = (uint64_t)(run->packets - 1) * run->stride + TS_PACKET_SIZE;
+		if ((run->packets == 0) || (run->stride < TS_PACKET_SIZE) || (span > INPUT_BLOCK_SIZE) || (run->position + span > index->input_size)) goto invalid;
+		index->packets += run->packets;
+	}
+	#undef INDEX_LOAD
+	free(data);
+	return 1;
+
+	invalid:
+	free(data);
+	free(index->runs);
+	memset(index, 0, sizeof(packet_index_t));
+	return 0;
+}
 
-// output <font...></font> tags?
-uint8_t config_colours = 0;
+// index of other streams (e.g. of another -t) is of no use
+int index_covers(const packet_index_t *index) {
+	if (config.all_pids == 1) return index->all_pids;
+	if (config.pid == 0) return (index->pids_count > 0);
+	for (uint8_t i = 0; i < index->pids_count; i++)
+		if (index->pids[i] == config.pid) return 1;
+	return 0;
+}
 
-// SRT frames produced
-uint32_t frames_produced = 0;
+// synthetic TS packet carrying just PCR (adaptation field only, null PID)
+void pcr_packet(uint8_t *packet, uint32_t pcr) {
+	uint64_t base = (uint64_t)pcr * 90;
+	memset(packet, 0xff, TS_PACKET_SIZE);
+	packet[0] = 0x47;
+	packet[1] = 0x1f;
+	packet[2] = 0xff;
+	packet[3] = 0x20;
+	packet[4] = TS_PACKET_SIZE - 5;
+	packet[5] = 0x10;
+	packet[6] = base >> 25;
+	packet[7] = base >> 17;
+	packet[8] = base >> 9;
+	packet[9] = base >> 1;
+	packet[10] = ((base & 0x01) << 7) | 0x7e;
+	packet[11] = 0x00;
+}
 
-// subtitle type pages bitmap
-uint8_t cc_map[256] = { 0 };
+// decodes TS packets listed in index only; they are read by pread() of ranges, and pushed as 188-byte packets
+// preceded by TS PCR they were received at
+void decode_index(job_t *job, int fd, const packet_index_t *index) {
+	telxcc_config_t index_config = config;
+	index_config.packet_size = TS_PACKET_SIZE;
+	telxcc_decoder_t *decoder = telxcc_create(&index_config, caption_callback, job);
+	uint8_t *buffer = NULL;
+	if ((decoder == NULL) || (posix_memalign((void **)&buffer, 4096, INPUT_BLOCK_SIZE) != 0)) {
+		fprintf(stderr, "- Could not allocate decoder\n");
+		exit(EXIT_FAILURE);
+	}
 
-// global TS PCR value
-uint32_t global_timestamp = 0;
+	// null packets: decoder locks on packet stream however few packets follow
+	uint8_t packet[TS_PACKET_SIZE];
+	memset(packet, 0xff, TS_PACKET_SIZE);
+	memcpy(packet, "\x47\x1f\xff\x10", 4);
+	for (uint8_t i = 0; i < 8; i++) telxcc_push(decoder, packet, TS_PACKET_SIZE);
+
+	uint64_t pcr = UINT64_MAX;
+	sig_atomic_t store_requests_seen = store_requests;
+	uint64_t t = clock_ns();
+	for (uint64_t i = 0; (exit_request == 0) && (job->failed == 0) && (i < index->runs_count);) {
+		// runs close to each other are read at once
+		uint64_t start = index->runs[i].position;
+		uint64_t j = i;
+		uint64_t end = start;
+		while (j < index->runs_count) {
+			const index_run_t *run = &index->runs[j];
+			uint64_t run_end = run->position + (uint64_t)(run->packets - 1) * run->stride + TS_PACKET_SIZE;
+			if ((j > i) && ((run->position < end) || (run->position > end + INDEX_GAP) || (run_end - start > INPUT_BLOCK_SIZE))) break;
+			end = run_end;
+			j++;
+		}
 
-// ETS 300 706, chapter 8.2
-inline uint8_t unham_8_4(uint8_t a) {
-	return (UNHAM_8_4[a] & 0x0f);
-}
+		size_t size = 0;
+		while (size < end - start) {
+#ifndef _WIN32
+			ssize_t r = pread(fd, buffer + size, end - start - size, start + size);
+#else
+			// index is used with memory-mapped input only, which is not available here
+			ssize_t r = -1;
+#endif
+			if ((r < 0) && (errno == EINTR)) continue;
+			if (r <= 0) {
+				fprintf(stderr, "- Input read error (%s)\n", (r < 0) ? strerror(errno) : "unexpected end of input");
+				job->failed = 1;
+				break;
+			}
+			size += r;
+		}
+		uint64_t now = clock_ns();
+		job->read_ns += now - t;
+		t = now;
+
+		for (; (job->failed == 0) && (i < j); i++) {
+			const index_run_t *run = &index->runs[i];
+			if (run->pcr != pcr) {
+				pcr = run->pcr;
+				pcr_packet(packet, run->pcr);
+				telxcc_push(decoder, packet, TS_PACKET_SIZE);
+			}
+			const uint8_t *data = buffer + (run->position - start);
+			for (uint16_t k = 0; k < run->packets; k++, data += run->stride)
+				if (telxcc_push(decoder, data, TS_PACKET_SIZE) < 0) job->failed = 1;
+		}
 
-// ETS 300 706, chapter 8.3
-inline uint32_t unham_24_18(uint32_t a) {
-	uint8_t B0 = a & 0xff;
-	uint8_t B1 = (a >> 8) & 0xff;
-	uint8_t B2 = (a >> 16) & 0xff;
+		now = clock_ns();
+		job->decode_ns += now - t;
+		t = now;
 
-	uint8_t D1_D4 = UNHAM_24_18_D1_D4[B0 >> 2];
-	uint8_t D5_D11 = B1 & 0x7f;
-	uint8_t D12_D18 = B2 & 0x7f;
+		if ((config_store != NULL) && (store_requests != store_requests_seen)) {
+			store_requests_seen = store_requests;
+			print_store(job, decoder, 0);
+		}
+	}
+	telxcc_flush(decoder);
+	free(buffer);
+	if (config_store != NULL) print_store(job, decoder, 1);
+
+	telxcc_stats_t stats;
+	telxcc_get_stats(decoder, &stats);
+	job->packets += stats.packets;
+	add_stats(&job->stats, &stats);
+	telxcc_stream_info_t info;
+	for (uint8_t k = 0; telxcc_get_stream_info(decoder, k, &info) > 0; k++) add_job_stream(job, info.pid, info.cc_map);
+	telxcc_destroy(decoder);
+}
 
-	uint32_t d = D1_D4 | (D5_D11 << 4) | (D12_D18 << 11);
-	uint8_t ABCDEF = UNHAM_24_18_PAR[0][B0] ^ UNHAM_24_18_PAR[1][B1] ^ UNHAM_24_18_PAR[2][B2];
-	uint32_t r = d ^ UNHAM_24_18_ERR[ABCDEF];
+// decodes whole input sequentially
+// pipelined mode: reader thread hands input blocks over to decoder thread
+void *pipeline_reader(void *arg) {
+	pipeline_t *pipeline = arg;
+	ts_input_t *input = pipeline->input;
+	const uint8_t *block = NULL;
+	size_t block_size = 0;
+	uint64_t t = clock_ns();
+
+	while ((block_size = ts_input_read(input, &block)) > 0) {
+		uint64_t now = clock_ns();
+		__atomic_fetch_add(&pipeline->read_ns, now - t, __ATOMIC_RELAXED);
+
+		// memory-mapped input stays valid, other input is copied (into more slots if needed)
+		for (size_t offset = 0; offset < block_size;) {
+			int32_t slot = ring_acquire(&pipeline->input_ring, PIPELINE_INPUT_SLOTS);
+			if (slot < 0) goto reader_stopped;
+			pipeline_block_t *b = &pipeline->blocks[slot];
+			size_t size = block_size - offset;
+			if (input->map != NULL) b->data = block + offset;
+			else {
+				if (size > INPUT_BLOCK_SIZE) size = INPUT_BLOCK_SIZE;
+				memcpy(b->buffer, block + offset, size);
+				b->data = b->buffer;
+			}
+			b->size = size;
+			offset += size;
+			ring_publish(&pipeline->input_ring);
+		}
+		t = clock_ns();
+	}
+	reader_stopped:
+	ring_finish(&pipeline->input_ring);
+	return NULL;
+}
 
-	//fprintf(stderr, "> UNHAM24/18 A=%08x, R=%08x, CHECK=%08x\n", a, r, (((a & 0x04) >> 2) | ((a & 0x70) >> 3) | ((a & 0x7f00) >> 4) | ((a & 0x7f0000) >> 5)));
-	return r;
+// pipelined mode: writer thread writes output batches in order they were formatted
+void *pipeline_writer(void *arg) {
+	pipeline_t *pipeline = arg;
+	int32_t slot;
+	while ((slot = ring_peek(&pipeline->output_ring, PIPELINE_OUTPUT_SLOTS)) >= 0) {
+		pipeline_batch_t *batch = &pipeline->batches[slot];
+		size_t offset = 0;
+		for (uint16_t i = 0; i < batch->segments_count; i++) {
+			output_buffer_t segment = { batch->data.data + offset, batch->sizes[i], batch->sizes[i] };
+			// after write error the rest of output is dropped
+			if ((pipeline->write_failed == 0) && (output_flush(&segment, batch->fds[i]) < 0)) pipeline->write_failed = 1;
+			offset += batch->sizes[i];
+		}
+		ring_release(&pipeline->output_ring);
+	}
+	return NULL;
 }
 
-inline void timestamp_to_srttime(uint64_t timestamp, char *buffer) {
-	uint64_t p = timestamp;
-	uint8_t h = p / 3600000;
-	uint8_t m = p / 60000 - 60 * h;
-	uint8_t s = p / 1000 - 3600 * h - 60 * m;
-	uint16_t u = p - 3600000 * h - 60000 * m - 1000 * s;
-	sprintf(buffer, "%02"PRIu8":%02"PRIu8":%02"PRIu8",%03"PRIu16, h, m, s, u);
+void pipeline_free(pipeline_t *pipeline) {
+	for (uint16_t i = 0; i < PIPELINE_INPUT_SLOTS; i++) free(pipeline->blocks[i].buffer);
+	for (uint16_t i = 0; i < PIPELINE_OUTPUT_SLOTS; i++) free(pipeline->batches[i].data.data);
+	free(pipeline);
 }
 
-inline void ucs2_to_utf8(char *r, uint16_t ch) {
-	if (ch < 0x80) {
-		r[0] = ch;
-		r[1] = 0;
-		r[2] = 0;
-		r[3] = 0;
+// starts reader and writer threads of job; returns NULL if they could not be started (job is not pipelined)
+pipeline_t *pipeline_start(job_t *job, ts_input_t *input) {
+	// rings are cache line aligned, calloc() would not keep them so
+	pipeline_t *pipeline;
+	if (posix_memalign((void **)&pipeline, CACHE_LINE_SIZE, sizeof(pipeline_t)) != 0) return NULL;
+	memset(pipeline, 0, sizeof(pipeline_t));
+	pipeline->input = input;
+	if (input->map == NULL) for (uint16_t i = 0; i < PIPELINE_INPUT_SLOTS; i++) {
+		if (posix_memalign((void **)&pipeline->blocks[i].buffer, 4096, INPUT_BLOCK_SIZE) != 0) {
+			pipeline_free(pipeline);
+			return NULL;
+		}
 	}
-	else if (ch < 0x800) {
-		r[0] = (ch >> 6) | 0xc0;
-		r[1] = (ch & 0x3f) | 0x80;
-		r[2] = 0;
-		r[3] = 0;
+	for (uint16_t i = 0; i < PIPELINE_OUTPUT_SLOTS; i++) output_reserve(&pipeline->batches[i].data, PIPELINE_BATCH_SIZE + OUTPUT_BUFFER_SIZE);
+
+	if (pthread_create(&pipeline->writer, NULL, pipeline_writer, pipeline) != 0) {
+		pipeline_free(pipeline);
+		return NULL;
 	}
-	else {
-		r[0] = (ch >> 12) | 0xe0;
-		r[1] = ((ch >> 6) & 0x3f) | 0x80;
-		r[2] = (ch & 0x3f) | 0x80;
-		r[3] = 0;
+	if (pthread_create(&pipeline->reader, NULL, pipeline_reader, pipeline) != 0) {
+		ring_finish(&pipeline->output_ring);
+		pthread_join(pipeline->writer, NULL);
+		pipeline_free(pipeline);
+		return NULL;
 	}
+	VERBOSE fprintf(stderr, "- Pipelined mode: input is read, decoded and output written by threads of their own\n");
+	job->pipeline = pipeline;
+	job->pipelined = 1;
+	return pipeline;
 }
 
-// check parity and translate any reasonable teletext character into ucs2
-uint16_t telx_to_ucs2(uint8_t c) {
-	if (PARITY_8[c] == 0) return 32;
+// decoder thread takes next input block; output of the previous one is handed over to writer thread
+size_t pipeline_read(pipeline_t *pipeline, const uint8_t **block, uint8_t *holding) {
+	if (*holding == 1) {
+		ring_release(&pipeline->input_ring);
+		*holding = 0;
+	}
+	pipeline_output_publish(pipeline);
+
+	int32_t slot = ring_peek(&pipeline->input_ring, PIPELINE_INPUT_SLOTS);
+	if (slot < 0) return 0;
+	*holding = 1;
+	*block = pipeline->blocks[slot].data;
+	return pipeline->blocks[slot].size;
+}
 
-	uint16_t r = c & 0x7f;
-	if (r >= 32) r = G0[LATIN][r - 32];
-	return r;
+// stops reader, writes output queued and joins both threads
+void pipeline_finish(job_t *job) {
+	pipeline_t *pipeline = job->pipeline;
+	// decoding may end before input does
+	ring_stop(&pipeline->input_ring);
+	pthread_join(pipeline->reader, NULL);
+	pipeline_output_publish(pipeline);
+	ring_finish(&pipeline->output_ring);
+	pthread_join(pipeline->writer, NULL);
+
+	if (pipeline->write_failed == 1) job->failed = 1;
+	job->read_ns += pipeline->read_ns;
+	get_pipeline_stats(job, &job->pipeline_stats);
+	VERBOSE fprintf(stderr, "- Pipeline backpressure: input ring full %"PRIu64" times, empty %"PRIu64" times; output ring full %"PRIu64" times, empty %"PRIu64" times\n",
+		job->pipeline_stats.input_full, job->pipeline_stats.input_empty, job->pipeline_stats.output_full, job->pipeline_stats.output_empty);
+	job->pipeline = NULL;
+	pipeline_free(pipeline);
 }
 
-void process_page(const teletext_page_t *page_buffer) {
-#ifdef DEBUG
-	for (uint8_t row = 1; row < 25; row++) {
-		fprintf(stdout, "DEBUG[%02u]: ", row);
-		for (uint8_t col = 0; col < 40; col++) fprintf(stdout, "%3x ", page_buffer->text[row][col]);
-		fprintf(stdout, "\n");
+void decode_input(job_t *job, ts_input_t *input) {
+	telxcc_config_t input_config = config;
+	input_config.packet_events = (job->index != NULL);
+	telxcc_decoder_t *decoder = telxcc_create(&input_config, caption_callback, job);
+	if (decoder == NULL) {
+		fprintf(stderr, "- Could not allocate decoder\n");
+		exit(EXIT_FAILURE);
 	}
-	fprintf(stdout, "\n");
-#endif
 
-	// optimalization: slicing column by column -- higher probability we could find boxed area start mark sooner
-	uint8_t page_is_empty = 1;
-	for (uint8_t col = 0; col < 40; col++)
-		for (uint8_t row = 1; row < 25; row++)
-			if (page_buffer->text[row][col] == 0x0b) {
-				page_is_empty = 0;
-				goto page_is_empty;
-			}
-	page_is_empty:
-	if (page_is_empty == 1) return;
-
-	char timecode_show[24] = { 0 };
-	timestamp_to_srttime(page_buffer->show_timestamp, timecode_show);
-	timecode_show[12] = 0;
-
-	char timecode_hide[24] = { 0 };
-	timestamp_to_srttime(page_buffer->hide_timestamp, timecode_hide);
-	timecode_hide[12] = 0;
-
-	// print SRT frame
-	//fprintf(stdout, "%"PRIu32"\r\n%s --> %s\r\n", ++frames_produced, timecode_show, timecode_hide);
-
-	// process data
-	for (uint8_t row = 1; row < 25; row++) {
-		uint8_t font_tag_opened = 0;
-		uint8_t in_boxed_area = 0;
-		// ETS 300 706, chapter 12.2: Alpha White ("Set-After") - Start-of-row default condition.
-		uint8_t foreground_color = 0x7;
-
-		// skip empty lines
-		uint8_t line_is_empty = 1;
-		for (uint8_t col = 0; col < 40; col++)
-			if (page_buffer->text[row][col] == 0x0b) {
-				line_is_empty = 0;
-				goto line_is_empty;
+	const uint8_t *block = NULL;
+	size_t block_size = 0;
+	sig_atomic_t stats_requests_seen = stats_requests;
+	sig_atomic_t store_requests_seen = store_requests;
+	uint64_t t = clock_ns();
+
+	// pipelined mode: input is read by reader thread, time waiting for it is not read time
+	pipeline_t *pipeline = (config_pipeline == 1) ? pipeline_start(job, input) : NULL;
+	uint8_t holding = 0;
+
+	// reading input; decoder is fed PUSH_SIZE at a time so graceful exit stops processing almost immediately
+	while ((exit_request == 0) && ((block_size = (pipeline != NULL) ? pipeline_read(pipeline, &block, &holding) : ts_input_read(input, &block)) > 0)) {
+		uint64_t now = clock_ns();
+		if (pipeline == NULL) job->read_ns += now - t;
+		t = now;
+
+		for (size_t offset = 0; (exit_request == 0) && (offset < block_size); offset += PUSH_SIZE) {
+			if (telxcc_push(decoder, block + offset, (block_size - offset < PUSH_SIZE) ? block_size - offset : PUSH_SIZE) < 0) {
+				job->failed = 1;
+				goto input_failed;
 			}
-		line_is_empty:
-		if (line_is_empty == 1) continue;
+		}
 
-		for (uint8_t col = 0; col < 40; col++) {
-			uint16_t v = page_buffer->text[row][col];
+		now = clock_ns();
+		job->decode_ns += now - t;
+		t = now;
 
-			// last column -- close font tag
-			if (col == 39) {
-				if ((config_colours == 1) && (font_tag_opened == 1)) {
-					fprintf(stdout, "</font> ");
-					font_tag_opened = 0;
-				}
-				in_boxed_area = 0;
-				continue;
-			}
+		if ((config_stats != NULL) && (stats_requests != stats_requests_seen)) {
+			stats_requests_seen = stats_requests;
+			telxcc_stats_t stats;
+			telxcc_get_stats(decoder, &stats);
+			uint64_t read_ns = job->read_ns + ((pipeline != NULL) ? __atomic_load_n(&pipeline->read_ns, __ATOMIC_RELAXED) : 0);
+			print_stats(job, &stats, read_ns, job->decode_ns, -1, 0);
+		}
+		if ((config_store != NULL) && (store_requests != store_requests_seen)) {
+			store_requests_seen = store_requests;
+			print_store(job, decoder, 0);
+		}
+	}
+	input_failed:
+	// captions held for retransmissions are complete
+	telxcc_flush(decoder);
+	if (pipeline != NULL) pipeline_finish(job);
+	if (config_store != NULL) print_store(job, decoder, 1);
 
-			// colours
-			// white is default as stated in ETS 300 706, chapter 12.2
-			// black is considered as white for telxcc purpose
-			// telxcc writes <font/> tags only when needed
-			// black(0), red, green, yellow, blue, magenta, cyan, white
-			if ((v >= 0x01) && (v <= 0x07)) {
-				if (config_colours == 1) {
-					if (font_tag_opened == 1) {
-						fprintf(stdout, "</font> ");
-						font_tag_opened = 0;
-					}
-					if (v != foreground_color) {
-						fprintf(stdout, "<font color=\"%s\">", COLOURS[v]);
-						font_tag_opened = 1;
-						foreground_color = v;
-					}
-				}
-				// ETS 300 706, chapter 12.2: Unless operating in "Hold Mosaics" mode,
-				// each character space occupied by a spacing attribute is displayed as a SPACE.
-				else v = 32;
-			}
+	{
+		telxcc_stats_t stats;
+		telxcc_get_stats(decoder, &stats);
+		job->packets += stats.packets;
+		add_stats(&job->stats, &stats);
+	}
+	telxcc_stream_info_t info;
+	for (uint8_t k = 0; telxcc_get_stream_info(decoder, k, &info) > 0; k++) add_job_stream(job, info.pid, info.cc_map);
+	telxcc_destroy(decoder);
+}
 
-			// boxed area start
-			if (v == 0x0b) {
-				in_boxed_area = 1;
-				continue;
-			}
+// probe mode: input is read until PAT and all PMTs are received and the set of subtitle pages found has not changed
+// for PROBE_STABLE_MS of PCR time; at least PROBE_MIN_SIZE bytes are read when teletext streams listed in PMTs
+// are not found (or there is no PAT), at most PROBE_MAX_SIZE bytes
+#define PROBE_STABLE_MS 2000
+#define PROBE_MIN_SIZE (4 * 1024 * 1024)
+#define PROBE_MAX_SIZE (32 * 1024 * 1024)
 
-			// boxed area end
-			if (v == 0x0a) {
-				in_boxed_area = 0;
-				col = 38;
-				continue;
-			}
+// TS packets pushed between probe checks
+#define PROBE_CHECK_PACKETS 1024
 
-			// discard nonprintable chars
-			if (v < 32) continue;
+typedef struct {
+	uint32_t pcr;
+	uint8_t pcr_valid;
+} probe_clock_t;
+
+// teletext packet events carry PCR, the probe clock
+void probe_callback(void *user_data, const telxcc_event_t *event) {
+	probe_clock_t *clock = user_data;
+	if (event->type != TELXCC_EVENT_PACKET) return;
+	clock->pcr = event->pcr;
+	clock->pcr_valid = 1;
+}
 
-			// processing chars in boxed area
-			if (in_boxed_area == 1) {
-				char u[4] = {0, 0, 0, 0};
-				ucs2_to_utf8(u, v);
-				fprintf(stdout, "%s", u);
-			}
+const char *teletext_type_name(uint8_t type) {
+	// ETSI EN 300 468, chapter 6.2.43, table 94
+	static const char *NAMES[6] = { NULL, "initial", "subtitle", "additional_information", "programme_schedule", "subtitle_hearing_impaired" };
+	return ((type > 0) && (type < 6)) ? NAMES[type] : "reserved";
+}
+
+// BCD page number, 0 = not a decimal page number
+uint16_t page_bcd_to_dec(uint16_t page) {
+	if (((page & 0x0f) > 9) || (((page >> 4) & 0x0f) > 9)) return 0;
+	return (page >> 8) * 100 + ((page >> 4) & 0x0f) * 10 + (page & 0x0f);
+}
+
+void probe_append_pages(output_buffer_t *json, const telxcc_pmt_stream_t *listed, const uint8_t *cc_map) {
+	uint8_t first = 1;
+	if (listed != NULL) for (uint8_t i = 0; i < listed->pages_count; i++) {
+		const telxcc_teletext_page_t *page = &listed->pages[i];
+		uint16_t number = page_bcd_to_dec(page->page);
+		if (number == 0) continue;
+		uint8_t seen = (cc_map != NULL) && ((cc_map[page->page & 0xff] & (1 << ((page->page >> 8) - 1))) > 0);
+		output_append_format(json, "%s{\"page\":%"PRIu16",\"language\":", (first == 1) ? "" : ",", number);
+		output_append_json_string(json, page->language);
+		output_append_format(json, ",\"teletext_type\":\"%s\",\"seen\":%s}", teletext_type_name(page->type), (seen == 1) ? "true" : "false");
+		first = 0;
+	}
+
+	// subtitle pages found in stream but not listed in PMT
+	if (cc_map != NULL) for (uint16_t i = 0; i < 255; i++)
+		for (uint8_t j = 0; j < 8; j++) {
+			if ((cc_map[i] & (1 << j)) == 0) continue;
+			uint16_t bcd = ((j + 1) << 8) | i;
+			uint16_t number = page_bcd_to_dec(bcd);
+			if (number == 0) continue;
+			uint8_t k = 0;
+			while ((listed != NULL) && (k < listed->pages_count) && (listed->pages[k].page != bcd)) k++;
+			if ((listed != NULL) && (k < listed->pages_count)) continue;
+			output_append_format(json, "%s{\"page\":%"PRIu16",\"seen\":true}", (first == 1) ? "" : ",", number);
+			first = 0;
 		}
-		fprintf(stdout, "\n");
+}
+
+// prints probe report of input as one JSON line to STDOUT
+void print_probe(const job_t *job, const telxcc_decoder_t *decoder, uint64_t bytes, uint8_t stable) {
+	telxcc_psi_t psi;
+	telxcc_get_psi(decoder, &psi);
+	uint8_t psi_complete = psi.pat_received;
+	for (uint8_t i = 0; i < psi.programs_count; i++) psi_complete &= psi.pmt_received[i];
+
+	output_buffer_t json = { NULL, 0, 0 };
+	output_append_literal(&json, "{\"type\":\"probe\",\"input\":");
+	output_append_json_string(&json, (job->input != NULL) ? job->input : ((config_udp != NULL) ? config_udp : "-"));
+	output_append_format(&json, ",\"bytes\":%"PRIu64",\"psi_complete\":%s,\"stable\":%s", bytes, (psi_complete == 1) ? "true" : "false", (stable == 1) ? "true" : "false");
+	if (psi.pat_received == 1) output_append_format(&json, ",\"transport_stream_id\":%"PRIu16, psi.transport_stream_id);
+
+	output_append_literal(&json, ",\"programs\":[");
+	for (uint8_t i = 0; i < psi.programs_count; i++)
+		output_append_format(&json, "%s{\"program_number\":%"PRIu16",\"pmt_pid\":%"PRIu16"}", (i > 0) ? "," : "", psi.program_numbers[i], psi.pmt_pids[i]);
+
+	// streams listed in PMTs first, then those found only
+	output_append_literal(&json, "],\"streams\":[");
+	telxcc_stream_info_t info;
+	for (uint8_t i = 0; i < psi.streams_count; i++) {
+		const telxcc_pmt_stream_t *listed = &psi.streams[i];
+		const uint8_t *cc_map = NULL;
+		for (uint8_t k = 0; telxcc_get_stream_info(decoder, k, &info) > 0; k++)
+			if (info.pid == listed->pid) cc_map = info.cc_map;
+		output_append_format(&json, "%s{\"pid\":%"PRIu16",\"program_number\":%"PRIu16",\"found\":%s,\"pages\":[", (i > 0) ? "," : "",
+			listed->pid, listed->program_number, (cc_map != NULL) ? "true" : "false");
+		probe_append_pages(&json, listed, cc_map);
+		output_append_literal(&json, "]}");
+	}
+	uint8_t first = (psi.streams_count == 0);
+	for (uint8_t k = 0; telxcc_get_stream_info(decoder, k, &info) > 0; k++) {
+		uint8_t i = 0;
+		while ((i < psi.streams_count) && (psi.streams[i].pid != info.pid)) i++;
+		if (i < psi.streams_count) continue;
+		output_append_format(&json, "%s{\"pid\":%"PRIu16",\"found\":true,\"pages\":[", (first == 1) ? "" : ",", info.pid);
+		probe_append_pages(&json, NULL, info.cc_map);
+		output_append_literal(&json, "]}");
+		first = 0;
 	}
-    // probably EMPTY LINE BETWEEN FRAMES
-	// fprintf(stdout, "\r\n");
+	output_append_literal(&json, "]}\n");
+
+	fwrite(json.data, 1, json.size, stdout);
 	fflush(stdout);
+	free(json.data);
 }
 
-inline uint8_t magazine(uint16_t page) {
-	return ((page >> 8) & 0xf);
-}
+// probe mode: PSI and teletext streams of input are reported, input is read only until they are known
+void probe_input(job_t *job, ts_input_t *input) {
+	telxcc_config_t probe_config = config;
+	probe_config.page_store = 0;
+	probe_config.all_pids = 1;
+	probe_config.pid = 0;
+	probe_config.pages_count = 0;
+	probe_config.all_pages = 0;
+	probe_config.live = 0;
+	probe_config.merge_repeats = 0;
+	probe_config.packet_events = 1;
+	probe_config.psi = 1;
+	if (config_verbose == 0) probe_config.log = NULL;
+	probe_clock_t clock = { 0, 0 };
+	telxcc_decoder_t *decoder = telxcc_create(&probe_config, probe_callback, &clock);
+	if (decoder == NULL) {
+		fprintf(stderr, "- Could not allocate decoder\n");
+		exit(EXIT_FAILURE);
+	}
 
-void process_telx_packet(data_unit_t data_unit_id, teletext_packet_payload_t *packet, uint64_t timestamp) {
-	// variable names conform to ETS 300 706, chapter 7.1.2
-	uint8_t address = (unham_8_4(packet->address[1]) << 4) | unham_8_4(packet->address[0]);
-	uint8_t m = address & 0x7;
-	if (m == 0) m = 8;
-	uint8_t y = (address >> 3) & 0x1f;
+	const uint8_t *block = NULL;
+	size_t block_size = 0;
+	uint64_t bytes = 0;
+	uint8_t done = 0;
+	uint8_t stable = 0;
+	// hash of PIDs and subtitle pages found, and PCR when it last changed
+	uint64_t pages_hash = 0;
+	uint32_t changed_pcr = 0;
+	uint8_t changed_valid = 0;
+	uint64_t t = clock_ns();
+
+	while ((done == 0) && (exit_request == 0) && ((block_size = ts_input_read(input, &block)) > 0)) {
+		uint64_t now = clock_ns();
+		job->read_ns += now - t;
+		t = now;
+
+		for (size_t offset = 0; (done == 0) && (offset < block_size); offset += PROBE_CHECK_PACKETS * TS_PACKET_SIZE) {
+			size_t size = block_size - offset;
+			if (size > PROBE_CHECK_PACKETS * TS_PACKET_SIZE) size = PROBE_CHECK_PACKETS * TS_PACKET_SIZE;
+			if (telxcc_push(decoder, block + offset, size) < 0) {
+				job->failed = 1;
+				done = 1;
+				break;
+			}
+			bytes += size;
+
+			// FNV-1a of streams found and their subtitle pages
+			uint64_t hash = 0xcbf29ce484222325ULL;
+			uint8_t found = 0;
+			uint8_t listed_found = 1;
+			telxcc_stream_info_t info;
+			for (; telxcc_get_stream_info(decoder, found, &info) > 0; found++) {
+				hash = (hash ^ info.pid) * 0x100000001b3ULL;
+				for (uint16_t i = 0; i < 256; i++) hash = (hash ^ info.cc_map[i]) * 0x100000001b3ULL;
+			}
+			if (clock.pcr_valid == 1) {
+				// PCR going backwards (wrap, discontinuity) restarts stability period
+				if ((hash != pages_hash) || (changed_valid == 0) || (clock.pcr < changed_pcr)) {
+					pages_hash = hash;
+					changed_pcr = clock.pcr;
+					changed_valid = 1;
+				}
+			}
+			stable = (found > 0) && (changed_valid == 1) && (clock.pcr - changed_pcr >= PROBE_STABLE_MS);
+
+			telxcc_psi_t psi;
+			telxcc_get_psi(decoder, &psi);
+			uint8_t psi_complete = psi.pat_received;
+			for (uint8_t i = 0; i < psi.programs_count; i++) psi_complete &= psi.pmt_received[i];
+			for (uint8_t i = 0; i < psi.streams_count; i++) {
+				uint8_t k = 0;
+				while ((telxcc_get_stream_info(decoder, k, &info) > 0) && (info.pid != psi.streams[i].pid)) k++;
+				if (k == found) listed_found = 0;
+			}
+
+			if ((psi_complete == 1) && (stable == 1) && (listed_found == 1)) done = 1;
+			else if ((bytes >= PROBE_MIN_SIZE) && ((found == 0) || (stable == 1))) done = 1;
+			else if (bytes >= PROBE_MAX_SIZE) done = 1;
+		}
+
+		now = clock_ns();
+		job->decode_ns += now - t;
+		t = now;
+	}
 
-	static teletext_page_t page_buffer;
-	static uint8_t receiving_data = 0;
-	static uint8_t current_charset = 0;
+	VERBOSE fprintf(stderr, "- Probe finished after %"PRIu64" bytes (%s)\n", bytes, (stable == 1) ? "subtitle pages stable" : "subtitle pages not stable");
+	if (job->failed == 0) print_probe(job, decoder, bytes, stable);
 
-	static transmission_mode_t transmission_mode = TRANSMISSION_MODE_SERIAL;
+	{
+		telxcc_stats_t stats;
+		telxcc_get_stats(decoder, &stats);
+		job->packets += stats.packets;
+		add_stats(&job->stats, &stats);
+	}
+	telxcc_destroy(decoder);
+}
 
- 	if (y == 0) {
-	 	// CC map
-		uint8_t i = (unham_8_4(packet->data[1]) << 4) | unham_8_4(packet->data[0]);
-		uint8_t flag_subtitle = (unham_8_4(packet->data[5]) & 0x08) >> 3;
-		cc_map[i] |= flag_subtitle << (m - 1);
+// split mode: input part decoded on its own; its events are replayed in input order when all parts are decoded
+typedef struct part_event {
+	telxcc_event_t event;
+	size_t utf8_offset; // event text in part text buffer
+	struct part_event *merged_into; // repeated caption merged into caption of a previous part, not replayed
+} part_event_t;
 
-		if ((config_page == 0) && (flag_subtitle > 0) && (i < 0xff)) {
-			config_page = (m << 8) | (unham_8_4(packet->data[1]) << 4) | unham_8_4(packet->data[0]);
-			fprintf(stderr, "- No teletext page specified, first received suitable page is %03x, not guaranteed\n", config_page);
+typedef struct {
+	uint64_t start;
+	uint64_t end;
+
+	part_event_t *events;
+	uint32_t events_count;
+	uint32_t events_capacity;
+	output_buffer_t text;
+
+	// stream timing needed for stitching
+	telxcc_stream_info_t streams[TELXCC_MAX_STREAMS];
+	uint8_t cc_maps[TELXCC_MAX_STREAMS][256];
+	uint8_t streams_count;
+
+	uint32_t packets;
+	uint8_t failed;
+
+	telxcc_stats_t stats;
+	uint64_t decode_ns;
+} split_part_t;
+
+const uint8_t *split_data = NULL;
+const job_t *split_job = NULL;
+split_part_t *split_parts = NULL;
+uint32_t split_parts_count = 0;
+uint32_t split_next = 0;
+pthread_mutex_t split_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+void part_callback(void *user_data, const telxcc_event_t *event) {
+	split_part_t *part = user_data;
+
+	// event belongs to the part containing its page header (or page detection)
+	if ((event->position < part->start) || (event->position >= part->end)) return;
+
+	if (part->events_count == part->events_capacity) {
+		uint32_t capacity = (part->events_capacity > 0) ? 2 * part->events_capacity : 256;
+		part_event_t *events = realloc(part->events, capacity * sizeof(part_event_t));
+		if (events == NULL) {
+			fprintf(stderr, "- Could not allocate split mode event buffer\n");
+			exit(EXIT_FAILURE);
 		}
+		part->events = events;
+		part->events_capacity = capacity;
 	}
 
-	if ((y == 0) && (data_unit_id == DATA_UNIT_EBU_TELETEXT_SUBTITLE)) {
- 		// Page number and control bits
-		uint16_t page_number = (m << 8) | (unham_8_4(packet->data[1]) << 4) | unham_8_4(packet->data[0]);
-		uint8_t charset = ((unham_8_4(packet->data[7]) & 0x08) | (unham_8_4(packet->data[7]) & 0x04) | (unham_8_4(packet->data[7]) & 0x02)) >> 1;
-		uint8_t flag_suppress_header = unham_8_4(packet->data[6]) & 0x01;
-		//uint8_t flag_inhibit_display = (unham_8_4(packet->data[6]) & 0x08) >> 3;
+	part_event_t *e = &part->events[part->events_count++];
+	e->event = *event;
+	e->event.text = NULL;
+	e->event.utf8 = NULL;
+	e->utf8_offset = part->text.size;
+	e->merged_into = NULL;
+	// with terminating zero, replayed utf8 is zero-terminated as in sequential decoding
+	if (event->type == TELXCC_EVENT_CAPTION) output_append(&part->text, event->utf8, event->utf8_size + 1);
+}
 
-		// ETS 300 706, chapter 9.3.1.3:
-		// When set to '1' the service is designated to be in Serial mode and the transmission of a page is terminated
-		// by the next page header with a different page number.
-		// When set to '0' the service is designated to be in Parallel mode and the transmission of a page is terminated
-		// by the next page header with a different page number but the same magazine number.
-		// The same setting shall be used for all page headers in the service.
-		transmission_mode = unham_8_4(packet->data[7]) & 0x01;
+void decode_part(split_part_t *part, uint8_t last) {
+	telxcc_config_t part_config = config;
+	part_config.start_position = part->start;
+	// last part has nothing to wait for
+	part_config.end_position = (last == 1) ? 0 : part->end;
+	// diagnostic messages of the first part only, others would just repeat them
+	if ((part->start > 0) && (config_verbose == 0)) part_config.log = NULL;
+
+	telxcc_decoder_t *decoder = telxcc_create(&part_config, part_callback, part);
+	if (decoder == NULL) {
+		fprintf(stderr, "- Could not allocate decoder\n");
+		exit(EXIT_FAILURE);
+	}
 
-		// ETS 300 706, chapter 7.2.1: Page is terminated by and excludes the next page header packet
-		// having the same magazine address in parallel transmission mode, or any magazine address in serial transmission mode.
-		if (page_number != config_page) {
-			// OK, whole page was transmitted, however we need to wait for next subtitle frame;
-			// otherwise it would be displayed only for a few ms
-			receiving_data = 0;
-			return;
+	// own part first, then as much of following input as needed to complete pages started in own part
+	uint64_t position = part->start;
+	uint64_t size = split_parts[split_parts_count - 1].end;
+	sig_atomic_t stats_requests_seen = stats_requests;
+	uint64_t start = clock_ns();
+	while ((exit_request == 0) && (position < size) && ((position < part->end) || (telxcc_pending(decoder) == 1))) {
+		uint64_t n = (position < part->end) ? part->end - position : TS_PACKET_SIZE * 64;
+		if (n > INPUT_BLOCK_SIZE) n = INPUT_BLOCK_SIZE;
+		if (n > size - position) n = size - position;
+		if (telxcc_push(decoder, split_data + position, n) < 0) {
+			part->failed = 1;
+			break;
 		}
+		position += n;
 
-		// Now we have the begining of page transmittion; if there is page_buffer pending, process it
-		if (page_buffer.tainted > 0) {
-			// it would be nice, if subtitle hides on previous video frame, so we contract 40 ms (1 frame @25 fps)
-			page_buffer.hide_timestamp = timestamp - 40;
-			process_page(&page_buffer);
-		}
-
-		page_buffer.show_timestamp = timestamp;
-		page_buffer.hide_timestamp = 0;
-		memset(page_buffer.text, 0x00, sizeof(page_buffer.text));
-		page_buffer.tainted = 0;
-		receiving_data = 1;
-
-		// remap current Latin G0 chars
-		// TODO: refactore
-		if (charset != current_charset) {
-			G0[LATIN][0x23 - 0x20] = G0_LATIN_NATIONAL_SUBSETS[charset][ 0];
-			G0[LATIN][0x24 - 0x20] = G0_LATIN_NATIONAL_SUBSETS[charset][ 1];
-			G0[LATIN][0x40 - 0x20] = G0_LATIN_NATIONAL_SUBSETS[charset][ 2];
-			G0[LATIN][0x5b - 0x20] = G0_LATIN_NATIONAL_SUBSETS[charset][ 3];
-			G0[LATIN][0x5c - 0x20] = G0_LATIN_NATIONAL_SUBSETS[charset][ 4];
-			G0[LATIN][0x5d - 0x20] = G0_LATIN_NATIONAL_SUBSETS[charset][ 5];
-			G0[LATIN][0x5e - 0x20] = G0_LATIN_NATIONAL_SUBSETS[charset][ 6];
-			G0[LATIN][0x5f - 0x20] = G0_LATIN_NATIONAL_SUBSETS[charset][ 7];
-			G0[LATIN][0x60 - 0x20] = G0_LATIN_NATIONAL_SUBSETS[charset][ 8];
-			G0[LATIN][0x7b - 0x20] = G0_LATIN_NATIONAL_SUBSETS[charset][ 9];
-			G0[LATIN][0x7c - 0x20] = G0_LATIN_NATIONAL_SUBSETS[charset][10];
-			G0[LATIN][0x7d - 0x20] = G0_LATIN_NATIONAL_SUBSETS[charset][11];
-			G0[LATIN][0x7e - 0x20] = G0_LATIN_NATIONAL_SUBSETS[charset][12];
-			current_charset = charset;
-			VERBOSE fprintf(stderr, "- G0 Charset translation table remapped to G0 Latin National Subset ID %1x\n", current_charset);
-		}
-
-		// I know -- not needed; in subtitles we will never need disturbing teletext page status bar
-		// displaying tv station name, current time etc.
-		if (flag_suppress_header == 0) {
-			for (uint8_t i = 14; i < 40; i++) page_buffer.text[y][i] = telx_to_ucs2(packet->data[i]);
-		}
-	}
-	else if ((y >= 1) && (y <= 23) && (m == magazine(config_page))) {
-		if ((transmission_mode == TRANSMISSION_MODE_SERIAL) && (data_unit_id != DATA_UNIT_EBU_TELETEXT_SUBTITLE)) return;
-		if (receiving_data == 1) {
-			// ETS 300 706, chapter 9.4.1: Packets X/26 at presentation Levels 1.5, 2.5, 3.5 are used for addressing
-			// a character location and overwriting the existing character defined on the Level 1 page
-			// ETS 300 706, annex B.2.2: Packets with Y = 26 shall be transmitted before any packets with Y = 1 to Y = 25;
-			// so page_buffer.text[y][i] may already contain any character received
-			// in frame number 26, skip original G0 character
-			for (uint8_t i = 0; i < 40; i++) if (page_buffer.text[y][i] == 0x00) page_buffer.text[y][i] = telx_to_ucs2(packet->data[i]);
-			page_buffer.tainted = 1;
-		}
-	}
-	else if ((y == 26) && (m == magazine(config_page))) {
-		if ((transmission_mode == TRANSMISSION_MODE_SERIAL) && (data_unit_id != DATA_UNIT_EBU_TELETEXT_SUBTITLE)) return;
-		if (receiving_data == 1) {
-			// ETS 300 706, chapter 12.3.2 (X/26 definition)
-			uint8_t x26_row = 0;
-			uint8_t x26_col = 0;
-
-			uint32_t decoded[13] = { 0 };
-			for (uint8_t i = 1, j = 0; i < 40; i += 3, j++) {
-				decoded[j] = unham_24_18((packet->data[i + 2] << 16) | (packet->data[i + 1] << 8) | packet->data[i]);
-				// invalid data
-				if ((decoded[j] & 0x80000000) > 0) decoded[j] = 0;
-			}
+		if ((config_stats != NULL) && (stats_requests != stats_requests_seen)) {
+			stats_requests_seen = stats_requests;
+			telxcc_get_stats(decoder, &part->stats);
+			print_stats(split_job, &part->stats, 0, clock_ns() - start, part - split_parts, 0);
+		}
+	}
+	// held captions of own part are emitted before end of input unless it is the last part
+	telxcc_flush(decoder);
+	part->decode_ns = clock_ns() - start;
 
-			for (uint8_t j = 0; j < 13; j++) {
-				uint8_t data = (decoded[j] & 0x3f800) >> 11;
-				uint8_t mode = (decoded[j] & 0x7c0) >> 6;
-				uint8_t address = decoded[j] & 0x3f;
-				uint8_t row_address_group = (address >= 40) && (address <= 63);
-
-				// ETS 300 706, chapter 12.3.1, table 27: set active position
-				if ((mode == 0x04) && (row_address_group == 1)) {
-					x26_row = address - 40;
-					if (x26_row == 0) x26_row = 24;
-					x26_col = 0;
-				}
+	telxcc_get_stats(decoder, &part->stats);
+	part->packets = part->stats.packets;
 
-				// ETS 300 706, chapter 12.3.1, table 27: termination marker
-				if ((mode >= 0x11) && (mode <= 0x1f) && (row_address_group == 1)) break;
+	telxcc_stream_info_t *info = part->streams;
+	for (part->streams_count = 0; telxcc_get_stream_info(decoder, part->streams_count, info) > 0; part->streams_count++, info++) {
+		memcpy(part->cc_maps[part->streams_count], info->cc_map, 256);
+		info->cc_map = part->cc_maps[part->streams_count];
+	}
+	telxcc_destroy(decoder);
+}
 
-				// ETS 300 706, chapter 12.3.1, table 27: character from G2 set
-				if ((mode == 0x0f) && (row_address_group == 0)) {
-					x26_col = address;
-					if (data > 31) page_buffer.text[x26_row][x26_col] = G2[0][data - 32];
-				}
+void *split_worker(void *arg) {
+	for (;;) {
+		pthread_mutex_lock(&split_mutex);
+		uint8_t done = (exit_request == 1) || (split_next == split_parts_count);
+		uint32_t i = split_next;
+		if (done == 0) split_next++;
+		pthread_mutex_unlock(&split_mutex);
+		if (done == 1) break;
 
-				// ETS 300 706, chapter 12.3.1, table 27: G0 character with diacritical mark
-				if ((mode >= 0x11) && (mode <= 0x1f) && (row_address_group == 0)) {
-					x26_col = address;
+		decode_part(&split_parts[i], (i == split_parts_count - 1));
+	}
+	return NULL;
+}
 
-					// A - Z
-					if ((data >= 65) && (data <= 90)) page_buffer.text[x26_row][x26_col] = G2_ACCENTS[mode - 0x11][data - 65];
-					// a - z
-					else if ((data >= 97) && (data <= 122)) page_buffer.text[x26_row][x26_col] = G2_ACCENTS[mode - 0x11][data - 71];
-					// other
-					else page_buffer.text[x26_row][x26_col] = telx_to_ucs2(data);
-				}
-			}
+// last caption of page before part k (in parts decoded, merged captions resolved)
+part_event_t *previous_caption(uint32_t k, const telxcc_event_t *event) {
+	while (k-- > 0) {
+		split_part_t *part = &split_parts[k];
+		for (uint32_t j = part->events_count; j-- > 0;) {
+			part_event_t *e = &part->events[j];
+			if ((e->event.type != TELXCC_EVENT_CAPTION) || (e->event.pid != event->pid) || (e->event.page != event->page)) continue;
+			while (e->merged_into != NULL) e = e->merged_into;
+			return e;
 		}
 	}
-	else if (y == 28) {
-		VERBOSE fprintf(stderr, "- Packet X/28 received; not yet implemented; you won't be able to use secondary language\n");
+	return NULL;
+}
+
+// decoder does not merge repeated captions across end of part (config.merge_repeats); the first caption of each
+// page in part is merged into the last one of previous parts as it would be in sequential decoding
+void merge_part_repeats(job_t *job, uint32_t k) {
+	split_part_t *part = &split_parts[k];
+	uint32_t seen[TELXCC_MAX_STREAMS * TELXCC_MAX_PAGES];
+	uint16_t seen_count = 0;
+	for (uint32_t j = 0; j < part->events_count; j++) {
+		part_event_t *e = &part->events[j];
+		if (e->event.type != TELXCC_EVENT_CAPTION) continue;
+
+		uint32_t key = ((uint32_t)e->event.pid << 16) | e->event.page;
+		uint16_t i = 0;
+		while ((i < seen_count) && (seen[i] != key)) i++;
+		if (i < seen_count) continue;
+		if (seen_count < TELXCC_MAX_STREAMS * TELXCC_MAX_PAGES) seen[seen_count++] = key;
+
+		// retransmission follows right after (hide time is 40 ms before next page header)
+		part_event_t *p = previous_caption(k, &e->event);
+		if ((p == NULL) || (p->event.hide_timestamp + 40 != e->event.show_timestamp) || (p->event.utf8_size != e->event.utf8_size)) continue;
+		if (memcmp(p->event.utf8, e->event.utf8, e->event.utf8_size) != 0) continue;
+		p->event.hide_timestamp = e->event.hide_timestamp;
+		e->merged_into = p;
+		job->stats.repeats++;
 	}
-	else if (y == 29) {
-		VERBOSE fprintf(stderr, "- Packet M/29 received; not yet implemented; you won't be able to use secondary language\n");
+}
+
+// replays events of all parts in input order; timestamps of each part are rebased to continue
+// the timeline of the previous part, including PTS wraps (delta += 95443718) in between
+void stitch_parts(job_t *job) {
+	int64_t *split_delta = calloc(8192, sizeof(int64_t));
+	uint32_t *split_t0 = calloc(8192, sizeof(uint32_t));
+	uint8_t *split_timing = calloc(8192, sizeof(uint8_t));
+	if ((split_delta == NULL) || (split_t0 == NULL) || (split_timing == NULL)) {
+		fprintf(stderr, "- Could not allocate split mode timing\n");
+		exit(EXIT_FAILURE);
 	}
-	else if ((y == 30) && (m == 8)) {
-		// ETS 300 706, chapter 9.8: Broadcast Service Data Packets
-		static uint8_t programme_title_processed = 0;
-		if (programme_title_processed == 0) {
-			// ETS 300 706, chapter 9.8.1: Packet 8/30 Format 1
-			if (unham_8_4(packet->data[0]) < 2) {
-				fprintf(stderr, "- Programme Identification Data = ");
-				for (uint8_t i = 20; i < 40; i++) {
-					char u[4] = {0, 0, 0, 0};
-					ucs2_to_utf8(u, telx_to_ucs2(packet->data[i]));
-					fprintf(stderr, "%s", u);
-				}
-				fprintf(stderr, "\n");
 
-				// OMG! ETS 300 706 stores timestamp in 7 bytes in Modified Julian Day in BCD format + HH:MM:SS in BCD format
-				// + timezone as 5-bit count of half-hours from GMT with 1-bit sign
-				// In addition all decimals are incremented by 1 before transmission.
-				uint32_t t = 0;
-				// 1st step: BCD to Modified Julian Day
-				t += (packet->data[10] & 0x0f) * 10000;
-				t += ((packet->data[11] & 0xf0) >> 4) * 1000;
-				t += (packet->data[11] & 0x0f) * 100;
-				t += ((packet->data[12] & 0xf0) >> 4) * 10;
-				t += (packet->data[12] & 0x0f);
-				t -= 11111;
-				// 2nd step: conversion Modified Julian Day to unix timestamp
-				t = (t - 40587) * 86400;
-				// 3rd step: add time
-				t += 3600 * ( ((packet->data[13] & 0xf0) >> 4) * 10 + (packet->data[13] & 0x0f) );
-				t +=   60 * ( ((packet->data[14] & 0xf0) >> 4) * 10 + (packet->data[14] & 0x0f) );
-				t +=        ( ((packet->data[15] & 0xf0) >> 4) * 10 + (packet->data[15] & 0x0f) );
-				t -= 40271;
-				// 4th step: conversion to time_t
-				time_t t0 = (time_t)t;
-				// ctime output itself is \n-ended
-				fprintf(stderr, "- Universal Time Co-ordinated = %s", ctime(&t0));
-
-				VERBOSE fprintf(stderr, "- Transmission mode = %s\n", (transmission_mode == 1 ? "serial" : "parallel"));
-
-				programme_title_processed = 1;
+	for (uint32_t k = 0; k < split_parts_count; k++) {
+		split_part_t *part = &split_parts[k];
+		if (part->failed == 1) job->failed = 1;
+		job->packets += part->packets;
+		add_stats(&job->stats, &part->stats);
+		job->decode_ns += part->decode_ns;
+
+		int64_t correction[TELXCC_MAX_STREAMS] = { 0 };
+		for (uint8_t i = 0; i < part->streams_count; i++) {
+			const telxcc_stream_info_t *info = &part->streams[i];
+			if ((info->timing_initialized == 1) && (split_timing[info->pid] == 1)) {
+				int64_t delta = split_delta[info->pid];
+				if (info->first_t < split_t0[info->pid]) delta += 95443718;
+				correction[i] = delta - info->first_delta;
 			}
+			if (info->end_timing_initialized == 1) {
+				split_delta[info->pid] = info->end_delta + correction[i];
+				split_t0[info->pid] = info->end_t0;
+				split_timing[info->pid] = 1;
+			}
+			add_job_stream(job, info->pid, info->cc_map);
+		}
+
+		for (uint32_t j = 0; j < part->events_count; j++) {
+			telxcc_event_t *event = &part->events[j].event;
+			if (event->type == TELXCC_EVENT_PAGE) continue;
+			for (uint8_t i = 0; i < part->streams_count; i++)
+				if (part->streams[i].pid == event->pid) {
+					event->show_timestamp += correction[i];
+					event->hide_timestamp += correction[i];
+				}
+			event->utf8 = part->text.data + part->events[j].utf8_offset;
 		}
+		if (config.merge_repeats == 1) merge_part_repeats(job, k);
+	}
+
+	// hide time of caption may be extended by following parts, so events are replayed when all are rebased
+	for (uint32_t k = 0; k < split_parts_count; k++) {
+		split_part_t *part = &split_parts[k];
+		for (uint32_t j = 0; (job->failed == 0) && (j < part->events_count); j++)
+			if (part->events[j].merged_into == NULL) caption_callback(job, &part->events[j].event);
+	}
+	for (uint32_t k = 0; k < split_parts_count; k++) {
+		free(split_parts[k].events);
+		free(split_parts[k].text.data);
+	}
+
+	free(split_timing);
+	free(split_t0);
+	free(split_delta);
+}
+
+// auto-detected PID and page must be the same for all parts, so they are resolved in advance
+uint8_t split_auto_resolved = 0;
+
+void resolve_callback(void *user_data, const telxcc_event_t *event) {
+	if ((event->type == TELXCC_EVENT_PAGE) && (split_auto_resolved == 0)) {
+		config.pages[config.pages_count++] = event->page;
+		if ((config.pid == 0) && (config.all_pids == 0)) config.pid = event->pid;
+		split_auto_resolved = 1;
 	}
-	// else nothing; we do not process page related extension packets as in ETS 300 706, chapter 7.2.3
 }
 
-void process_pes_packet(uint8_t *buffer, uint16_t size) {
-	if (size < 6) return;
+void resolve_auto(const uint8_t *data, uint64_t size) {
+	uint8_t auto_page = (config.pages_count == 0) && (config.all_pages == 0);
+	uint8_t auto_pid = (config.pid == 0) && (config.all_pids == 0);
+	if ((auto_page == 0) && (auto_pid == 0)) return;
 
-	// Packetized Elementary Stream (PES) 32-bit start code
-	uint64_t pes_prefix = (buffer[0] << 16) | (buffer[1] << 8) | buffer[2];
-	uint8_t pes_stream_id = buffer[3];
+	telxcc_decoder_t *decoder = telxcc_create(&config, resolve_callback, NULL);
+	if (decoder == NULL) {
+		fprintf(stderr, "- Could not allocate decoder\n");
+		exit(EXIT_FAILURE);
+	}
+
+	telxcc_stream_info_t info;
+	for (uint64_t position = 0; (exit_request == 0) && (split_auto_resolved == 0) && (position < size); position += TS_PACKET_SIZE) {
+		if (telxcc_push(decoder, data + position, TS_PACKET_SIZE) < 0) break;
+		if ((auto_page == 0) && (telxcc_get_stream_info(decoder, 0, &info) > 0)) {
+			config.pid = info.pid;
+			split_auto_resolved = 1;
+		}
+	}
+
+	telxcc_destroy(decoder);
+}
 
-	// check for PES header
-	if (pes_prefix != 0x000001) return;
+// decodes parts of memory-mapped input in parallel
+void decode_split(job_t *job, const uint8_t *data, uint64_t size, uint32_t parts_count, uint16_t workers_count) {
+	resolve_auto(data, size);
+	VERBOSE fprintf(stderr, "- Split mode, input decoded in %"PRIu32" parts by %"PRIu16" worker threads\n", parts_count, workers_count);
+
+	split_data = data;
+	split_job = job;
+	split_parts_count = parts_count;
+	split_parts = calloc(parts_count, sizeof(split_part_t));
+	if (split_parts == NULL) {
+		fprintf(stderr, "- Could not allocate split mode parts\n");
+		exit(EXIT_FAILURE);
+	}
 
-	// stream_id is not "Private Stream 1" (0xbd)
-	if (pes_stream_id != 0xbd) return;
+	// parts are whole TS packets
+	uint64_t packets_count = size / TS_PACKET_SIZE;
+	for (uint32_t k = 0; k < parts_count; k++) {
+		split_parts[k].start = TS_PACKET_SIZE * (packets_count * k / parts_count);
+		split_parts[k].end = (k == parts_count - 1) ? packets_count * TS_PACKET_SIZE : TS_PACKET_SIZE * (packets_count * (k + 1) / parts_count);
+	}
 
-	// PES packet length
-	// ETSI EN 301 775 V1.2.1 (2003-05) chapter 4.3: (N × 184) - 6 + 6 B header
-	uint16_t pes_packet_length = 6 + ((buffer[4] << 8) | buffer[5]);
-	// Can be zero. If the "PES packet length" is set to zero, the PES packet can be of any length.
-	// A value of zero for the PES packet length can be used only when the PES packet payload is a video elementary stream.
-	if (pes_packet_length == 6) return;
+	pthread_t workers[MAX_WORKERS];
+	uint16_t workers_started = 0;
+	for (; workers_started < workers_count; workers_started++)
+		if (pthread_create(&workers[workers_started], NULL, split_worker, NULL) != 0) break;
+	// no thread could be started, decode parts here
+	if (workers_started == 0) split_worker(NULL);
+	for (uint16_t i = 0; i < workers_started; i++) pthread_join(workers[i], NULL);
 
-	// truncate incomplete PES packets
-	if (pes_packet_length > size) pes_packet_length = size;
+	stitch_parts(job);
+	free(split_parts);
+}
 
-	uint8_t optional_pes_header_included = 0;
-	uint16_t optional_pes_header_length = 0;
-	// optional PES header marker bits (10.. ....)
-	if ((buffer[6] & 0xc0) == 0x80) {
-		optional_pes_header_included = 1;
-		optional_pes_header_length = buffer[8];
+// number of worker threads, -j or number of CPUs
+uint16_t get_workers_count(void) {
+	uint16_t count = config_workers;
+	if (count == 0) {
+		long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		count = (cpus > 0) ? ((cpus < MAX_WORKERS) ? cpus : MAX_WORKERS) : 1;
 	}
+	if (count > MAX_WORKERS) count = MAX_WORKERS;
+	return count;
+}
 
-	static uint8_t using_pts = 255;
-	if (using_pts == 255) {
-		if ((optional_pes_header_included == 1) && ((buffer[7] & 0x80) > 0)) {
-			using_pts = 1;
-			VERBOSE fprintf(stderr, "- PID 0xbd PTS available\n");
-		} else {
-			using_pts = 0;
-			VERBOSE fprintf(stderr, "- PID 0xbd PTS unavailable, using TS PCR\n");
+// decodes one input into its outputs; returns -1 if input could not be processed
+int run_job(job_t *job) {
+	int fd = STDIN_FILENO;
+	if (job->input != NULL) {
+		fd = open(job->input, O_RDONLY);
+		if (fd < 0) {
+			fprintf(stderr, "- Could not open input file %s (%s)\n", job->input, strerror(errno));
+			job->failed = 1;
+			return -1;
 		}
 	}
 
-	uint32_t t = 0;
-	// If there is no PTS available, use global PCR
-	if (using_pts == 0) t = global_timestamp;
-	else {
-		// PTS is 33 bits wide, however, timestamp in ms fits into 32 bits nicely (PTS/90)
-		// presentation and decoder timestamps use the 90 KHz clock, hence PTS/90 = [ms]
-		uint64_t pts = 0;
-		// __MUST__ assign value to uint64_t and __THEN__ rotate left by 29 bits
-		// << is defined for signed int (as in "C" spec.) and overflow occures
-		pts = (buffer[9] & 0x0e);
-		pts <<= 29;
-		pts |= (buffer[10] << 22);
-		pts |= ((buffer[11] & 0xfe) << 14);
-		pts |= (buffer[12] << 7);
-		pts |= ((buffer[13] & 0xfe) >> 1);
-		t = pts / 90;
-	}
-
-	static int64_t delta = 0;
- 	static uint32_t t0 = 0;
-	static uint8_t initialized = 0;
-	if (initialized == 0) {
-		delta = 1000 * config_offset - t;
-		t0 = t;
-		initialized = 1;
-	}
-	if (t < t0) delta += 95443718;
-	t0 = t;
-	uint64_t timestamp = t + delta;
-
-	// skip optional PES header and process each 46-byte teletext packet
-	uint16_t i = 7;
-	if (optional_pes_header_included) i += 3 + optional_pes_header_length;
-	while (i <= pes_packet_length - 6) {
-		uint8_t data_unit_id = buffer[i++];
-		uint8_t data_unit_len = buffer[i++];
-
-		if ((data_unit_id == DATA_UNIT_EBU_TELETEXT_NONSUBTITLE) || (data_unit_id == DATA_UNIT_EBU_TELETEXT_SUBTITLE)) {
-			// teletext payload has always size 44 bytes
-			if (data_unit_len == 0x2c) {
-				// reverse endianess (via lookup table), ETS 300 706, chapter 7.1
-				for (uint8_t j = 0; j < data_unit_len; j++) buffer[i + j] = REVERSE_8[buffer[i + j]];
-
-				process_telx_packet(data_unit_id, (teletext_packet_payload_t *)&buffer[i], timestamp);
+	// writers format captions into output buffer allocated once
+	output_reserve(&job->output, OUTPUT_BUFFER_SIZE);
+
+	// TS input
+	job->start_ns = clock_ns();
+	ts_input_t input;
+	if ((job->input == NULL) && (config_udp != NULL)) {
+		if (ts_input_open_udp(&input, config_udp) < 0) {
+			job->failed = 1;
+			return -1;
+		}
+		job->udp = &input.udp_stats;
+	}
+	else ts_input_open(&input, fd);
+
+	// packet index of STDIN regular file: input is decoded from valid index, otherwise index is built while
+	// input is decoded
+	packet_index_t index;
+	memset(&index, 0, sizeof(packet_index_t));
+	uint8_t indexed = 0;
+	if ((config_index != NULL) && (job->input == NULL) && (input.map != NULL) && (config.live == 0) && (config_probe == 0)) {
+		if ((index_read(&index, config_index, fd) == 1) && (index_covers(&index) == 1)) indexed = 1;
+		else {
+			VERBOSE fprintf(stderr, "- Packet index %s is missing or not valid for input, input is scanned\n", config_index);
+			free(index.runs);
+			memset(&index, 0, sizeof(packet_index_t));
+			index_identify(&index, fd);
+			index.all_pids = config.all_pids;
+			job->index = &index;
+		}
+	}
+
+	// split mode needs random access to input, i.e. memory-mapped file
+	uint32_t parts_count = 1;
+	uint16_t workers = 1;
+	if ((config_split == 1) && (config.live == 0) && (config_inputs_count == 0) && (input.map != NULL) && (config_index == NULL) && (config_probe == 0) && (config_store == NULL)) {
+		workers = get_workers_count();
+		uint64_t parts = input.map_size / MIN_SPLIT_PART_SIZE;
+		// more parts than workers balance the load
+		if (parts > 4 * workers) parts = 4 * workers;
+		if (parts > 1) parts_count = parts;
+	}
+	if (config_probe == 1) probe_input(job, &input);
+	else if (indexed == 1) {
+		VERBOSE fprintf(stderr, "- Decoding %"PRIu64" TS packets (%"PRIu64" ranges) listed in packet index %s\n", index.packets, index.runs_count, config_index);
+		decode_index(job, fd, &index);
+	}
+	else if (parts_count > 1) decode_split(job, input.map, input.map_size, parts_count, workers);
+	else decode_input(job, &input);
+
+	if ((job->index != NULL) && (job->failed == 0) && (exit_request == 0)) {
+		index.pids_count = job->streams_count;
+		memcpy(index.pids, job->stream_pids, sizeof(index.pids));
+		if (index_write(&index, config_index) == 0)
+			VERBOSE fprintf(stderr, "- Packet index %s written (%"PRIu64" TS packets in %"PRIu64" ranges)\n", config_index, index.packets, index.runs_count);
+	}
+	free(index.runs);
+	job->index = NULL;
+
+	if (input.udp == 1) {
+		VERBOSE fprintf(stderr, "- UDP input: %"PRIu64" datagrams received (%"PRIu64" RTP), %"PRIu64" lost in RTP sequence, %"PRIu64" dropped by kernel, %"PRIu64" malformed\n",
+			input.udp_stats.datagrams, input.udp_stats.rtp_datagrams, input.udp_stats.rtp_lost, input.udp_stats.kernel_drops, input.udp_stats.malformed);
+	}
+	// final statistics are printed after input is closed
+	udp_stats_t udp_stats = input.udp_stats;
+	if (job->udp != NULL) job->udp = &udp_stats;
+
+	ts_input_close(&input);
+	if (job->input != NULL) close(fd);
+
+	if ((job->failed == 0) && (config_probe == 0)) {
+		for (uint16_t i = 0; i < job->outputs_count; i++) job->frames_produced += job->outputs[i].frames_produced;
+
+		VERBOSE {
+			if (job->frames_produced == 0) fprintf(stderr, "- No frames produced. CC teletext page number was probably wrong.\n");
+			for (uint8_t k = 0; k < job->streams_count; k++) {
+				if (config.all_pids == 1) fprintf(stderr, "- PID %"PRIu16": there were some CC data carried via pages: ", job->stream_pids[k]);
+				else fprintf(stderr, "- There were some CC data carried via pages: ");
+				// We ignore i = 0xff, because 0xffs are teletext ending frames
+				for (uint16_t i = 0; i < 255; i++)
+					for (uint8_t j = 0; j < 8; j++) {
+						uint8_t v = job->stream_cc_maps[k][i] & (1 << j);
+						if (v > 0) fprintf(stderr, "%03x ", ((j + 1) << 8) | i);
+					}
+				fprintf(stderr, "\n");
+			}
+		}
+
+		if (config_nonempty > 0) {
+			// stdout (or the only output file) in auto mode, when no suitable page was found
+			if ((job->outputs_count == 0) && ((job->output_prefix == NULL) || (job->output_per_page == 0))) add_page_output(job, 0, 0);
+			for (uint16_t i = 0; i < job->outputs_count; i++) {
+				page_output_t *state = &job->outputs[i];
+				if (state->frames_produced > 0) continue;
+				const char text[] = "(no closed captioning available)\n";
+				telxcc_event_t event = {
+					.type = TELXCC_EVENT_CAPTION,
+					.pid = state->pid,
+					.page = state->page,
+					.show_timestamp = 0,
+					.hide_timestamp = 1000,
+					.utf8 = text,
+					.utf8_size = sizeof(text) - 1
+				};
+				write_caption(job, state, &event, 1);
+				job->frames_produced++;
 			}
 		}
+	}
 
-		i += data_unit_len;
+	// stdout gets its footer at the end
+	for (uint16_t i = 0; i < job->outputs_count; i++) {
+		for (uint8_t j = 0; j < config_writers_count; j++) {
+			if (job->outputs[i].fds[j] == STDOUT_FILENO) continue;
+			write_header(job, config_writers[j]->footer, job->outputs[i].fds[j]);
+			close(job->outputs[i].fds[j]);
+		}
+		free(job->outputs[i].pending.data);
 	}
+
+	if (config_stats != NULL) print_stats(job, &job->stats, job->read_ns, job->decode_ns, -1, 1);
+
+	return (job->failed == 0) ? 0 : -1;
 }
 
-// graceful exit support
-uint8_t exit_request = 0;
+// batch mode: workers take input files one by one
+pthread_mutex_t batch_mutex = PTHREAD_MUTEX_INITIALIZER;
+uint32_t batch_next = 0;
+uint32_t batch_failed = 0;
+uint64_t batch_packets = 0;
+uint64_t batch_frames = 0;
+
+void *batch_worker(void *arg) {
+	job_t *job = malloc(sizeof(job_t));
+	if (job == NULL) {
+		fprintf(stderr, "- Could not allocate batch job\n");
+		exit(EXIT_FAILURE);
+	}
+	output_buffer_t output = { NULL, 0, 0 };
+	char prefix[FILENAME_MAX];
+
+	for (;;) {
+		pthread_mutex_lock(&batch_mutex);
+		uint8_t done = (exit_request == 1) || (batch_next == config_inputs_count);
+		uint32_t i = batch_next;
+		if (done == 0) batch_next++;
+		pthread_mutex_unlock(&batch_mutex);
+		if (done == 1) break;
+
+		// outputs are written next to input file, its extension is replaced
+		snprintf(prefix, sizeof(prefix), "%s", config_inputs[i]);
+		char *dot = strrchr(prefix, '.');
+		if ((dot != NULL) && (strchr(dot, '/') == NULL)) *dot = '\0';
+
+		memset(job, 0, sizeof(job_t));
+		job->input = config_inputs[i];
+		job->output_prefix = prefix;
+		job->output_per_page = (config.pages_count > 1) || (config.all_pages == 1) || (config.all_pids == 1);
+		// output buffer is reused by all jobs of this worker
+		job->output = output;
+
+		run_job(job);
+		output = job->output;
+
+		pthread_mutex_lock(&batch_mutex);
+		fprintf(stderr, "- %s: %"PRIu32" teletext packets processed, %"PRIu32" SRT frames written%s\n",
+			job->input, job->packets, job->frames_produced, (job->failed == 0) ? "" : ", FAILED");
+		batch_packets += job->packets;
+		batch_frames += job->frames_produced;
+		batch_failed += job->failed;
+		pthread_mutex_unlock(&batch_mutex);
+	}
 
-void signal_handler(int sig) {
-	if ((sig == SIGINT) || (sig == SIGTERM)) {
-		fprintf(stderr, "- SIGINT/SIGTERM received, performing graceful exit\n");
-		exit_request = 1;
+	free(output.data);
+	free(job);
+	return NULL;
+}
+
+void add_input(const char *filename) {
+	if ((config_inputs_count & 0xff) == 0) {
+		const char **inputs = realloc(config_inputs, (config_inputs_count + 0x100) * sizeof(const char *));
+		if (inputs == NULL) {
+			fprintf(stderr, "- Could not allocate input file list\n");
+			exit(EXIT_FAILURE);
+		}
+		config_inputs = inputs;
+	}
+	config_inputs[config_inputs_count++] = filename;
+}
+
+// manifest: one input file per line, empty lines and lines starting with # are skipped
+void add_manifest_inputs(const char *filename) {
+	FILE *manifest = fopen(filename, "r");
+	if (manifest == NULL) {
+		fprintf(stderr, "- Could not open manifest file %s (%s)\n", filename, strerror(errno));
+		exit(EXIT_FAILURE);
+	}
+
+	char *line = NULL;
+	size_t line_size = 0;
+	ssize_t r = 0;
+	while ((r = getline(&line, &line_size, manifest)) >= 0) {
+		while ((r > 0) && ((line[r - 1] == '\n') || (line[r - 1] == '\r'))) line[--r] = '\0';
+		if ((r == 0) || (line[0] == '#')) continue;
+		add_input(strdup(line));
+	}
+
+	free(line);
+	fclose(manifest);
+}
+
+int compare_filenames(const void *a, const void *b) {
+	return strcmp(*(const char * const *)a, *(const char * const *)b);
+}
+
+// directory: all *.ts, *.mts and *.m2ts files, in name order
+void add_directory_inputs(const char *dirname) {
+	DIR *dir = opendir(dirname);
+	if (dir == NULL) {
+		fprintf(stderr, "- Could not open directory %s (%s)\n", dirname, strerror(errno));
+		exit(EXIT_FAILURE);
+	}
+
+	uint32_t first = config_inputs_count;
+	struct dirent *entry = NULL;
+	while ((entry = readdir(dir)) != NULL) {
+		const char *ext = strrchr(entry->d_name, '.');
+		if ((ext == NULL) || ((strcmp(ext, ".ts") != 0) && (strcmp(ext, ".TS") != 0) && (strcmp(ext, ".mts") != 0) &&
+			(strcmp(ext, ".MTS") != 0) && (strcmp(ext, ".m2ts") != 0) && (strcmp(ext, ".M2TS") != 0))) continue;
+
+		size_t size = strlen(dirname) + strlen(entry->d_name) + 2;
+		char *filename = malloc(size);
+		if (filename == NULL) {
+			fprintf(stderr, "- Could not allocate input file list\n");
+			exit(EXIT_FAILURE);
+		}
+		snprintf(filename, size, "%s/%s", dirname, entry->d_name);
+		add_input(filename);
 	}
+	closedir(dir);
+
+	qsort(&config_inputs[first], config_inputs_count - first, sizeof(const char *), compare_filenames);
 }
 
 int main(int argc, const char *argv[]) {
@@ -607,47 +2924,173 @@ int main(int argc, const char *argv[]) {
 	fprintf(stderr, "Built on %s\n", __DATE__);
 	fprintf(stderr, "\n");
 
-	uint8_t config_bom = 1;
-	uint8_t config_nonempty = 0;
+	telxcc_config_init(&config);
+	config.merge_repeats = 1;
 
 	// command line params parsing
-	for (uint8_t i = 1; i < argc; i++) {
+	for (int i = 1; i < argc; i++) {
 		if (strcmp(argv[i], "-h") == 0) {
-			fprintf(stderr, "Usage: telxcc [-h] | [-p PAGE] [-t TID] [-o OFFSET] [-n] [-1] [-c] [-v]\n");
+			fprintf(stderr, "Usage: telxcc [-h] | [-p PAGE[,PAGE...] | -p all] [-f PREFIX] [-t TID | -t all] [-o OFFSET] [-n] [-1] [-r] [-c] [-v]\n");
+			fprintf(stderr, "                     [-F FORMAT[,FORMAT...]] [-s] [-j THREADS] [-S FILE] [-u URL] [-b BYTES] [-L] [-T MS] [-i INDEX] [-P] [-A] [-D] [-X FILE] [-m MIB] [--probe] [-l MANIFEST] [-d DIR] [FILE...]\n");
 			fprintf(stderr, "  STDIN       transport stream\n");
-			fprintf(stderr, "  STDOUT      subtitles in SubRip SRT file format (UTF-8 encoded)\n");
+			fprintf(stderr, "  STDOUT      subtitles in SubRip SRT file format (UTF-8 encoded), or as of -F\n");
 			fprintf(stderr, "  -h          this help text\n");
 			fprintf(stderr, "  -p PAGE     teletext page number carrying closed captioning (default: auto)\n");
 			fprintf(stderr, "                (usually CZ=888, DE=150, SE=199, NO=777, UK=888 etc.)\n");
+			fprintf(stderr, "                comma separated list of pages or \"all\" (all subtitle pages found) extracts\n");
+			fprintf(stderr, "                more pages in one pass, each to its own output file\n");
+			fprintf(stderr, "  -f PREFIX   write each page to file PREFIX-PAGE.srt instead of STDOUT\n");
+			fprintf(stderr, "                (PREFIX-PAGE.vtt, PREFIX-PAGE.ttml, PREFIX-PAGE.jsonl as of -F)\n");
+			fprintf(stderr, "                (default: STDOUT for one page, \"telxcc\" for more pages or streams)\n");
 			fprintf(stderr, "  -t TID      transport stream PID of teletext data sub-stream (default: auto)\n");
+			fprintf(stderr, "                \"all\" processes all teletext streams of multiplex in one pass,\n");
+			fprintf(stderr, "                each page of each stream to its own PREFIX-PID-PAGE.srt file\n");
 			fprintf(stderr, "  -o OFFSET   subtitles offset in seconds (default: 0.0)\n");
 			fprintf(stderr, "  -n          do not print UTF-8 BOM characters at the beginning of output\n");
 			fprintf(stderr, "  -1          produce at least one (dummy) frame\n");
-			fprintf(stderr, "  -c          output colour information in <font/> HTML tags\n");
+			fprintf(stderr, "  -r          write repeated captions (page retransmissions) as frames of their own\n");
+			fprintf(stderr, "                (default: retransmission of caption right after it extends its time)\n");
+			fprintf(stderr, "  -F FORMAT   output format: srt (default), vtt (WebVTT), ttml or json (JSON lines); comma separated\n");
+			fprintf(stderr, "                list writes more formats in one pass, each to its own file\n");
+			fprintf(stderr, "  -c          output colour information in <font/> HTML tags (SRT)\n");
 			fprintf(stderr, "                (colours are supported by MPC, MPC HC, VLC, KMPlayer, VSFilter, ffdshow etc.)\n");
 			fprintf(stderr, "  -v          be verbose (default: verboseness turned off, without being quiet)\n");
+			fprintf(stderr, "  FILE        batch mode: transport stream files processed instead of STDIN,\n");
+			fprintf(stderr, "                each to FILE.srt (FILE-PAGE.srt for more pages) with its extension replaced\n");
+			fprintf(stderr, "  -l MANIFEST batch mode: process files listed in MANIFEST (one per line)\n");
+			fprintf(stderr, "  -d DIR      batch mode: process all *.ts, *.mts and *.m2ts files in DIR\n");
+			fprintf(stderr, "  -s          split mode: parts of STDIN (regular file only) are decoded in parallel\n");
+			fprintf(stderr, "  -j THREADS  number of batch or split mode worker threads (default: number of CPUs)\n");
+			fprintf(stderr, "  -S FILE     append decoder statistics to FILE (\"-\" = STDERR) as JSON, one object per line,\n");
+			fprintf(stderr, "                for each input at its end and on SIGUSR1\n");
+			fprintf(stderr, "  -u URL      receive transport stream from udp://[SOURCE@]ADDRESS:PORT instead of STDIN,\n");
+			fprintf(stderr, "                RTP-wrapped (auto-detected) or rtp://[SOURCE@]ADDRESS:PORT; multicast ADDRESS is joined\n");
+			fprintf(stderr, "                (source-specific with SOURCE), IPv6 ADDRESS in brackets, e.g. udp://@239.1.1.1:1234\n");
+			fprintf(stderr, "  -b BYTES    UDP socket receive buffer size (default: system default)\n");
+			fprintf(stderr, "  -L          live mode: write each caption as soon as its rows are complete, not at the next one\n");
+			fprintf(stderr, "  -T MS       live mode: caption rows are complete after MS ms of PCR time without new rows (default: 400)\n");
+			fprintf(stderr, "  -i INDEX    packet index of STDIN (regular file): written while input is decoded, repeated runs read\n");
+			fprintf(stderr, "                only TS packets of teletext streams listed in it (not in live mode, no split mode)\n");
+			fprintf(stderr, "  -P          pipelined mode: input is read, decoded and output written by threads of their own\n");
+			fprintf(stderr, "                (slow output does not stall input; not in split mode, no packet index)\n");
+			fprintf(stderr, "  -A          read regular files by asynchronous reads kept in flight (io_uring, or a reading thread)\n");
+			fprintf(stderr, "                instead of memory map (no split mode, no packet index)\n");
+			fprintf(stderr, "  -D          as -A, with O_DIRECT (page cache is bypassed)\n");
+			fprintf(stderr, "  -X FILE     keep all teletext pages and subpages received in memory, append them to FILE (\"-\" = STDERR)\n");
+			fprintf(stderr, "                as JSON, one object per subpage and line, for each input at its end and on SIGUSR2 (no split mode)\n");
+			fprintf(stderr, "  -m MIB      memory budget of pages kept by -X in MiB (default: 16); least recently updated subpages\n");
+			fprintf(stderr, "                are dropped when it is exhausted\n");
+			fprintf(stderr, "  --probe     print PAT/PMT teletext streams and pages (PID, page, language, type) and subtitle pages\n");
+			fprintf(stderr, "                found as JSON instead of decoding, reading input only until they are known\n");
 			fprintf(stderr, "\n");
 			exit(EXIT_SUCCESS);
 		}
-		else if ((strcmp(argv[i], "-p") == 0) && (argc > i + 1))
-			config_page = atoi(argv[++i]);
-		else if ((strcmp(argv[i], "-t") == 0) && (argc > i + 1))
-			config_tid = atoi(argv[++i]);
+		else if ((strcmp(argv[i], "-p") == 0) && (argc > i + 1)) {
+			const char *list = argv[++i];
+			if (strcmp(list, "all") == 0) config.all_pages = 1;
+			else while (*list != '\0') {
+				char *end = NULL;
+				long page = strtol(list, &end, 10);
+				if ((end == list) || ((*end != ',') && (*end != '\0')) || (config.pages_count == TELXCC_MAX_PAGES)) {
+					fprintf(stderr, "- Invalid teletext page list %s\n", argv[i]);
+					exit(EXIT_FAILURE);
+				}
+				config.pages[config.pages_count++] = page;
+				list = (*end == ',') ? end + 1 : end;
+			}
+		}
+		else if ((strcmp(argv[i], "-f") == 0) && (argc > i + 1))
+			config_output_prefix = argv[++i];
+		else if ((strcmp(argv[i], "-t") == 0) && (argc > i + 1)) {
+			if (strcmp(argv[++i], "all") == 0) config.all_pids = 1;
+			else config.pid = atoi(argv[i]);
+		}
 		else if ((strcmp(argv[i], "-o") == 0) && (argc > i + 1))
-			config_offset = atof(argv[++i]);
+			config.offset = atof(argv[++i]);
+		else if ((strcmp(argv[i], "-F") == 0) && (argc > i + 1)) {
+			const char *list = argv[++i];
+			config_writers_count = 0;
+			while (*list != '\0') {
+				size_t size = strcspn(list, ",");
+				const output_writer_t *writer = find_writer(list, size);
+				if (writer == NULL) {
+					fprintf(stderr, "- Unknown output format %.*s\n", (int)size, list);
+					exit(EXIT_FAILURE);
+				}
+				if (config_writers_count == MAX_WRITERS) {
+					fprintf(stderr, "- Too many output formats\n");
+					exit(EXIT_FAILURE);
+				}
+				config_writers[config_writers_count++] = writer;
+				list += size;
+				if (*list == ',') list++;
+			}
+		}
 		else if (strcmp(argv[i], "-n") == 0)
 			config_bom = 0;
 		else if (strcmp(argv[i], "-1") == 0)
 			config_nonempty = 1;
+		else if (strcmp(argv[i], "-r") == 0)
+			config.merge_repeats = 0;
 		else if (strcmp(argv[i], "-c") == 0)
-			config_colours = 1;
+			config.colours = 1;
 		else if (strcmp(argv[i], "-v") == 0)
 			config_verbose = 1;
+		else if (strcmp(argv[i], "-s") == 0)
+			config_split = 1;
+		else if (strcmp(argv[i], "-L") == 0)
+			config.live = 1;
+		else if ((strcmp(argv[i], "-T") == 0) && (argc > i + 1))
+			config.live_timeout = atoi(argv[++i]);
+		else if ((strcmp(argv[i], "-j") == 0) && (argc > i + 1))
+			config_workers = atoi(argv[++i]);
+		else if ((strcmp(argv[i], "-S") == 0) && (argc > i + 1)) {
+			config_stats = (strcmp(argv[++i], "-") == 0) ? stderr : fopen(argv[i], "a");
+			if (config_stats == NULL) {
+				fprintf(stderr, "- Could not open statistics file %s (%s)\n", argv[i], strerror(errno));
+				exit(EXIT_FAILURE);
+			}
+		}
+		else if ((strcmp(argv[i], "-u") == 0) && (argc > i + 1))
+			config_udp = argv[++i];
+		else if ((strcmp(argv[i], "-b") == 0) && (argc > i + 1))
+			config_udp_buffer = atoi(argv[++i]);
+		else if ((strcmp(argv[i], "-i") == 0) && (argc > i + 1))
+			config_index = argv[++i];
+		else if (strcmp(argv[i], "-P") == 0)
+			config_pipeline = 1;
+		else if (strcmp(argv[i], "-A") == 0)
+			config_async = 1;
+		else if (strcmp(argv[i], "-D") == 0) {
+			config_async = 1;
+			config_direct = 1;
+		}
+		else if ((strcmp(argv[i], "-X") == 0) && (argc > i + 1)) {
+			config_store = (strcmp(argv[++i], "-") == 0) ? stderr : fopen(argv[i], "a");
+			if (config_store == NULL) {
+				fprintf(stderr, "- Could not open page store file %s (%s)\n", argv[i], strerror(errno));
+				exit(EXIT_FAILURE);
+			}
+		}
+		else if ((strcmp(argv[i], "-m") == 0) && (argc > i + 1))
+			config_store_budget = (size_t)atoi(argv[++i]) * 1024 * 1024;
+		else if (strcmp(argv[i], "--probe") == 0)
+			config_probe = 1;
+		else if ((strcmp(argv[i], "-l") == 0) && (argc > i + 1))
+			add_manifest_inputs(argv[++i]);
+		else if ((strcmp(argv[i], "-d") == 0) && (argc > i + 1))
+			add_directory_inputs(argv[++i]);
+		else if (argv[i][0] != '-')
+			add_input(argv[i]);
 		else {
 			fprintf(stderr, "- Unknown option %s\n", argv[i]);
 			exit(EXIT_FAILURE);
 		}
 	}
+	config.verbose = config_verbose;
+	config.timing = (config_stats != NULL);
+	config.page_store = (config_store != NULL);
+	config.page_store_budget = config_store_budget;
 
 	// endianness test; maybe not needed, however I do not have any Big Endian system so I can be sure... :-/
 	{
@@ -659,157 +3102,73 @@ int main(int argc, const char *argv[]) {
 	}
 
 	// teletext page number out of range
-	if ((config_page != 0) && ((config_page < 100) || (config_page > 899))) {
-		fprintf(stderr, "- Teletext page number could not be lower than 100 or higher than 899\n");
-		exit(EXIT_FAILURE);
-	}
-
-	// default teletext page
-	if (config_page > 0) {
-		// dec to BCD, magazine pages numbers are in BCD (ETSI 300 706)
-		config_page = ((config_page / 100) << 8) | (((config_page / 10) % 10) << 4) | (config_page % 10);
-	}
-
-	signal(SIGINT, signal_handler);
-	signal(SIGTERM, signal_handler);
-
-	// disables flushing after CR/FL, we will flush manually whole SRT frames
-	setbuf(stdout, NULL);
-
-	// print UTF-8 BOM chars
-	if (config_bom == 1) {
-		fprintf(stdout, "\xef\xbb\xbf");
-		fflush(stdout);
-	}
-
-	// FYI, packet counter
-	uint32_t packet_counter = 0;
-
-	// TS packet buffer
-	uint8_t ts_buffer[TS_PACKET_SIZE];
-
-	// 255 means not set yet
-	uint8_t continuity_counter = 255;
-
-	// PES packet buffer
-	#define PES_BUFFER_SIZE 4096
-	uint8_t pes_buffer[PES_BUFFER_SIZE] = { 0 };
-	uint16_t pes_counter = 0;
-
-	// reading input
-	while ((exit_request == 0) && (fread(&ts_buffer, 1, TS_PACKET_SIZE, stdin) == TS_PACKET_SIZE)) {
-    	// Transport Stream Header
-		uint8_t ts_sync = ts_buffer[0];
-		uint8_t ts_transport_error = (ts_buffer[1] & 0x80) >> 7;
-		uint8_t ts_payload_unit_start = (ts_buffer[1] & 0x40) >> 6;
-		uint8_t ts_transport_priority = (ts_buffer[1] & 0x20) >> 5;
-		uint16_t ts_pid = ((ts_buffer[1] & 0x1f) << 8) | ts_buffer[2];
-		//uint8_t ts_scrambling_control = (ts_buffer[3] & 0xc0) >> 6;
-		uint8_t ts_adaptation_field_exists = (ts_buffer[3] & 0x20) >> 5;
-		uint8_t ts_payload_exists = (ts_buffer[3] & 0x10) >> 4;
-		uint8_t ts_continuity_counter = ts_buffer[3] & 0x0f;
-
-		uint8_t af_discontinuity = 0;
-		if (ts_adaptation_field_exists > 0) {
-			af_discontinuity = (ts_buffer[5] & 0x80) >> 7;
-
-			// PCR in adaptation field
-			uint8_t af_pcr_exists = (ts_buffer[5] & 0x10) >> 4;
-			if (af_pcr_exists > 0) {
-				uint64_t pts = 0;
-				pts |= (ts_buffer[6] << 25);
-				pts |= (ts_buffer[7] << 17);
-				pts |= (ts_buffer[8] << 9);
-				pts |= (ts_buffer[9] << 1);
-				pts |= (ts_buffer[10] >> 7);
-				global_timestamp = pts/90;
-				pts = ((ts_buffer[10] & 0x01) << 8);
-				pts |= ts_buffer[11];
-				global_timestamp += pts/27000;
-			}
-		}
-
-		// not TS packet?
-		if (ts_sync != 0x47) {
-			fprintf(stderr, "- Invalid TS packet header\n");
+	for (uint8_t i = 0; i < config.pages_count; i++)
+		if ((config.pages[i] < 100) || (config.pages[i] > 899)) {
+			fprintf(stderr, "- Teletext page number could not be lower than 100 or higher than 899\n");
 			exit(EXIT_FAILURE);
 		}
 
-		// no payload
-		if (ts_payload_exists == 0) continue;
-
-		// PID filter
-		if ((config_tid > 0) && (config_tid != ts_pid)) continue;
-
-		// uncorrectable error?
-		if (ts_transport_error > 0) {
-			VERBOSE fprintf(stderr, "- Uncorrectable TS packet error (received CC %1x)\n", ts_continuity_counter);
-			continue;
-		}
-
-		// Choose first suitable PID if not set
-		if (config_tid == 0) {
-			if ((ts_payload_unit_start > 0) && ((ts_buffer[4] == 0x00) && (ts_buffer[5] == 0x00) && (ts_buffer[6] == 0x01) && (ts_buffer[7] == 0xbd))) {
-				config_tid = ts_pid;
-				fprintf(stderr, "- No teletext PID specified, first received suitable stream PID is %"PRIu16" (0x%x), not guaranteed\n", config_tid, config_tid);
-			}
-			else continue;
-		}
-
-		// TS continuity check
-		if (continuity_counter == 255) {
-			continuity_counter = ts_continuity_counter;
-		}
-		else {
-			if (af_discontinuity == 0) {
-				continuity_counter = (continuity_counter + 1) % 16;
-				if (ts_continuity_counter != continuity_counter) {
-					VERBOSE fprintf(stderr, "- Missing TS packet, flushing pes_buffer (expected CC %1x, received CC %1x, TS discontinuity %s, TS priority %s)\n",
-						continuity_counter, ts_continuity_counter, (af_discontinuity ? "YES" : "NO"), (ts_transport_priority ? "YES" : "NO"));
-					pes_counter = 0;
-					continuity_counter = 255;
-				}
-			}
-		}
+	// SubRip by default
+	if (config_writers_count == 0) config_writers[config_writers_count++] = &WRITERS[0];
 
-		// waiting for first payload_unit_start indicator
-		if ((ts_payload_unit_start == 0) && (pes_counter == 0)) continue;
+	// more pages (or formats) could not be written into one output
+	if (((config.pages_count > 1) || (config.all_pages == 1) || (config.all_pids == 1) || (config_writers_count > 1)) && (config_output_prefix == NULL)) config_output_prefix = "telxcc";
 
-		// proceed with pes buffer
-		if ((ts_payload_unit_start > 0) && (pes_counter > 0)) process_pes_packet(pes_buffer, pes_counter);
+	signal(SIGINT, signal_handler);
+	signal(SIGTERM, signal_handler);
+	if (config_stats != NULL) signal(SIGUSR1, signal_handler);
+	if (config_store != NULL) signal(SIGUSR2, signal_handler);
+
+	// dec to BCD, magazine pages numbers are in BCD (ETSI 300 706)
+	for (uint8_t i = 0; i < config.pages_count; i++)
+		config.pages[i] = ((config.pages[i] / 100) << 8) | (((config.pages[i] / 10) % 10) << 4) | (config.pages[i] % 10);
+
+	if (config_inputs_count > 0) {
+		uint16_t workers_count = get_workers_count();
+		if (workers_count > config_inputs_count) workers_count = config_inputs_count;
+		VERBOSE fprintf(stderr, "- Batch mode, %"PRIu32" files processed by %"PRIu16" worker threads\n", config_inputs_count, workers_count);
+
+		pthread_t workers[MAX_WORKERS];
+		uint16_t workers_started = 0;
+		for (; workers_started < workers_count; workers_started++)
+			if (pthread_create(&workers[workers_started], NULL, batch_worker, NULL) != 0) break;
+		// no thread could be started, process files here
+		if (workers_started == 0) batch_worker(NULL);
+		for (uint16_t i = 0; i < workers_started; i++) pthread_join(workers[i], NULL);
+
+		fprintf(stderr, "- Done (%"PRIu32" files processed, %"PRIu32" failed, %"PRIu64" teletext packets processed, %"PRIu64" SRT frames written)\n",
+			batch_next, batch_failed, batch_packets, batch_frames);
+		fprintf(stderr, "\n");
 
-		// new pes frame start
-		if (ts_payload_unit_start > 0) pes_counter = 0;
+		return (batch_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
 
-		// add pes data to buffer
-		if (pes_counter < (PES_BUFFER_SIZE - TS_PACKET_PAYLOAD_SIZE)) {
-			memcpy(&pes_buffer[pes_counter], &ts_buffer[4], TS_PACKET_PAYLOAD_SIZE);
-			pes_counter += TS_PACKET_PAYLOAD_SIZE;
-			packet_counter++;
-		}
-		else VERBOSE fprintf(stderr, "- PES packet size exceeds pes_buffer size, probably not teletext stream\n");
+	job_t *job = calloc(1, sizeof(job_t));
+	if (job == NULL) {
+		fprintf(stderr, "- Could not allocate job\n");
+		exit(EXIT_FAILURE);
 	}
+	job->output_prefix = config_output_prefix;
+	job->output_per_page = 1;
 
-	VERBOSE {
-		if (frames_produced == 0) fprintf(stderr, "- No frames produced. CC teletext page number was probably wrong.\n");
-		fprintf(stderr, "- There were some CC data carried via pages: ");
-		// We ignore i = 0xff, because 0xffs are teletext ending frames
-		for (uint16_t i = 0; i < 255; i++)
-			for (uint8_t j = 0; j < 8; j++) {
-				uint8_t v = cc_map[i] & (1 << j);
-				if (v > 0) fprintf(stderr, "%03x ", ((j + 1) << 8) | i);
-			}
-		fprintf(stderr, "\n");
+	// print header (UTF-8 BOM chars etc.); probe report is the only output in probe mode
+	if ((config_output_prefix == NULL) && (config_probe == 0)) {
+		write_header(job, config_writers[0]->header, STDOUT_FILENO);
+		if (job->failed == 1) exit(EXIT_FAILURE);
 	}
 
-	if ((frames_produced == 0) && (config_nonempty > 0)) {
-		fprintf(stdout, "1\r\n00:00:00,000 --> 00:00:01,000\r\n(no closed captioning available)\r\n\r\n");
-		fflush(stdout);
-		frames_produced++;
+	if (run_job(job) < 0) exit(EXIT_FAILURE);
+
+	if ((config_output_prefix == NULL) && (config_probe == 0)) {
+		write_header(job, config_writers[0]->footer, STDOUT_FILENO);
+		if (job->failed == 1) exit(EXIT_FAILURE);
 	}
 
-	fprintf(stderr, "- Done (%"PRIu32" teletext packets processed, %"PRIu32" SRT frames written)\n", packet_counter, frames_produced);
+	fprintf(stderr, "- Done (%"PRIu32" teletext packets processed, %"PRIu32" SRT frames written)\n", job->packets, job->frames_produced);
 	fprintf(stderr, "\n");
 
+	free(job->output.data);
+	free(job);
+
 	return EXIT_SUCCESS;
 }
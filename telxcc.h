@@ -0,0 +1,332 @@
+/*!
+(c) 2011-2012 Petr Kutalek, Forers, s. r. o.: telxcc
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+
+libtelxcc: reentrant teletext closed captioning decoder
+
+Usage:
+	telxcc_config_t config;
+	telxcc_config_init(&config);
+	config.pages[config.pages_count++] = 0x777;
+	telxcc_decoder_t *decoder = telxcc_create(&config, callback, user_data);
+	while (...) telxcc_push(decoder, data, size); // any amount of TS data, packets may be split arbitrarily
+	telxcc_flush(decoder);
+	telxcc_destroy(decoder);
+
+With config.page_store, decoder also keeps every page and subpage of all magazines received (not only those
+extracted), updated packet by packet; telxcc_store_get() and telxcc_store_next() take snapshots of them.
+
+Decoder has no global state: every decoder is independent and may be used from its own thread
+(one decoder must not be used by more threads at once). Callback is called from within telxcc_push().
+*/
+
+#ifndef telxcc_h_included
+#define telxcc_h_included
+
+#include <stdio.h>
+#include <stddef.h>
+#include <inttypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// size of a TS packet in bytes
+#define TELXCC_TS_PACKET_SIZE 188
+
+// maximum number of teletext pages extracted at once from one stream
+#define TELXCC_MAX_PAGES 64
+
+// maximum number of teletext streams (PIDs) processed at once
+#define TELXCC_MAX_STREAMS 32
+
+// caption latency histogram buckets (see telxcc_stats_t.latency)
+#define TELXCC_LATENCY_BUCKETS 12
+
+// default live mode idle timeout in ms (see telxcc_config_t.live_timeout)
+#define TELXCC_LIVE_TIMEOUT 400
+
+// maximum number of programs (PMTs) tracked (see telxcc_psi_t)
+#define TELXCC_MAX_PROGRAMS 64
+
+// default page store memory budget in bytes (see telxcc_config_t.page_store_budget)
+#define TELXCC_STORE_BUDGET (16 * 1024 * 1024)
+
+// X/26 diacritical marks kept per stored subpage at most
+#define TELXCC_STORE_MARKS 40
+
+// buffer size telxcc_store_text() needs: 25 rows of 40 chars (at most 3 bytes each in UTF-8) and \n, and zero
+#define TELXCC_STORE_TEXT_SIZE (25 * (40 * 3 + 1) + 1)
+
+typedef struct telxcc_decoder telxcc_decoder_t;
+
+typedef struct {
+	// teletext pages to extract in BCD (e.g. 0x777); no page = first subtitle page found
+	uint16_t pages[TELXCC_MAX_PAGES];
+	uint8_t pages_count;
+	// extract all subtitle pages found in stream?
+	uint8_t all_pages;
+	// 13-bit packet ID of teletext stream, 0 = first suitable stream
+	uint16_t pid;
+	// process all teletext streams in TS?
+	uint8_t all_pids;
+	// time offset in seconds
+	double offset;
+	// render <font...></font> tags?
+	uint8_t colours;
+	// be verbose?
+	uint8_t verbose;
+	// measure stage times (see telxcc_stats_t)?
+	uint8_t timing;
+	// live mode: caption is emitted as soon as its rows are complete (page transmission terminated, or no new row
+	// for live_timeout ms of TS PCR time, 0 = TELXCC_LIVE_TIMEOUT), not at the next page header; its hide_timestamp
+	// is 0 and TELXCC_EVENT_CLEAR follows when the caption is replaced or removed
+	uint8_t live;
+	uint16_t live_timeout;
+	// merge repeated captions: page retransmitted with the same caption right after it extends hide_timestamp of
+	// the caption instead of a new one; caption is emitted when page content changes (or telxcc_flush()), not live
+	uint8_t merge_repeats;
+	// emit TELXCC_EVENT_PACKET for every TS packet of teletext streams (e.g. to index input)
+	uint8_t packet_events;
+	// parse PAT and PMTs and their teletext descriptors (see telxcc_get_psi())
+	uint8_t psi;
+	// keep all pages and subpages received in page store (see telxcc_store_get()) of at most page_store_budget
+	// bytes (0 = TELXCC_STORE_BUDGET); when it is full, subpage updated least recently is dropped
+	uint8_t page_store;
+	size_t page_store_budget;
+	// TS packet size: 188, 192 (M2TS) or 204 (with RS parity), 0 = auto-detect
+	uint16_t packet_size;
+	// input position of the first byte pushed (e.g. offset of an input part being decoded on its own)
+	uint64_t start_position;
+	// input position where this decoder's part of input ends, 0 = whole input; see telxcc_pending()
+	uint64_t end_position;
+	// diagnostic messages are written here, NULL = no messages
+	FILE *log;
+} telxcc_config_t;
+
+typedef enum {
+	// new page is being extracted (explicitly requested page found in a stream, or auto-detected page)
+	TELXCC_EVENT_PAGE = 0,
+	// caption (non-empty page) is complete; in live mode caption may be emitted again when its rows change
+	TELXCC_EVENT_CAPTION,
+	// live mode: caption emitted is to be hidden at hide_timestamp (show_timestamp is of the caption); no text
+	TELXCC_EVENT_CLEAR,
+	// config.packet_events: TS packet of teletext stream at position is processed; no timestamps, no text
+	TELXCC_EVENT_PACKET
+} telxcc_event_type_t;
+
+typedef struct {
+	telxcc_event_type_t type;
+	uint16_t pid;
+	uint16_t page; // BCD
+	uint64_t show_timestamp; // show at timestamp (in ms)
+	uint64_t hide_timestamp; // hide at timestamp (in ms)
+	uint64_t position; // input position of PES carrying page header (of TS packet)
+	uint32_t pcr; // TS PCR (in ms) when event is emitted
+	const uint16_t (*text)[40]; // 25 lines x 40 cols of UCS-2 chars as received
+	const char *utf8; // boxed area text, UTF-8, each line terminated by \n, zero-terminated
+	size_t utf8_size;
+} telxcc_event_t;
+
+typedef void (*telxcc_callback_t)(void *user_data, const telxcc_event_t *event);
+
+typedef struct {
+	uint16_t pid;
+	// subtitle type pages bitmap; bit (M - 1) of cc_map[XX] is set for subtitle page MXX
+	const uint8_t *cc_map;
+	// timestamp = PES time + delta (all in ms); 95443718 is added to delta whenever PES time goes backwards
+	// delta at first PES; valid if timing_initialized
+	uint8_t timing_initialized;
+	uint32_t first_t;
+	int64_t first_delta;
+	// delta and last PES time at the first PES starting at or after end_position (or at the end of data pushed);
+	// valid if end_timing_initialized
+	uint8_t end_timing_initialized;
+	int64_t end_delta;
+	uint32_t end_t0;
+} telxcc_stream_info_t;
+
+// counters of one teletext stream
+typedef struct {
+	uint16_t pid;
+	// TS packets with payload
+	uint64_t packets;
+	// missing TS packets detected by continuity counter (PES being assembled is dropped)
+	uint32_t continuity_errors;
+	// PES packets assembled and processed
+	uint64_t pes;
+	// PES packets shorter than their PES_packet_length (processed truncated)
+	uint32_t pes_truncated;
+	// TS packets dropped because PES would exceed maximum PES size (or out of memory)
+	uint32_t pes_overflows;
+} telxcc_stream_stats_t;
+
+// Decoder counters are kept per decoder (so per thread) without any locking, and cost next to nothing;
+// in split mode (config.end_position) data decoded after end_position count too, except packets.
+// Stage times (measured with config.timing only) cover work done within telxcc_push(): stage_pes_ns is PES and
+// teletext packet decoding, stage_render_ns is rendering of complete pages, stage_callback_ns is time spent in
+// callback; the rest of telxcc_push() is TS demux.
+// Caption latency is TS PCR time from page header to caption emitted; bucket 0 counts latencies under 16 ms,
+// bucket i latencies from 2^(i + 3) to 2^(i + 4) ms, the last one all above.
+typedef struct {
+	// TS packets of teletext streams processed
+	uint32_t packets;
+	// bytes skipped while searching for TS sync bytes
+	uint64_t bytes_skipped;
+	// number of times TS sync was lost
+	uint32_t sync_losses;
+
+	// bytes pushed
+	uint64_t bytes;
+	// TS packets locked on, and those of them parsed (the rest was skipped by PID pre-filter)
+	uint64_t ts_packets;
+	uint64_t ts_packets_parsed;
+	// TS packets with transport error indicator set
+	uint32_t transport_errors;
+	// teletext streams
+	telxcc_stream_stats_t streams[TELXCC_MAX_STREAMS];
+	uint8_t streams_count;
+	// PES data units by data_unit_id
+	uint64_t data_units[256];
+	// teletext packets by magazine (M - 1) and packet number (Y)
+	uint64_t rows[8][32];
+	// pages found and captions emitted
+	uint32_t pages;
+	uint64_t captions;
+	// page retransmissions merged into caption (config.merge_repeats)
+	uint64_t repeats;
+	// caption latency histogram
+	uint32_t latency[TELXCC_LATENCY_BUCKETS];
+	// stage times in ns
+	uint64_t stage_pes_ns;
+	uint64_t stage_render_ns;
+	uint64_t stage_callback_ns;
+} telxcc_stats_t;
+
+// teletext page listed in teletext descriptor of PMT (ETSI EN 300 468, chapter 6.2.43)
+typedef struct {
+	// ISO 639-2 language code, zero-terminated
+	char language[4];
+	// teletext_type: 0x01 initial page, 0x02 subtitle page, 0x03 additional information page,
+	// 0x04 programme schedule page, 0x05 subtitle page for hearing impaired people
+	uint8_t type;
+	uint16_t page; // BCD
+} telxcc_teletext_page_t;
+
+// elementary stream with teletext descriptor (or VBI teletext descriptor) in PMT
+typedef struct {
+	uint16_t pid;
+	uint16_t program_number;
+	telxcc_teletext_page_t pages[TELXCC_MAX_PAGES];
+	uint8_t pages_count;
+} telxcc_pmt_stream_t;
+
+// Program Specific Information received so far (config.psi)
+typedef struct {
+	uint8_t pat_received;
+	uint16_t transport_stream_id;
+	// programs listed in PAT and whether their PMT has been received
+	uint16_t program_numbers[TELXCC_MAX_PROGRAMS];
+	uint16_t pmt_pids[TELXCC_MAX_PROGRAMS];
+	uint8_t pmt_received[TELXCC_MAX_PROGRAMS];
+	uint8_t programs_count;
+	// teletext streams listed in PMTs received
+	telxcc_pmt_stream_t streams[TELXCC_MAX_STREAMS];
+	uint8_t streams_count;
+} telxcc_psi_t;
+
+// attributes of stored glyph (telxcc_stored_page_t.attrs), ETS 300 706, chapter 12.2 (Level 1 spacing attributes)
+// foreground colour: black(0), red, green, yellow, blue, magenta, cyan, white
+#define TELXCC_ATTR_COLOUR 0x07
+// G1 block mosaic (glyphs 0x20 -- 0x3f, 0x60 -- 0x7f; 0x40 -- 0x5f are G0 characters "blasting through")
+#define TELXCC_ATTR_MOSAIC 0x08
+// in boxed area (subtitles and newsflashes)
+#define TELXCC_ATTR_BOXED 0x10
+#define TELXCC_ATTR_DOUBLE_HEIGHT 0x20
+// G0 character of second G0 set (switched by ESC)
+#define TELXCC_ATTR_SECOND_G0 0x40
+// set by X/26 (Level 1.5): G2 character, or G0 character with diacritical mark (see telxcc_stored_page_t.marks)
+#define TELXCC_ATTR_ENHANCED 0x80
+
+// subpage in page store (config.page_store); glyphs are 8-bit indexes into character sets of the page:
+// 0x00 -- 0x1f spacing attributes as received (displayed as spaces), 0x20 -- 0x7f G0 characters (or G1 mosaics,
+// see attrs), 0x80 -- 0xdf G2 characters 0x20 -- 0x7f; attrs are TELXCC_ATTR_* of each glyph
+typedef struct {
+	uint16_t pid;
+	uint16_t page; // BCD
+	uint16_t subpage; // subcode S4 S3 S2 S1 (0x0000 -- 0x3f7f)
+	// control bits C4 -- C14 of last page header (bit 0 = C4 erase page, bit 2 = C6 subtitle etc.)
+	uint16_t control;
+	// default and second G0 designation codes, ETS 300 706, chapter 15.2, table 32; 255 = no second G0 set
+	uint8_t g0;
+	uint8_t g0_secondary;
+	// rows received, bit Y = row Y (0 = page header, glyphs 8 -- 39 only)
+	uint32_t rows;
+	// input position of PES carrying last page header, timestamp (in ms) of last update and packets received
+	uint64_t position;
+	uint64_t timestamp;
+	uint32_t updates;
+	uint8_t glyphs[25][40];
+	uint8_t attrs[25][40];
+	// G0 characters with diacritical mark: row, column and mark 1 -- 15 (G2 character 0x40 + mark)
+	uint8_t marks[TELXCC_STORE_MARKS][3];
+	uint8_t marks_count;
+} telxcc_stored_page_t;
+
+// fills config with defaults
+void telxcc_config_init(telxcc_config_t *config);
+
+// returns NULL if out of memory
+telxcc_decoder_t *telxcc_create(const telxcc_config_t *config, telxcc_callback_t callback, void *user_data);
+
+// processes TS data; packet size is detected on sync bytes (see telxcc_config_t.packet_size),
+// corrupted data are skipped and decoder resynchronises; returns 0
+int telxcc_push(telxcc_decoder_t *decoder, const uint8_t *data, size_t size);
+
+// returns 1 while data at or after config.end_position are needed to complete pages whose header
+// lies before end_position (PES not terminated yet, page not terminated by its next header yet)
+int telxcc_pending(const telxcc_decoder_t *decoder);
+
+// emits captions held for retransmissions (config.merge_repeats); call at the end of input
+void telxcc_flush(telxcc_decoder_t *decoder);
+
+void telxcc_get_stats(const telxcc_decoder_t *decoder, telxcc_stats_t *stats);
+
+// returns 0 when there is no stream with such index
+int telxcc_get_stream_info(const telxcc_decoder_t *decoder, uint8_t index, telxcc_stream_info_t *info);
+
+// fills psi with PAT and PMTs received so far; all empty without config.psi
+void telxcc_get_psi(const telxcc_decoder_t *decoder, telxcc_psi_t *psi);
+
+// copies subpage of page (BCD) of stream pid from page store into stored; subpage 0xffff = subpage updated last;
+// returns 0 when it is not stored (or without config.page_store)
+int telxcc_store_get(const telxcc_decoder_t *decoder, uint16_t pid, uint16_t page, uint16_t subpage, telxcc_stored_page_t *stored);
+
+// copies subpage following stored->pid, page and subpage (in order of streams found, pages and subpages) into
+// stored, stored->pid = 0 starts with the first one; returns 0 when there is none
+int telxcc_store_next(const telxcc_decoder_t *decoder, telxcc_stored_page_t *stored);
+
+// renders stored subpage as UTF-8 text of TELXCC_STORE_TEXT_SIZE bytes at most: 25 rows, each terminated by \n,
+// zero-terminated; spacing attributes and mosaics are spaces; returns its size (without zero)
+size_t telxcc_store_text(const telxcc_stored_page_t *stored, char *text);
+
+void telxcc_destroy(telxcc_decoder_t *decoder);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif